@@ -1,7 +1,10 @@
 #ifndef DATA_TYPES_H
 #define DATA_TYPES_H
 
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Enums for various error codes. More to be added later
 typedef enum {
@@ -13,6 +16,63 @@ typedef enum {
     ERROR_NOT_FOUND = 5,
 } ErrorCode;
 
+/**
+ * @brief Memory allocator a container gets its memory from.
+ *
+ * Every callback receives context. realloc and free are also told the size
+ * of the block, which lets arenas and pools skip keeping headers. realloc may
+ * be left NULL, in which case blocks are moved with alloc, memcpy and free. A
+ * zeroed Allocator, or passing NULL wherever an allocator is taken, means the
+ * standard library malloc, realloc and free.
+ */
+typedef struct AllocatorType {
+    void* (*alloc)(void* context, size_t size);
+    void* (*realloc)(void* context, void* ptr, size_t old_size,
+                     size_t new_size);
+    void (*free)(void* context, void* ptr, size_t size);
+    void* context;  ///< User data handed to every callback
+} Allocator;
+
+static inline void* Allocator_alloc(const Allocator* allocator, size_t size) {
+    if (allocator == NULL || allocator->alloc == NULL) {
+        return malloc(size);
+    }
+    return allocator->alloc(allocator->context, size);
+}
+
+static inline void Allocator_free(const Allocator* allocator, void* ptr,
+                                  size_t size) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (allocator == NULL || allocator->alloc == NULL) {
+        free(ptr);
+        return;
+    }
+    if (allocator->free != NULL) {
+        allocator->free(allocator->context, ptr, size);
+    }
+}
+
+static inline void* Allocator_realloc(const Allocator* allocator, void* ptr,
+                                      size_t old_size, size_t new_size) {
+    if (allocator == NULL || allocator->alloc == NULL) {
+        return realloc(ptr, new_size);
+    }
+    if (allocator->realloc != NULL) {
+        return allocator->realloc(allocator->context, ptr, old_size,
+                                  new_size);
+    }
+
+    // No realloc callback, move the block by hand
+    void* moved = allocator->alloc(allocator->context, new_size);
+    if (moved != NULL && ptr != NULL) {
+        memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+        Allocator_free(allocator, ptr, old_size);
+    }
+    return moved;
+}
+
 // Structure representing a generic data type
 typedef struct GenericDataType {
     size_t size;  // data size to be used in malloc
@@ -20,22 +80,40 @@ typedef struct GenericDataType {
 
 } T;
 
+// How an Array picks its new capacity when it runs out of room
+typedef enum {
+    GROWTH_GEOMETRIC = 0,  // Multiply the capacity by factor
+    GROWTH_INCREMENT = 1,  // Add increment elements
+    GROWTH_PAGE = 2,       // Multiply by factor, then round up to whole pages
+} GrowthMode;
+
+// Structure representing the growth policy of an Array
+typedef struct ArrayGrowthPolicy {
+    GrowthMode mode;
+    double factor;     ///< Growth factor for GROWTH_GEOMETRIC and GROWTH_PAGE
+    size_t increment;  ///< Elements added per growth for GROWTH_INCREMENT
+} GrowthPolicy;
+
 // Structure representing a generic Array
 typedef struct ArrayDataType {
-    size_t size;       ///< Current number of elements in the Array
-    size_t capacity;   ///< Maximum capacity of the Array
-    size_t data_size;  // data size to be used in malloc
-    T* values;         ///< Pointer to the array of GenericDataType
+    size_t size;          ///< Current number of elements in the Array
+    size_t capacity;      ///< Maximum capacity of the Array
+    size_t data_size;     // data size to be used in malloc
+    void* data;           ///< Contiguous buffer of capacity * data_size bytes
+    GrowthPolicy growth;  ///< How the Array grows when it is full
+    Allocator allocator;  ///< Where the Array and its buffer come from
 } Array;
 
 typedef struct ReturnErrorCode {
     ErrorCode error;
 } ReturnError;
 
-typedef struct ReturnGenericDataType {
+// A view returned by value. value.data points into the container and stays
+// valid until the container is next changed.
+typedef struct ReturnViewType {
     ErrorCode error;
-    T* value;
-} ReturnData;
+    T value;
+} ReturnView;
 
 typedef struct ReturnArrayType {
     ErrorCode error;
@@ -52,6 +130,12 @@ typedef struct ReturnSizeTType {
     size_t value;
 } ReturnSizeT;
 
+typedef struct ReturnRangeType {
+    ErrorCode error;
+    size_t begin;  ///< First index in the range
+    size_t end;    ///< One past the last index in the range
+} ReturnRange;
+
 /**
  * @brief Callback function to be applied to an element; used in iteration
  *
@@ -59,6 +143,25 @@ typedef struct ReturnSizeTType {
  */
 typedef void (*CallbackFunction)(T* element);
 
+/**
+ * @brief Callback function that also receives user data; used in iteration
+ *
+ * @param element A GenericDataType pointer to the element
+ * @param context The pointer handed to the iterating function
+ */
+typedef void (*ContextCallbackFunction)(T* element, void* context);
+
+/**
+ * @brief Callback function applied to a contiguous run of elements at once;
+ * used in block iteration
+ *
+ * @param elements Pointer to the first element of the run
+ * @param count Number of elements in the run
+ * @param context The pointer handed to the iterating function
+ */
+typedef void (*BlockCallbackFunction)(void* elements, size_t count,
+                                      void* context);
+
 /**
  * @brief Comparison function type for custom sorting.
  *
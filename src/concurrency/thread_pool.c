@@ -0,0 +1,597 @@
+// sysconf and sched_yield are POSIX, not part of C11
+#define _POSIX_C_SOURCE 200809L
+
+#include "thread_pool.h"
+
+#include <sched.h>
+#include <unistd.h>
+
+// Workers are padded to their own cache lines so thieves reading top never
+// slow down the owner writing bottom of a neighbouring deque
+#define WORKER_ALIGNMENT 64
+#define DEQUE_INITIAL_CAPACITY 256
+#define IDLE_SPINS 64
+#define PARALLEL_FOR_CHUNKS_PER_THREAD 8
+
+// Circular buffer of a deque. Slots are atomic because a thief may read a
+// slot while the owner reuses it; the thief's CAS on top then fails. Old
+// buffers stay alive until the pool is destroyed since a thief may still be
+// reading one after the owner has grown past it.
+typedef struct TaskBuffer {
+    int64_t capacity;            ///< Number of slots, a power of two
+    struct TaskBuffer* retired;  ///< Buffer this one replaced
+    _Atomic(ThreadPoolTask*) slots[];
+} TaskBuffer;
+
+/*
+ * Chase-Lev deque, following "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (Le et al. 2013). Only the owner pushes and takes at the
+ * bottom; anyone may steal at the top. The fences of the paper are folded
+ * into sequentially consistent accesses on top and bottom.
+ */
+typedef struct ThreadPoolWorker {
+    _Alignas(WORKER_ALIGNMENT) _Atomic int64_t top;
+    _Atomic int64_t bottom;
+    _Atomic(TaskBuffer*) buffer;
+    ThreadPool* pool;
+    pthread_t thread;
+    uint64_t seed;  ///< State of the victim picker
+} ThreadPoolWorker;
+
+// Worker the current thread runs, NULL outside every pool
+static _Thread_local ThreadPoolWorker* current_worker = NULL;
+
+static TaskBuffer* buffer_create(int64_t capacity) {
+    TaskBuffer* buffer = (TaskBuffer*)malloc(
+        sizeof(TaskBuffer) + (size_t)capacity * sizeof(ThreadPoolTask*));
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->capacity = capacity;
+    buffer->retired = NULL;
+    for (int64_t i = 0; i < capacity; i++) {
+        atomic_init(&buffer->slots[i], NULL);
+    }
+    return buffer;
+}
+
+static inline _Atomic(ThreadPoolTask*) * slot_at(TaskBuffer* buffer,
+                                                 int64_t index) {
+    return &buffer->slots[index & (buffer->capacity - 1)];
+}
+
+// Owner only. Fails only if the deque is full and cannot grow.
+static bool deque_push(ThreadPoolWorker* worker, ThreadPoolTask* task) {
+    int64_t bottom =
+        atomic_load_explicit(&worker->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&worker->top, memory_order_acquire);
+    TaskBuffer* buffer =
+        atomic_load_explicit(&worker->buffer, memory_order_relaxed);
+
+    if (bottom - top >= buffer->capacity) {
+        TaskBuffer* grown = buffer_create(buffer->capacity * 2);
+        if (grown == NULL) {
+            return false;
+        }
+        for (int64_t i = top; i < bottom; i++) {
+            atomic_store_explicit(
+                slot_at(grown, i),
+                atomic_load_explicit(slot_at(buffer, i), memory_order_relaxed),
+                memory_order_relaxed);
+        }
+        grown->retired = buffer;
+        atomic_store_explicit(&worker->buffer, grown, memory_order_release);
+        buffer = grown;
+    }
+
+    atomic_store_explicit(slot_at(buffer, bottom), task, memory_order_relaxed);
+    atomic_store_explicit(&worker->bottom, bottom + 1, memory_order_release);
+    return true;
+}
+
+// Owner only. Takes the newest task.
+static ThreadPoolTask* deque_take(ThreadPoolWorker* worker) {
+    int64_t bottom =
+        atomic_load_explicit(&worker->bottom, memory_order_relaxed) - 1;
+    TaskBuffer* buffer =
+        atomic_load_explicit(&worker->buffer, memory_order_relaxed);
+    atomic_store_explicit(&worker->bottom, bottom, memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&worker->top, memory_order_seq_cst);
+
+    if (top > bottom) {
+        atomic_store_explicit(&worker->bottom, bottom + 1,
+                              memory_order_relaxed);
+        return NULL;
+    }
+
+    ThreadPoolTask* task =
+        atomic_load_explicit(slot_at(buffer, bottom), memory_order_relaxed);
+    if (top == bottom) {
+        // Last task, race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(
+                &worker->top, &top, top + 1, memory_order_seq_cst,
+                memory_order_relaxed)) {
+            task = NULL;
+        }
+        atomic_store_explicit(&worker->bottom, bottom + 1,
+                              memory_order_relaxed);
+    }
+    return task;
+}
+
+// Any thread. Takes the oldest task, NULL if empty or another thread won.
+static ThreadPoolTask* deque_steal(ThreadPoolWorker* worker) {
+    int64_t top = atomic_load_explicit(&worker->top, memory_order_seq_cst);
+    int64_t bottom =
+        atomic_load_explicit(&worker->bottom, memory_order_seq_cst);
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    TaskBuffer* buffer =
+        atomic_load_explicit(&worker->buffer, memory_order_acquire);
+    ThreadPoolTask* task =
+        atomic_load_explicit(slot_at(buffer, top), memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&worker->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return NULL;
+    }
+    return task;
+}
+
+static ThreadPoolWorker* worker_of(const ThreadPool* pool) {
+    ThreadPoolWorker* worker = current_worker;
+    return worker != NULL && worker->pool == pool ? worker : NULL;
+}
+
+// Wakes a sleeping worker if there is one
+static void notify_work(ThreadPool* pool) {
+    if (atomic_load(&pool->sleepers) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->work);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static ReturnError enqueue(ThreadPool* pool, ThreadPoolTask* task) {
+    ReturnError result = {.error = NO_ERROR};
+
+    // Count the task before anyone can take it, so pending never drops
+    // below the number of queued tasks
+    atomic_fetch_add(&pool->pending, 1);
+
+    ThreadPoolWorker* worker = worker_of(pool);
+    if (worker == NULL || !deque_push(worker, task)) {
+        pthread_mutex_lock(&pool->lock);
+        result = RingBuffer_push_back(
+            pool->injected, &(T){sizeof(ThreadPoolTask*), &task});
+        if (result.error == NO_ERROR) {
+            atomic_fetch_add(&pool->injected_count, 1);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    if (result.error != NO_ERROR) {
+        atomic_fetch_sub(&pool->pending, 1);
+        return result;
+    }
+
+    notify_work(pool);
+    return result;
+}
+
+static ThreadPoolTask* take_injected(ThreadPool* pool) {
+    if (atomic_load(&pool->injected_count) == 0) {
+        return NULL;
+    }
+
+    ThreadPoolTask* task = NULL;
+    pthread_mutex_lock(&pool->lock);
+    if (RingBuffer_pop_front(pool->injected,
+                             &(T){sizeof(ThreadPoolTask*), &task})
+            .error == NO_ERROR) {
+        atomic_fetch_sub(&pool->injected_count, 1);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return task;
+}
+
+// Own deque first, then tasks from outside, then other workers starting at
+// a random one so thieves spread out
+static ThreadPoolTask* find_task(ThreadPool* pool, ThreadPoolWorker* self) {
+    ThreadPoolTask* task = NULL;
+
+    if (self != NULL) {
+        task = deque_take(self);
+    }
+    if (task == NULL) {
+        task = take_injected(pool);
+    }
+    if (task == NULL) {
+        uint64_t seed = self != NULL ? self->seed : (uint64_t)(uintptr_t)&seed;
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        if (self != NULL) {
+            self->seed = seed;
+        }
+
+        size_t start = (size_t)(seed % pool->worker_count);
+        for (size_t i = 0; i < pool->worker_count && task == NULL; i++) {
+            ThreadPoolWorker* victim =
+                &pool->workers[(start + i) % pool->worker_count];
+            if (victim != self) {
+                task = deque_steal(victim);
+            }
+        }
+    }
+
+    if (task != NULL) {
+        atomic_fetch_sub(&pool->pending, 1);
+    }
+    return task;
+}
+
+static void run_task(ThreadPool* pool, ThreadPoolTask* task) {
+    bool detached = task->detached;
+    task->function(task->context);
+
+    if (detached) {
+        free(task);
+        return;
+    }
+
+    // The waiter may free the task as soon as done is set
+    atomic_store(&task->done, true);
+    if (atomic_load(&pool->waiters) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->finished);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// Sleeps until there is work, returns true if the pool is stopping instead
+static bool idle(ThreadPool* pool) {
+    for (int i = 0; i < IDLE_SPINS; i++) {
+        if (atomic_load(&pool->pending) > 0) {
+            return false;
+        }
+        sched_yield();
+    }
+
+    bool stop = false;
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->sleepers, 1);
+    while (atomic_load(&pool->pending) == 0) {
+        if (atomic_load(&pool->stopping)) {
+            stop = true;
+            break;
+        }
+        pthread_cond_wait(&pool->work, &pool->lock);
+    }
+    atomic_fetch_sub(&pool->sleepers, 1);
+    pthread_mutex_unlock(&pool->lock);
+
+    return stop;
+}
+
+static void* worker_main(void* arg) {
+    ThreadPoolWorker* self = (ThreadPoolWorker*)arg;
+    ThreadPool* pool = self->pool;
+    current_worker = self;
+
+    for (;;) {
+        ThreadPoolTask* task = find_task(pool, self);
+        if (task != NULL) {
+            run_task(pool, task);
+        } else if (idle(pool)) {
+            break;
+        }
+    }
+
+    current_worker = NULL;
+    return NULL;
+}
+
+// Runs other tasks until task is done, sleeping when there are none
+static void wait_task(ThreadPool* pool, ThreadPoolTask* task) {
+    ThreadPoolWorker* self = worker_of(pool);
+
+    while (!atomic_load(&task->done)) {
+        ThreadPoolTask* other = find_task(pool, self);
+        if (other != NULL) {
+            run_task(pool, other);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->waiters, 1);
+        while (!atomic_load(&task->done) && atomic_load(&pool->pending) == 0) {
+            pthread_cond_wait(&pool->finished, &pool->lock);
+        }
+        atomic_fetch_sub(&pool->waiters, 1);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void free_workers(ThreadPool* pool, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        TaskBuffer* buffer = atomic_load(&pool->workers[i].buffer);
+        while (buffer != NULL) {
+            TaskBuffer* retired = buffer->retired;
+            free(buffer);
+            buffer = retired;
+        }
+    }
+    free(pool->workers);
+}
+
+// Stops and joins the first started workers once their queues are empty
+static void stop_workers(ThreadPool* pool, size_t started) {
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->stopping, true);
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+}
+
+ReturnThreadPool ThreadPool_create(size_t threads) {
+    ReturnThreadPool result = {.error = NO_ERROR, .pool = NULL};
+
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 1 ? (size_t)cpus - 1 : 1;
+    }
+
+    if (threads > SIZE_MAX / sizeof(ThreadPoolWorker)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    ThreadPool* pool = (ThreadPool*)malloc(sizeof(ThreadPool));
+    if (pool == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    pool->worker_count = threads;
+    atomic_init(&pool->injected_count, 0);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->sleepers, 0);
+    atomic_init(&pool->waiters, 0);
+    atomic_init(&pool->stopping, false);
+
+    ReturnRingBuffer injected =
+        RingBuffer_create(sizeof(ThreadPoolTask*), DEQUE_INITIAL_CAPACITY);
+    pool->injected = injected.ring;
+    pool->workers = (ThreadPoolWorker*)aligned_alloc(
+        WORKER_ALIGNMENT, threads * sizeof(ThreadPoolWorker));
+    if (injected.error != NO_ERROR || pool->workers == NULL) {
+        if (pool->injected != NULL) {
+            RingBuffer_destroy(&pool->injected);
+        }
+        free(pool->workers);
+        free(pool);
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+
+    // Set up every deque before any worker can try to steal from it
+    size_t ready = 0;
+    for (; ready < threads; ready++) {
+        ThreadPoolWorker* worker = &pool->workers[ready];
+        TaskBuffer* buffer = buffer_create(DEQUE_INITIAL_CAPACITY);
+        if (buffer == NULL) {
+            break;
+        }
+        atomic_init(&worker->top, 0);
+        atomic_init(&worker->bottom, 0);
+        atomic_init(&worker->buffer, buffer);
+        worker->pool = pool;
+        worker->seed = 0x9E3779B97F4A7C15ULL * (ready + 1);
+    }
+
+    size_t started = 0;
+    if (ready == threads) {
+        for (; started < threads; started++) {
+            if (pthread_create(&pool->workers[started].thread, NULL,
+                               worker_main, &pool->workers[started]) != 0) {
+                break;
+            }
+        }
+    }
+
+    if (started < threads) {
+        stop_workers(pool, started);
+        free_workers(pool, ready);
+        RingBuffer_destroy(&pool->injected);
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->work);
+        pthread_cond_destroy(&pool->finished);
+        free(pool);
+        result.error = ready < threads ? ERROR_ALLOCATION : ERROR;
+        return result;
+    }
+
+    result.pool = pool;
+    return result;
+}
+
+static ThreadPool* shared_pool = NULL;
+static pthread_once_t shared_pool_once = PTHREAD_ONCE_INIT;
+
+static void create_shared_pool(void) {
+    shared_pool = ThreadPool_create(0).pool;
+}
+
+ThreadPool* ThreadPool_shared(void) {
+    pthread_once(&shared_pool_once, create_shared_pool);
+    return shared_pool;
+}
+
+ReturnError ThreadPool_destroy(ThreadPool** pool) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (pool == NULL || *pool == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    // Workers only stop once nothing is pending, so queued tasks still run
+    stop_workers(*pool, (*pool)->worker_count);
+    free_workers(*pool, (*pool)->worker_count);
+    RingBuffer_destroy(&(*pool)->injected);
+    pthread_mutex_destroy(&(*pool)->lock);
+    pthread_cond_destroy(&(*pool)->work);
+    pthread_cond_destroy(&(*pool)->finished);
+    free(*pool);
+    *pool = NULL;
+
+    return result;
+}
+
+size_t ThreadPool_size(const ThreadPool* pool) {
+    return pool != NULL ? pool->worker_count : 0;
+}
+
+ReturnError ThreadPool_submit(ThreadPool* pool, TaskFunction function,
+                              void* context, ThreadPoolTask** handle) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (pool == NULL || function == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ThreadPoolTask* task = (ThreadPoolTask*)malloc(sizeof(ThreadPoolTask));
+    if (task == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+    task->function = function;
+    task->context = context;
+    task->detached = handle == NULL;
+    atomic_init(&task->done, false);
+
+    // Hand out the handle first, a detached task may be freed by the time
+    // enqueue returns
+    if (handle != NULL) {
+        *handle = task;
+    }
+
+    result = enqueue(pool, task);
+    if (result.error != NO_ERROR) {
+        free(task);
+        if (handle != NULL) {
+            *handle = NULL;
+        }
+    }
+    return result;
+}
+
+ReturnError ThreadPool_wait(ThreadPool* pool, ThreadPoolTask** handle) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (pool == NULL || handle == NULL || *handle == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    wait_task(pool, *handle);
+    free(*handle);
+    *handle = NULL;
+
+    return result;
+}
+
+typedef struct ParallelForJob {
+    RangeFunction function;
+    void* context;
+    size_t begin;
+    size_t end;
+    size_t grain;
+    size_t chunks;
+    atomic_size_t next_chunk;
+} ParallelForJob;
+
+// Claims chunks until none are left
+static void parallel_for_worker(void* arg) {
+    ParallelForJob* job = (ParallelForJob*)arg;
+
+    for (;;) {
+        size_t chunk = atomic_fetch_add(&job->next_chunk, 1);
+        if (chunk >= job->chunks) {
+            return;
+        }
+        size_t begin = job->begin + chunk * job->grain;
+        size_t end = job->end - begin > job->grain ? begin + job->grain
+                                                   : job->end;
+        job->function(begin, end, job->context);
+    }
+}
+
+ReturnError ThreadPool_parallel_for(ThreadPool* pool, size_t begin,
+                                    size_t end, size_t grain,
+                                    RangeFunction function, void* context) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (pool == NULL || function == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (begin >= end) {
+        return result;
+    }
+
+    size_t count = end - begin;
+    if (grain == 0) {
+        size_t target =
+            (pool->worker_count + 1) * PARALLEL_FOR_CHUNKS_PER_THREAD;
+        grain = count / target > 0 ? count / target : 1;
+    }
+
+    ParallelForJob job = {function, context, begin, end, grain,
+                          count / grain + (count % grain != 0), 0};
+
+    // One helper per worker at most, the calling thread is the last one
+    size_t helpers = job.chunks - 1 < pool->worker_count ? job.chunks - 1
+                                                         : pool->worker_count;
+    ThreadPoolTask* tasks = NULL;
+    if (helpers > 0) {
+        tasks = (ThreadPoolTask*)malloc(helpers * sizeof(ThreadPoolTask));
+        if (tasks == NULL) {
+            helpers = 0;
+        }
+    }
+
+    size_t submitted = 0;
+    for (; submitted < helpers; submitted++) {
+        ThreadPoolTask* task = &tasks[submitted];
+        task->function = parallel_for_worker;
+        task->context = &job;
+        task->detached = false;
+        atomic_init(&task->done, false);
+        if (enqueue(pool, task).error != NO_ERROR) {
+            break;
+        }
+    }
+
+    parallel_for_worker(&job);
+
+    // Helpers that start late find no chunks left and return at once
+    for (size_t i = 0; i < submitted; i++) {
+        wait_task(pool, &tasks[i]);
+    }
+    free(tasks);
+
+    return result;
+}
@@ -0,0 +1,159 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/data_types.h"
+#include "../data_structures/arrays/ring_buffer.h"
+
+/**
+ * @brief Function run by a task.
+ *
+ * @param context Pointer handed to ThreadPool_submit.
+ */
+typedef void (*TaskFunction)(void* context);
+
+/**
+ * @brief Function run on one chunk of a ThreadPool_parallel_for range.
+ *
+ * @param begin First index of the chunk.
+ * @param end One past the last index of the chunk.
+ * @param context Pointer handed to ThreadPool_parallel_for.
+ */
+typedef void (*RangeFunction)(size_t begin, size_t end, void* context);
+
+/**
+ * @brief Join handle of a submitted task.
+ */
+typedef struct ThreadPoolTask {
+    TaskFunction function;  ///< Function to run
+    void* context;          ///< Pointer handed to function
+    atomic_bool done;       ///< Set once function has returned
+    bool detached;          ///< Freed by the worker, nobody waits for it
+} ThreadPoolTask;
+
+/**
+ * @brief Work-stealing thread pool.
+ *
+ * Every worker owns a Chase-Lev deque. A task submitted from inside a task
+ * goes onto the bottom of its worker's deque, where the worker takes it back
+ * first while it is still in cache, and idle workers steal the oldest tasks
+ * from the top of other deques without taking any lock. Tasks submitted from
+ * outside the pool go through a shared queue. Threads waiting for a task run
+ * other tasks in the meantime, so tasks may wait for tasks they submitted
+ * without tying up a worker.
+ */
+typedef struct ThreadPool {
+    size_t worker_count;               ///< Number of worker threads
+    struct ThreadPoolWorker* workers;  ///< worker_count workers
+    pthread_mutex_t lock;              ///< Guards injected and sleeping
+    pthread_cond_t work;               ///< Idle workers sleep here
+    pthread_cond_t finished;           ///< Idle waiters sleep here
+    RingBuffer* injected;              ///< Tasks from outside the pool
+    atomic_size_t injected_count;      ///< Tasks in injected
+    atomic_size_t pending;             ///< Tasks queued but not started
+    atomic_size_t sleepers;            ///< Workers sleeping on work
+    atomic_size_t waiters;             ///< Threads sleeping on finished
+    atomic_bool stopping;              ///< Set by ThreadPool_destroy
+} ThreadPool;
+
+typedef struct ReturnThreadPoolType {
+    ErrorCode error;
+    ThreadPool* pool;
+} ReturnThreadPool;
+
+/**
+ * @brief Creates a new ThreadPool and starts its workers.
+ *
+ * @param threads Number of worker threads, or 0 for one less than the number
+ * of online CPUs (at least 1), since the threads that wait on the pool also
+ * run tasks.
+ *
+ * @return ReturnThreadPool will either return an ErrorCode or a ThreadPool*
+ */
+ReturnThreadPool ThreadPool_create(size_t threads);
+
+/**
+ * @brief Returns the ThreadPool shared by the whole process, creating it
+ * with ThreadPool_create(0) on first use. It is never destroyed.
+ *
+ * @return ThreadPool*, NULL if it could not be created.
+ */
+ThreadPool* ThreadPool_shared(void);
+
+/**
+ * @brief Runs every task already submitted, stops the workers and frees
+ * associated memory.
+ *
+ * Must not be called from a task of the pool. Every task with a join handle
+ * must have been waited for.
+ *
+ * @param pool Pointer to the ThreadPool to be destroyed.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError ThreadPool_destroy(ThreadPool** pool);
+
+/**
+ * @brief Returns the number of worker threads.
+ *
+ * @param pool Pointer to the ThreadPool.
+ *
+ * @return size_t number of workers, 0 if pool is NULL
+ */
+size_t ThreadPool_size(const ThreadPool* pool);
+
+/**
+ * @brief Submits a task to run on the pool.
+ *
+ * @param pool Pointer to the ThreadPool.
+ * @param function Function to run.
+ * @param context Pointer handed to function.
+ * @param handle Receives a join handle that must be passed to
+ * ThreadPool_wait, or NULL to let the task run on its own.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError ThreadPool_submit(ThreadPool* pool, TaskFunction function,
+                              void* context, ThreadPoolTask** handle);
+
+/**
+ * @brief Waits for a task to finish, running other tasks of the pool in the
+ * meantime, then frees its handle.
+ *
+ * @param pool Pointer to the ThreadPool the task was submitted to.
+ * @param handle Pointer to the join handle, set to NULL afterwards.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError ThreadPool_wait(ThreadPool* pool, ThreadPoolTask** handle);
+
+/**
+ * @brief Calls function on chunks of [begin, end) in parallel and returns
+ * once every chunk is done.
+ *
+ * The calling thread works through chunks too. Chunks are handed out one at
+ * a time to whichever thread asks next, so uneven chunks balance out. May be
+ * called from inside a task.
+ *
+ * @param pool Pointer to the ThreadPool.
+ * @param begin First index of the range.
+ * @param end One past the last index of the range.
+ * @param grain Size of each chunk, or 0 to pick one from the range size and
+ * the number of workers.
+ * @param function Function called on every chunk.
+ * @param context Pointer handed to function.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError ThreadPool_parallel_for(ThreadPool* pool, size_t begin,
+                                    size_t end, size_t grain,
+                                    RangeFunction function, void* context);
+
+#endif
@@ -1,6 +1,83 @@
 #include "array.h"
 
+#include "../../concurrency/thread_pool.h"
+#include "array_search.h"
+#include "array_unchecked.h"
+
+// Address of the slot at index inside the contiguous buffer
+static inline void* element_at(const Array* arr, size_t index) {
+    return (char*)arr->data + index * arr->data_size;
+}
+
+// Byte offset of ptr inside the Array's buffer, SIZE_MAX if it points
+// elsewhere. Lets callers find a view into the Array again after the buffer
+// moves.
+static size_t offset_in_buffer(const Array* arr, const void* ptr) {
+    uintptr_t begin = (uintptr_t)arr->data;
+    uintptr_t address = (uintptr_t)ptr;
+    if (arr->data == NULL || address < begin ||
+        address - begin >= arr->capacity * arr->data_size) {
+        return SIZE_MAX;
+    }
+    return (size_t)(address - begin);
+}
+
+#define ARRAY_DEFAULT_GROWTH_FACTOR 2.0
+#define ARRAY_PAGE_SIZE ((size_t)4096)
+
+// Capacity the growth policy picks to hold at least required elements
+static size_t grown_capacity(const Array* arr, size_t required) {
+    size_t max_capacity = SIZE_MAX / arr->data_size;
+    size_t capacity = arr->capacity;
+    size_t grown;
+
+    if (arr->growth.mode == GROWTH_INCREMENT) {
+        grown = arr->growth.increment > max_capacity - capacity
+                    ? max_capacity
+                    : capacity + arr->growth.increment;
+    } else {
+        double scaled = (double)capacity * arr->growth.factor;
+        grown = scaled >= (double)max_capacity ? max_capacity : (size_t)scaled;
+    }
+
+    // Always make progress and always fit the request
+    if (grown <= capacity) {
+        grown = capacity < max_capacity ? capacity + 1 : max_capacity;
+    }
+    if (grown < required) {
+        grown = required;
+    }
+
+    // Round the buffer up to whole pages and use all of it
+    if (arr->growth.mode == GROWTH_PAGE) {
+        size_t bytes = grown * arr->data_size;
+        if (bytes <= SIZE_MAX - (ARRAY_PAGE_SIZE - 1)) {
+            bytes = (bytes + ARRAY_PAGE_SIZE - 1) / ARRAY_PAGE_SIZE *
+                    ARRAY_PAGE_SIZE;
+            grown = bytes / arr->data_size;
+        }
+    }
+
+    return grown;
+}
+
+// Grows the Array by its policy if it cannot hold required elements
+static ReturnError ensure_capacity(Array* arr, size_t required) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (required <= arr->capacity) {
+        return result;
+    }
+
+    return Array_resize(arr, grown_capacity(arr, required));
+}
+
 ReturnArray Array_create(size_t data_size, size_t capacity) {
+    return Array_create_with_allocator(data_size, capacity, NULL);
+}
+
+ReturnArray Array_create_with_allocator(size_t data_size, size_t capacity,
+                                        const Allocator* allocator) {
     ReturnArray result = {.error = NO_ERROR, .arr = NULL};
 
     // Check valid arguments
@@ -9,43 +86,42 @@ ReturnArray Array_create(size_t data_size, size_t capacity) {
         return result;
     }
 
+    // Guard against capacity * data_size overflowing
+    if (capacity > SIZE_MAX / data_size) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
     // Allocate memory and check for NULL
-    Array* arr = (Array*)malloc(sizeof(Array));
+    Array* arr = (Array*)Allocator_alloc(allocator, sizeof(Array));
     if (arr == NULL) {
         result.error = ERROR_ALLOCATION;
         return result;
     }
 
+    // Keep a copy of the allocator, a zeroed one means the standard library
+    if (allocator != NULL) {
+        arr->allocator = *allocator;
+    } else {
+        memset(&arr->allocator, 0, sizeof(Allocator));
+    }
+
     // Assign arguments to array params
     arr->size = 0;
     arr->capacity = capacity;
     arr->data_size = data_size;
+    arr->growth.mode = GROWTH_GEOMETRIC;
+    arr->growth.factor = ARRAY_DEFAULT_GROWTH_FACTOR;
+    arr->growth.increment = 0;
 
-    // Allocate memory and check for NULL
-    arr->values = (T*)malloc(capacity * sizeof(T));
-    if (arr->values == NULL) {
+    // Allocate one buffer for every element and check for NULL
+    arr->data = Allocator_alloc(allocator, capacity * data_size);
+    if (arr->data == NULL) {
         result.error = ERROR_ALLOCATION;
-        free(arr);
+        Allocator_free(allocator, arr, sizeof(Array));
         return result;
     }
 
-    // For each element in array allocate memory and check for NULL
-    for (size_t i = 0; i < capacity; i++) {
-        arr->values[i].size = data_size;
-        arr->values[i].data = malloc(data_size);
-        if (arr->values[i].data == NULL) {
-            result.error = ERROR_ALLOCATION;
-
-            // Free allocated memory
-            for (size_t j = 0; j < i; j++) {
-                free(arr->values[j].data);
-            }
-            free(arr->values);
-            free(arr);
-            return result;
-        }
-    }
-
     // Everything went good
     result.arr = arr;
 
@@ -60,11 +136,11 @@ ReturnError Array_destroy(Array** arr) {
         return result;
     }
 
-    for (size_t i = 0; i < (*arr)->capacity; i++) {
-        free((*arr)->values[i].data);
-    }
-    free((*arr)->values);
-    free(*arr);
+    // Copy the allocator out, it lives inside the block being freed
+    Allocator allocator = (*arr)->allocator;
+    Allocator_free(&allocator, (*arr)->data,
+                   (*arr)->capacity * (*arr)->data_size);
+    Allocator_free(&allocator, *arr, sizeof(Array));
     *arr = NULL;
 
     return result;
@@ -74,45 +150,52 @@ ReturnError Array_append(Array* arr, T* element) {
     ReturnError result = {.error = NO_ERROR};
 
     // Check if array or element is NULL
-    if (arr == NULL || element == NULL) {
+    if (arr == NULL || element == NULL || element->data == NULL) {
         result.error = ERROR_NULL;
         return result;
     }
 
-    // Check if array is full and check for errors
-    ReturnBool is_full_result = Array_is_full(arr);
-    if (is_full_result.error > 0) {
-        result.error = is_full_result.error;
+    // Elements must match the size of the Array's slots
+    if (element->size != arr->data_size) {
+        result.error = ERROR;
         return result;
     }
 
-    // If array is full, resize it and check for errors
-    if (is_full_result.value == true) {
-        ReturnError resize_result = Array_resize(arr, arr->capacity * 2 + 1);
-        if (resize_result.error > 0) {
-            result.error = resize_result.error;
-            return result;
-        }
+    // Check the new size can be represented
+    if (arr->size == SIZE_MAX) {
+        result.error = ERROR_ALLOCATION;
+        return result;
     }
 
-    // Set the last value in the array to the element and check for errors
-    ReturnError set_result = Array_set(arr, arr->size, element);
-    if (set_result.error > 0) {
-        result.error = set_result.error;
+    // If array is full, grow it and check for errors. element may be a view
+    // into this same Array, so find it again in the moved buffer.
+    size_t offset = offset_in_buffer(arr, element->data);
+    ReturnError resize_result = ensure_capacity(arr, arr->size + 1);
+    if (resize_result.error > 0) {
+        result.error = resize_result.error;
         return result;
     }
+    const void* source = element->data;
+    if (offset != SIZE_MAX) {
+        source = (char*)arr->data + offset;
+    }
 
-    // increment size counter
-    arr->size += 1;
+    // Everything was checked above, write straight into the free slot
+    Array_push_unchecked(arr, source);
 
     return result;
 }
 
 ReturnError Array_insert(Array* arr, size_t index, T* element) {
+    return Array_insert_n(arr, index, element, 1);
+}
+
+ReturnError Array_insert_n(Array* arr, size_t index, T* elements,
+                           size_t count) {
     ReturnError result = {.error = NO_ERROR};
 
-    // Check if array or element is NULL
-    if (arr == NULL || element == NULL) {
+    // Check if array or elements is NULL
+    if (arr == NULL || elements == NULL || elements->data == NULL) {
         result.error = ERROR_NULL;
         return result;
     }
@@ -123,53 +206,63 @@ ReturnError Array_insert(Array* arr, size_t index, T* element) {
         return result;
     }
 
-    // Check if array is full
-    ReturnBool is_full_result = Array_is_full(arr);
-    if (is_full_result.error > 0) {
-        result.error = is_full_result.error;
+    // Elements must match the size of the Array's slots
+    if (elements->size != arr->data_size) {
+        result.error = ERROR;
         return result;
     }
 
-    // if array is full resize it
-    if (is_full_result.value == true) {
-        ReturnError resize_result = Array_resize(arr, arr->capacity * 2 + 1);
-        if (resize_result.error > 0) {
-            result.error = resize_result.error;
-            return result;
-        }
+    if (count == 0) {
+        return result;
     }
 
-    ReturnData get_result;
-    ReturnError set_result;
-
-    // Loop starting at end shifting elements to the right
-    for (size_t i = arr->size; i > index; i--) {
-        get_result = Array_get(arr, i - 1);
-        if (get_result.error > 0) {
-            result.error = get_result.error;
-            return result;
-        }
-        set_result = Array_set(arr, i, get_result.value);
-        if (set_result.error > 0) {
-            result.error = set_result.error;
-            return result;
-        }
+    // Check the new size can be represented
+    if (count > SIZE_MAX - arr->size) {
+        result.error = ERROR_ALLOCATION;
+        return result;
     }
 
-    // Set the element at specified index
-    set_result = Array_set(arr, index, element);
-    if (set_result.error > 0) {
-        result.error = set_result.error;
+    // if there is not enough room grow it. elements may be a view into this
+    // same Array, so find it again in the moved buffer.
+    size_t offset = offset_in_buffer(arr, elements->data);
+    ReturnError resize_result = ensure_capacity(arr, arr->size + count);
+    if (resize_result.error > 0) {
+        result.error = resize_result.error;
         return result;
     }
 
+    // Shift the tail to the right in one block to open a gap
+    size_t bytes = count * arr->data_size;
+    memmove(element_at(arr, index + count), element_at(arr, index),
+            (arr->size - index) * arr->data_size);
+
+    // Copy the new elements into the gap
+    if (offset == SIZE_MAX) {
+        memcpy(element_at(arr, index), elements->data, bytes);
+    } else {
+        // Source bytes in front of the gap stayed put, the ones behind it
+        // were just shifted right along with the tail
+        size_t gap = index * arr->data_size;
+        size_t before = offset < gap ? gap - offset : 0;
+        if (before > bytes) {
+            before = bytes;
+        }
+        memcpy((char*)arr->data + gap, (char*)arr->data + offset, before);
+        memcpy((char*)arr->data + gap + before,
+               (char*)arr->data + offset + before + bytes, bytes - before);
+    }
+
     // increment counter
-    arr->size += 1;
+    arr->size += count;
 
     return result;
 }
 
 ReturnError Array_remove(Array* arr, size_t index) {
+    return Array_remove_range(arr, index, 1);
+}
+
+ReturnError Array_remove_range(Array* arr, size_t index, size_t count) {
     ReturnError result = {.error = NO_ERROR};
 
     // Check if array is null
@@ -178,49 +271,30 @@ ReturnError Array_remove(Array* arr, size_t index) {
         return result;
     }
 
-    if (index >= arr->size) {
+    // Check the whole range is in bounds
+    if (index >= arr->size || count > arr->size - index) {
         result.error = ERROR_INDEX;
         return result;
     }
 
-    ReturnData get_result;
-    ReturnError set_result;
-
-    // Loop start at index and shift to left
-    for (size_t i = index; i < arr->size - 1; i++) {
-        get_result = Array_get(arr, i + 1);
-        if (get_result.error > 0) {
-            result.error = get_result.error;
-            return result;
-        }
-        set_result = Array_set(arr, i, get_result.value);
-        if (set_result.error > 0) {
-            result.error = set_result.error;
-            return result;
-        }
-    }
-
-    // idk if this will work
-    T temp;
-    temp.size = arr->data_size;
-    temp.data = &(int){0};
+    // Shift the tail to the left in one block to close the gap
+    size_t tail = arr->size - index - count;
+    memmove(element_at(arr, index), element_at(arr, index + count),
+            tail * arr->data_size);
 
-    set_result = Array_set(arr, arr->size - 1, &temp);
-    if (set_result.error > 0) {
-        result.error = set_result.error;
-        return result;
-    }
+    // Zero out the vacated slots at the end
+    memset(element_at(arr, index + tail), 0, count * arr->data_size);
 
     // decrement size counter
-    arr->size -= 1;
+    arr->size -= count;
 
     return result;
 }
 
-ReturnData Array_get(const Array* arr, size_t index) {
-    ReturnData result = {.error = NO_ERROR, .value = NULL};
+ReturnView Array_get(const Array* arr, size_t index) {
+    ReturnView result = {.error = NO_ERROR, .value = {0, NULL}};
 
-    if (arr == NULL || arr->values == NULL) {
+    if (arr == NULL || arr->data == NULL) {
         result.error = ERROR_NULL;
         return result;
     }
@@ -230,9 +304,9 @@ ReturnData Array_get(const Array* arr, size_t index) {
         return result;
     }
 
-    // who tf knows
-    // return &((const char*)arr->data)[index * arr->data_size];
-    result.value = &(arr->values[index]);
+    // The view is returned by value, so every call gets its own
+    result.value.size = arr->data_size;
+    result.value.data = element_at(arr, index);
 
     return result;
 }
@@ -245,7 +319,7 @@ ReturnError Array_set(Array* arr, size_t index, T* element) {
         return result;
     }
 
-    if (index > arr->size) {
+    if (index > arr->size || index >= arr->capacity) {
         result.error = ERROR_INDEX;
         return result;
     }
@@ -255,31 +329,24 @@ ReturnError Array_set(Array* arr, size_t index, T* element) {
         return result;
     }
 
-    arr->values[index].size = element->size;
-    memcpy(arr->values[index].data, element->data, element->size);
+    // memmove since element may be a view into this same Array
+    memmove(element_at(arr, index), element->data, arr->data_size);
 
     return result;
-
-    // if (arr != NULL && arr->data != NULL && index <= arr->size) {
-    //     memcpy(&((char*)arr->data)[index * arr->data_size], element,
-    //            arr->data_size);
-    // }
 }
 
 ReturnSizeT Array_find(const Array* arr, T* element) {
     ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
 
-    if (arr == NULL || arr->values == NULL || element == NULL) {
+    if (arr == NULL || arr->data == NULL || element == NULL) {
         result.error = ERROR_NULL;
         return result;
     }
 
-    for (size_t i = 0; i < arr->size; i++) {
-        if ((arr->values[i].size == element->size) &&
-            (memcmp(arr->values[i].data, element->data, element->size) == 0)) {
-            result.value = i;
-            break;
-        }
+    // Every slot has the same size so only check it once
+    if (element->size == arr->data_size) {
+        result.value = ArraySearch_find(arr->data, arr->size, arr->data_size,
+                                        element->data);
     }
 
     // Assume nobody has a 18 quintillion long array
@@ -290,6 +357,75 @@ ReturnSizeT Array_find(const Array* arr, T* element) {
     return result;
 }
 
+ReturnSizeT Array_find_mask(const Array* arr, T* element, uint64_t* mask) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = 0};
+
+    if (arr == NULL || arr->data == NULL || element == NULL || mask == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (element->size != arr->data_size) {
+        memset(mask, 0, (arr->size + 63) / 64 * sizeof(uint64_t));
+        return result;
+    }
+
+    result.value = ArraySearch_find_mask(arr->data, arr->size, arr->data_size,
+                                         element->data, mask);
+
+    return result;
+}
+
+ReturnArray Array_find_all(const Array* arr, T* element) {
+    ReturnArray result = {.error = NO_ERROR, .arr = NULL};
+
+    if (arr == NULL || arr->data == NULL || element == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    size_t words = (arr->size + 63) / 64;
+    uint64_t* mask = (uint64_t*)malloc((words ? words : 1) * sizeof(uint64_t));
+    if (mask == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    ReturnSizeT mask_result = Array_find_mask(arr, element, mask);
+    if (mask_result.error > 0) {
+        result.error = mask_result.error;
+        free(mask);
+        return result;
+    }
+
+    // Size the index list exactly, Array_create needs at least one slot
+    size_t matches = mask_result.value;
+    ReturnArray create_result = Array_create_with_allocator(
+        sizeof(size_t), matches ? matches : 1, &arr->allocator);
+    if (create_result.error > 0) {
+        result.error = create_result.error;
+        free(mask);
+        return result;
+    }
+
+    // Walk the set bits of the mask, skipping empty words
+    size_t* indices = (size_t*)create_result.arr->data;
+    for (size_t word = 0; word < words; word++) {
+        uint64_t bits = mask[word];
+        for (size_t bit = 0; bits != 0; bit++, bits >>= 1) {
+            if (bits & 1) {
+                *indices++ = word * 64 + bit;
+            }
+        }
+    }
+    create_result.arr->size = matches;
+
+    free(mask);
+    result.arr = create_result.arr;
+
+    return result;
+}
+
 ReturnSizeT Array_size(const Array* arr) {
     ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
 
@@ -346,32 +482,35 @@ ReturnError Array_resize(Array* arr, size_t new_capacity) {
         return result;
     }
 
-    // might wanna check that new_capacity isnt like 100 quadrillion or some
-    // stupid large number
-
-    // Re-allocate new_values array
-    T* new_values = (T*)realloc(arr->values, new_capacity * sizeof(T));
-    if (new_values == NULL) {
+    // Guard against new_capacity * data_size overflowing
+    if (new_capacity > SIZE_MAX / arr->data_size) {
         result.error = ERROR_ALLOCATION;
         return result;
     }
 
-    // free or allocate T.data pointers whether the array is shrinking or
-    // growing
-    if (new_capacity < arr->capacity) {
-        for (size_t i = new_capacity; i < arr->capacity; i++) {
-            free(arr->values[i].data);
-            arr->values[i].data = NULL;
-        }
+    // A zero capacity releases the buffer entirely
+    if (new_capacity == 0) {
+        Allocator_free(&arr->allocator, arr->data,
+                       arr->capacity * arr->data_size);
+        arr->data = NULL;
+        arr->size = 0;
+        arr->capacity = 0;
+        return result;
+    }
+
+    // Re-allocate the buffer, the leading elements are carried over
+    void* new_data;
+    if (arr->data == NULL) {
+        new_data = Allocator_alloc(&arr->allocator,
+                                   new_capacity * arr->data_size);
     } else {
-        for (size_t i = arr->capacity; i < new_capacity; i++) {
-            new_values[i].size = arr->data_size;
-            new_values[i].data = malloc(arr->data_size);
-            if (new_values[i].data == NULL) {
-                result.error = ERROR_ALLOCATION;
-                return result;
-            }
-        }
+        new_data = Allocator_realloc(&arr->allocator, arr->data,
+                                     arr->capacity * arr->data_size,
+                                     new_capacity * arr->data_size);
+    }
+    if (new_data == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
     }
 
     // Assign new values
@@ -379,28 +518,82 @@ ReturnError Array_resize(Array* arr, size_t new_capacity) {
         arr->size = new_capacity;
     }
     arr->capacity = new_capacity;
-    arr->values = new_values;
+    arr->data = new_data;
 
     return result;
 }
 
-ReturnError Array_clear(Array* arr) {
+ReturnError Array_reserve(Array* arr, size_t capacity) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (arr == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    // Reserving never shrinks the Array
+    if (capacity <= arr->capacity) {
+        return result;
+    }
+
+    return Array_resize(arr, capacity);
+}
+
+ReturnError Array_shrink_to_fit(Array* arr) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (arr == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (arr->capacity == arr->size) {
+        return result;
+    }
+
+    return Array_resize(arr, arr->size);
+}
+
+ReturnError Array_set_growth_policy(Array* arr, GrowthPolicy policy) {
     ReturnError result = {.error = NO_ERROR};
 
-    if (arr == NULL || arr->values == NULL) {
+    if (arr == NULL) {
         result.error = ERROR_NULL;
         return result;
     }
 
-    // Free the T.data pointers
-    for (size_t i = 0; i < arr->capacity; i++) {
-        free(arr->values[i].data);
-        arr->values[i].data = NULL;
+    // Factors must actually grow the Array, increments must add something
+    bool valid = false;
+    switch (policy.mode) {
+        case GROWTH_GEOMETRIC:
+        case GROWTH_PAGE:
+            valid = policy.factor > 1.0;
+            break;
+        case GROWTH_INCREMENT:
+            valid = policy.increment > 0;
+            break;
+    }
+
+    if (!valid) {
+        result.error = ERROR;
+        return result;
+    }
+
+    arr->growth = policy;
+    return result;
+}
+
+ReturnError Array_clear(Array* arr) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (arr == NULL || arr->data == NULL) {
+        result.error = ERROR_NULL;
+        return result;
     }
 
-    // Free Array.values and set counters to 0
-    free(arr->values);
-    arr->values = NULL;
+    // Free Array.data and set counters to 0
+    Allocator_free(&arr->allocator, arr->data, arr->capacity * arr->data_size);
+    arr->data = NULL;
     arr->size = 0;
     arr->capacity = 0;
 
@@ -415,19 +608,188 @@ ReturnError Array_iterate(const Array* arr, CallbackFunction callback) {
         return result;
     }
 
-    ReturnData get_result;
+    // Bounds were checked once above, walk the buffer directly
+    T element = {arr->data_size, NULL};
     for (size_t i = 0; i < arr->size; i++) {
-        get_result = Array_get(arr, i);
-        if (get_result.error > 0) {
-            result.error = get_result.error;
-            return result;
+        element.data = element_at(arr, i);
+        callback(&element);
+    }
+
+    return result;
+}
+
+ReturnError Array_iterate_ctx(const Array* arr,
+                              ContextCallbackFunction callback,
+                              void* context) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (arr == NULL || callback == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    T element = {arr->data_size, NULL};
+    for (size_t i = 0; i < arr->size; i++) {
+        element.data = element_at(arr, i);
+        callback(&element, context);
+    }
+
+    return result;
+}
+
+ReturnError Array_iterate_blocks(const Array* arr,
+                                 BlockCallbackFunction callback,
+                                 void* context, size_t block_elements) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (arr == NULL || callback == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (block_elements == 0) {
+        block_elements = arr->size;
+    }
+
+    for (size_t i = 0; i < arr->size; i += block_elements) {
+        size_t count = arr->size - i < block_elements ? arr->size - i
+                                                      : block_elements;
+        callback(element_at(arr, i), count, context);
+    }
+
+    return result;
+}
+
+/*
+ * Parallel for each. Every thread claims chunks from a shared counter until
+ * none are left. Chunks are a whole number of cache lines long and the first
+ * one is cut short so the rest start on a line boundary, which keeps threads
+ * from ever writing to the same line.
+ */
+
+#define ARRAY_CACHE_LINE ((size_t)64)
+#define ARRAY_PARALLEL_FOR_EACH_CUTOFF ((size_t)1 << 14)
+#define ARRAY_CHUNKS_PER_THREAD 8
+
+typedef struct ForEachJob {
+    char* data;
+    size_t data_size;
+    size_t size;
+    size_t head;    ///< Elements before the first line boundary
+    size_t grain;   ///< Elements per chunk
+    size_t chunks;  ///< Number of chunks, the first one holds head elements
+    atomic_size_t next_chunk;
+    ContextCallbackFunction callback;
+    void* context;
+} ForEachJob;
+
+static size_t gcd(size_t a, size_t b) {
+    while (b != 0) {
+        size_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// Run by every thread, lanes only cap how many threads take part
+static void for_each_lane(size_t begin, size_t end, void* arg) {
+    (void)begin;
+    (void)end;
+    ForEachJob* job = (ForEachJob*)arg;
+    T element = {job->data_size, NULL};
+
+    for (;;) {
+        size_t chunk = atomic_fetch_add(&job->next_chunk, 1);
+        if (chunk >= job->chunks) {
+            return;
+        }
+        size_t first = chunk == 0 ? 0 : job->head + (chunk - 1) * job->grain;
+        size_t last = job->head + chunk * job->grain;
+        last = last < job->size ? last : job->size;
+
+        char* data = job->data + first * job->data_size;
+        for (size_t i = first; i < last; i++) {
+            element.data = data;
+            job->callback(&element, job->context);
+            data += job->data_size;
         }
-        callback(get_result.value);
     }
+}
+
+ReturnError Array_parallel_for_each(Array* arr,
+                                    ContextCallbackFunction callback,
+                                    void* context, size_t threads) {
+    ReturnError result = {.error = NO_ERROR};
 
+    if (arr == NULL || callback == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ThreadPool* pool = NULL;
+    if (arr->size >= ARRAY_PARALLEL_FOR_EACH_CUTOFF && threads != 1) {
+        pool = ThreadPool_shared();
+    }
+    size_t lanes = ThreadPool_size(pool) + 1;
+    if (threads != 0 && threads < lanes) {
+        lanes = threads;
+    }
+    if (pool == NULL || lanes < 2) {
+        return Array_iterate_ctx(arr, callback, context);
+    }
+
+    // Smallest run of elements that fills whole cache lines
+    size_t line_elements =
+        ARRAY_CACHE_LINE / gcd(arr->data_size, ARRAY_CACHE_LINE);
+    size_t grain = arr->size / (lanes * ARRAY_CHUNKS_PER_THREAD);
+    grain = (grain / line_elements + 1) * line_elements;
+
+    // First element that starts a line, if any element does
+    size_t head = 0;
+    uintptr_t base = (uintptr_t)arr->data;
+    while (head < line_elements &&
+           (base + head * arr->data_size) % ARRAY_CACHE_LINE != 0) {
+        head++;
+    }
+    if (head == line_elements) {
+        head = 0;
+    }
+
+    ForEachJob job = {(char*)arr->data,
+                      arr->data_size,
+                      arr->size,
+                      head,
+                      grain,
+                      1 + (arr->size - head + grain - 1) / grain,
+                      0,
+                      callback,
+                      context};
+    result = ThreadPool_parallel_for(pool, 0, lanes, 1, for_each_lane, &job);
     return result;
 }
 
+// Swap two equally sized blocks through a small stack buffer, never allocates
+static void swap_bytes(void* a, void* b, size_t size) {
+    if (a == b) {
+        return;
+    }
+
+    unsigned char buffer[64];
+    unsigned char* pa = (unsigned char*)a;
+    unsigned char* pb = (unsigned char*)b;
+
+    while (size > 0) {
+        size_t chunk = size < sizeof(buffer) ? size : sizeof(buffer);
+        memcpy(buffer, pa, chunk);
+        memcpy(pa, pb, chunk);
+        memcpy(pb, buffer, chunk);
+        pa += chunk;
+        pb += chunk;
+        size -= chunk;
+    }
+}
+
 ReturnError Array_swap(Array* arr, size_t index_a, size_t index_b) {
     ReturnError result = {.error = NO_ERROR};
 
@@ -441,92 +803,442 @@ ReturnError Array_swap(Array* arr, size_t index_a, size_t index_b) {
         return result;
     }
 
-    // Allocate a temp variable
-    T* temp = (T*)malloc(sizeof(T));
-    if (temp == NULL) {
-        result.error = ERROR_ALLOCATION;
-        return result;
+    swap_bytes(element_at(arr, index_a), element_at(arr, index_b),
+               arr->data_size);
+
+    return result;
+}
+
+/*
+ * Pattern-defeating quicksort (pdqsort) over the contiguous buffer.
+ *
+ * Ranges below SORT_INSERTION_THRESHOLD are finished with insertion sort.
+ * Pivots are the median of three, or a pseudo median of nine above
+ * SORT_NINTHER_THRESHOLD. Partitions that come out highly unbalanced cost
+ * one "bad pivot"; once log2(n) of those are used up the range falls back to
+ * heapsort, so the worst case stays O(n log n). Ranges that were already
+ * partitioned are finished with a bounded insertion sort, which makes sorted
+ * and nearly sorted input close to linear. Runs of elements equal to the
+ * previous pivot are split off with partition_left, and the sort only ever
+ * recurses into the smaller side so the stack depth is O(log n).
+ */
+
+#define SORT_INSERTION_THRESHOLD 24
+#define SORT_NINTHER_THRESHOLD 128
+#define SORT_PARTIAL_INSERTION_LIMIT 8
+
+typedef struct SortContext {
+    char* base;
+    size_t data_size;
+    CompareFunction compare;
+} SortContext;
+
+static inline char* sort_at(const SortContext* ctx, size_t index) {
+    return ctx->base + index * ctx->data_size;
+}
+
+static inline bool sort_less(const SortContext* ctx, size_t a, size_t b) {
+    T element_a = {ctx->data_size, sort_at(ctx, a)};
+    T element_b = {ctx->data_size, sort_at(ctx, b)};
+    return ctx->compare(&element_a, &element_b) < 0;
+}
+
+static inline void sort_swap(const SortContext* ctx, size_t a, size_t b) {
+    swap_bytes(sort_at(ctx, a), sort_at(ctx, b), ctx->data_size);
+}
+
+// Sorts the elements at a, b and c in place
+static void sort3(const SortContext* ctx, size_t a, size_t b, size_t c) {
+    if (sort_less(ctx, b, a)) {
+        sort_swap(ctx, a, b);
     }
-    temp->data = malloc(arr->data_size);
-    if (temp->data == NULL) {
-        result.error = ERROR_ALLOCATION;
-        return result;
+    if (sort_less(ctx, c, b)) {
+        sort_swap(ctx, b, c);
+    }
+    if (sort_less(ctx, b, a)) {
+        sort_swap(ctx, a, b);
     }
+}
 
-    // Get value at index a
-    ReturnData get_result;
-    get_result = Array_get(arr, index_a);
-    if (get_result.error > 0) {
-        result.error = get_result.error;
-        return result;
+static void insertion_sort(const SortContext* ctx, size_t begin, size_t end) {
+    for (size_t i = begin + 1; i < end; i++) {
+        for (size_t j = i; j > begin && sort_less(ctx, j, j - 1); j--) {
+            sort_swap(ctx, j, j - 1);
+        }
     }
+}
 
-    // assign temp = a
-    temp->size = get_result.value->size;
-    memcpy(temp->data, get_result.value->data, get_result.value->size);
+// Insertion sort that gives up once it has moved too many elements. Returns
+// true if the range ended up sorted.
+static bool partial_insertion_sort(const SortContext* ctx, size_t begin,
+                                   size_t end) {
+    size_t moves = 0;
+
+    for (size_t i = begin + 1; i < end; i++) {
+        size_t j = i;
+        while (j > begin && sort_less(ctx, j, j - 1)) {
+            sort_swap(ctx, j, j - 1);
+            j--;
+        }
 
-    // get value at index b
-    get_result = Array_get(arr, index_b);
-    if (get_result.error > 0) {
-        result.error = get_result.error;
-        return result;
+        moves += i - j;
+        if (moves > SORT_PARTIAL_INSERTION_LIMIT) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void sift_down(const SortContext* ctx, size_t begin, size_t root,
+                      size_t count) {
+    while (true) {
+        size_t child = 2 * root + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count &&
+            sort_less(ctx, begin + child, begin + child + 1)) {
+            child++;
+        }
+        if (!sort_less(ctx, begin + root, begin + child)) {
+            break;
+        }
+        sort_swap(ctx, begin + root, begin + child);
+        root = child;
+    }
+}
+
+static void heap_sort(const SortContext* ctx, size_t begin, size_t end) {
+    size_t count = end - begin;
+
+    for (size_t i = count / 2; i-- > 0;) {
+        sift_down(ctx, begin, i, count);
+    }
+
+    for (size_t last = count - 1; last > 0; last--) {
+        sort_swap(ctx, begin, begin + last);
+        sift_down(ctx, begin, 0, last);
+    }
+}
+
+// Partitions [begin, end) around the pivot at begin. Elements equal to the
+// pivot go to the right. Returns the final pivot position and reports whether
+// the range needed no swaps at all.
+static size_t partition_right(const SortContext* ctx, size_t begin, size_t end,
+                              bool* already_partitioned) {
+    size_t first = begin;
+    size_t last = end;
+
+    // The median selection guarantees an element >= pivot on the right
+    while (sort_less(ctx, ++first, begin)) {
+    }
+
+    if (first - 1 == begin) {
+        while (first < last && !sort_less(ctx, --last, begin)) {
+        }
+    } else {
+        while (!sort_less(ctx, --last, begin)) {
+        }
+    }
+
+    *already_partitioned = first >= last;
+
+    while (first < last) {
+        sort_swap(ctx, first, last);
+        while (sort_less(ctx, ++first, begin)) {
+        }
+        while (!sort_less(ctx, --last, begin)) {
+        }
+    }
+
+    size_t pivot_pos = first - 1;
+    sort_swap(ctx, begin, pivot_pos);
+    return pivot_pos;
+}
+
+// Partitions [begin, end) around the pivot at begin, putting elements equal
+// to the pivot on the left. Used when the pivot equals the element before
+// the range, so everything equal to it is already in its final place.
+static size_t partition_left(const SortContext* ctx, size_t begin,
+                             size_t end) {
+    size_t first = begin;
+    size_t last = end;
+
+    while (sort_less(ctx, begin, --last)) {
     }
 
-    // Set index a = value b
-    ReturnError set_result;
-    set_result = Array_set(arr, index_a, get_result.value);
-    if (set_result.error > 0) {
-        result.error = set_result.error;
+    if (last + 1 == end) {
+        while (first < last && !sort_less(ctx, begin, ++first)) {
+        }
+    } else {
+        while (!sort_less(ctx, begin, ++first)) {
+        }
+    }
+
+    while (first < last) {
+        sort_swap(ctx, first, last);
+        while (sort_less(ctx, begin, --last)) {
+        }
+        while (!sort_less(ctx, begin, ++first)) {
+        }
+    }
+
+    sort_swap(ctx, begin, last);
+    return last;
+}
+
+// Swaps a few elements around after a highly unbalanced partition to break
+// up patterns that produce bad pivots
+static void break_patterns(const SortContext* ctx, size_t begin,
+                           size_t pivot_pos, size_t end) {
+    size_t left_size = pivot_pos - begin;
+    size_t right_size = end - (pivot_pos + 1);
+
+    if (left_size >= SORT_INSERTION_THRESHOLD) {
+        size_t quarter = left_size / 4;
+        sort_swap(ctx, begin, begin + quarter);
+        sort_swap(ctx, pivot_pos - 1, pivot_pos - quarter);
+
+        if (left_size > SORT_NINTHER_THRESHOLD) {
+            sort_swap(ctx, begin + 1, begin + quarter + 1);
+            sort_swap(ctx, begin + 2, begin + quarter + 2);
+            sort_swap(ctx, pivot_pos - 2, pivot_pos - (quarter + 1));
+            sort_swap(ctx, pivot_pos - 3, pivot_pos - (quarter + 2));
+        }
+    }
+
+    if (right_size >= SORT_INSERTION_THRESHOLD) {
+        size_t quarter = right_size / 4;
+        sort_swap(ctx, pivot_pos + 1, pivot_pos + 1 + quarter);
+        sort_swap(ctx, end - 1, end - quarter);
+
+        if (right_size > SORT_NINTHER_THRESHOLD) {
+            sort_swap(ctx, pivot_pos + 2, pivot_pos + 2 + quarter);
+            sort_swap(ctx, pivot_pos + 3, pivot_pos + 3 + quarter);
+            sort_swap(ctx, end - 2, end - (1 + quarter));
+            sort_swap(ctx, end - 3, end - (2 + quarter));
+        }
+    }
+}
+
+static void pdq_sort(const SortContext* ctx, size_t begin, size_t end,
+                     int bad_allowed, bool leftmost) {
+    while (true) {
+        size_t size = end - begin;
+
+        if (size < SORT_INSERTION_THRESHOLD) {
+            insertion_sort(ctx, begin, end);
+            return;
+        }
+
+        // Move the chosen pivot to begin
+        size_t half = size / 2;
+        if (size > SORT_NINTHER_THRESHOLD) {
+            sort3(ctx, begin, begin + half, end - 1);
+            sort3(ctx, begin + 1, begin + half - 1, end - 2);
+            sort3(ctx, begin + 2, begin + half + 1, end - 3);
+            sort3(ctx, begin + half - 1, begin + half, begin + half + 1);
+            sort_swap(ctx, begin, begin + half);
+        } else {
+            sort3(ctx, begin + half, begin, end - 1);
+        }
+
+        // If the pivot equals the element just before this range, every
+        // element equal to it is already placed; skip over all of them
+        if (!leftmost && !sort_less(ctx, begin - 1, begin)) {
+            begin = partition_left(ctx, begin, end) + 1;
+            continue;
+        }
+
+        bool already_partitioned;
+        size_t pivot_pos =
+            partition_right(ctx, begin, end, &already_partitioned);
+
+        size_t left_size = pivot_pos - begin;
+        size_t right_size = end - (pivot_pos + 1);
+        bool highly_unbalanced = left_size < size / 8 || right_size < size / 8;
+
+        if (highly_unbalanced) {
+            if (--bad_allowed == 0) {
+                heap_sort(ctx, begin, end);
+                return;
+            }
+            break_patterns(ctx, begin, pivot_pos, end);
+        } else if (already_partitioned &&
+                   partial_insertion_sort(ctx, begin, pivot_pos) &&
+                   partial_insertion_sort(ctx, pivot_pos + 1, end)) {
+            return;
+        }
+
+        // Recurse into the smaller side, loop on the larger one
+        if (left_size < right_size) {
+            pdq_sort(ctx, begin, pivot_pos, bad_allowed, leftmost);
+            begin = pivot_pos + 1;
+            leftmost = false;
+        } else {
+            pdq_sort(ctx, pivot_pos + 1, end, bad_allowed, false);
+            end = pivot_pos;
+        }
+    }
+}
+
+ReturnError Array_sort(Array* arr, CompareFunction compare) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (arr == NULL || compare == NULL) {
+        result.error = ERROR_NULL;
         return result;
     }
 
-    // Set index b = value a (temp)
-    set_result = Array_set(arr, index_b, temp);
-    if (set_result.error > 0) {
-        result.error = set_result.error;
+    if (arr->size < 2) {
         return result;
     }
 
-    // Free temp
-    free(temp->data);
-    free(temp);
+    // Allow log2(n) bad pivots before switching to heapsort
+    int bad_allowed = 1;
+    for (size_t n = arr->size; n > 1; n >>= 1) {
+        bad_allowed++;
+    }
+
+    SortContext ctx = {(char*)arr->data, arr->data_size, compare};
+    pdq_sort(&ctx, 0, arr->size, bad_allowed, true);
 
     return result;
 }
 
-static size_t partition(Array* arr, size_t low, size_t high,
-                        CompareFunction compare) {
-    ReturnData get_result;
-    get_result = Array_get(arr, high);
-    T* pivot = get_result.value;
-    size_t i = low - 1;
+/*
+ * Parallel sort. The Array is cut into one run per thread and every run is
+ * sorted concurrently with the serial sort. Runs are then merged pairwise in
+ * rounds between the Array and a scratch buffer. Each round is split into
+ * equal slices of output, and every thread locates its slice in the two input
+ * runs with a binary search (merge path), so the merge itself is parallel and
+ * load balanced even once only two runs are left.
+ */
+
+#define ARRAY_PARALLEL_SORT_CUTOFF ((size_t)1 << 16)
+#define ARRAY_PARALLEL_MIN_RUN ((size_t)1 << 14)
+
+typedef struct SortRunTask {
+    Array run;
+    CompareFunction compare;
+} SortRunTask;
+
+typedef struct MergeSliceTask {
+    const char* source;
+    char* destination;
+    size_t data_size;
+    size_t count;
+    size_t run_length;
+    size_t out_begin;
+    size_t out_end;
+    CompareFunction compare;
+} MergeSliceTask;
+
+typedef struct TaskList {
+    TaskFunction function;
+    char* tasks;
+    size_t task_size;
+} TaskList;
+
+static void run_task_range(size_t begin, size_t end, void* arg) {
+    TaskList* list = (TaskList*)arg;
+    for (size_t i = begin; i < end; i++) {
+        list->function(list->tasks + i * list->task_size);
+    }
+}
 
-    for (size_t j = low; j < high; j++) {
-        get_result = Array_get(arr, j);
-        if (compare(get_result.value, pivot) < 0) {
-            i++;
-            Array_swap(arr, i, j);
-        }
+// Runs fn over every task on the shared ThreadPool, with the calling thread
+// taking part. Tasks are handed out one at a time and no more helpers are
+// started than there are tasks left after the caller's, so at most count
+// threads run at once. Without a pool every task runs on the calling thread.
+static void run_tasks(TaskFunction fn, void* tasks, size_t task_size,
+                      size_t count) {
+    TaskList list = {fn, (char*)tasks, task_size};
+    ThreadPool* pool = ThreadPool_shared();
+    if (pool == NULL ||
+        ThreadPool_parallel_for(pool, 0, count, 1, run_task_range, &list)
+                .error != NO_ERROR) {
+        run_task_range(0, count, &list);
     }
+}
 
-    Array_swap(arr, i + 1, high);
-    return i + 1;
+static void sort_run_worker(void* arg) {
+    SortRunTask* task = (SortRunTask*)arg;
+    Array_sort(&task->run, task->compare);
 }
 
-static void quick_sort(Array* arr, size_t low, size_t high,
-                       CompareFunction compare) {
-    if (low < high) {
-        size_t pi = partition(arr, low, high, compare);
+static inline bool merge_less(const MergeSliceTask* task, const char* a,
+                              const char* b) {
+    T element_a = {task->data_size, (void*)a};
+    T element_b = {task->data_size, (void*)b};
+    return task->compare(&element_a, &element_b) < 0;
+}
 
-        if (pi > 0) {
-            quick_sort(arr, low, pi - 1, compare);
+// Number of elements taken from a among the first k outputs of a stable
+// merge of a (length a_len) and b (length b_len)
+static size_t merge_co_rank(const MergeSliceTask* task, size_t k,
+                            const char* a, size_t a_len, const char* b,
+                            size_t b_len) {
+    size_t size = task->data_size;
+    size_t low = k > b_len ? k - b_len : 0;
+    size_t high = k < a_len ? k : a_len;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        size_t j = k - mid;
+
+        // a[mid] is emitted before b[j - 1], so more of a belongs in front
+        if (!merge_less(task, b + (j - 1) * size, a + mid * size)) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
+    }
+
+    return low;
+}
 
-        quick_sort(arr, pi + 1, high, compare);
+static void merge_slice_worker(void* arg) {
+    MergeSliceTask* task = (MergeSliceTask*)arg;
+    size_t size = task->data_size;
+    size_t pair_length = task->run_length * 2;
+    size_t out = task->out_begin;
+
+    while (out < task->out_end) {
+        // Locate the pair of runs this output index falls into
+        size_t pair_begin = (out / pair_length) * pair_length;
+        size_t middle = pair_begin + task->run_length;
+        size_t pair_end = pair_begin + pair_length;
+        middle = middle < task->count ? middle : task->count;
+        pair_end = pair_end < task->count ? pair_end : task->count;
+
+        const char* a = task->source + pair_begin * size;
+        const char* b = task->source + middle * size;
+        size_t a_len = middle - pair_begin;
+        size_t b_len = pair_end - middle;
+
+        size_t slice_end = task->out_end < pair_end ? task->out_end : pair_end;
+        size_t i = merge_co_rank(task, out - pair_begin, a, a_len, b, b_len);
+        size_t j = (out - pair_begin) - i;
+        char* destination = task->destination + out * size;
+
+        for (; out < slice_end; out++) {
+            if (j >= b_len ||
+                (i < a_len && !merge_less(task, b + j * size, a + i * size))) {
+                memcpy(destination, a + i * size, size);
+                i++;
+            } else {
+                memcpy(destination, b + j * size, size);
+                j++;
+            }
+            destination += size;
+        }
     }
 }
 
-ReturnError Array_sort(Array* arr, CompareFunction compare) {
+ReturnError Array_sort_parallel(Array* arr, CompareFunction compare,
+                                size_t threads) {
     ReturnError result = {.error = NO_ERROR};
 
     if (arr == NULL || compare == NULL) {
@@ -534,9 +1246,172 @@ ReturnError Array_sort(Array* arr, CompareFunction compare) {
         return result;
     }
 
-    if (arr != NULL && compare != NULL) {
-        quick_sort(arr, 0, arr->size - 1, compare);
+    // One run per thread and one merge slice per thread, so threads bounds
+    // how many threads take part. Runs past what the shared pool can work
+    // on at once would only add merge rounds. 0 asks for all of them.
+    ThreadPool* pool = ThreadPool_shared();
+    size_t lanes = pool != NULL ? ThreadPool_size(pool) + 1 : 1;
+    if (threads == 0 || threads > lanes) {
+        threads = lanes;
+    }
+
+    // Keep every run big enough to be worth a thread
+    size_t max_threads = arr->size / ARRAY_PARALLEL_MIN_RUN;
+    if (threads > max_threads) {
+        threads = max_threads;
+    }
+
+    if (arr->size < ARRAY_PARALLEL_SORT_CUTOFF || threads < 2) {
+        return Array_sort(arr, compare);
+    }
+
+    size_t count = arr->size;
+    size_t size = arr->data_size;
+    size_t run_length = (count + threads - 1) / threads;
+
+    void* scratch = malloc(count * size);
+    SortRunTask* sort_tasks =
+        (SortRunTask*)malloc(threads * sizeof(SortRunTask));
+    MergeSliceTask* merge_tasks =
+        (MergeSliceTask*)malloc(threads * sizeof(MergeSliceTask));
+    if (scratch == NULL || sort_tasks == NULL || merge_tasks == NULL) {
+        free(scratch);
+        free(sort_tasks);
+        free(merge_tasks);
+        return Array_sort(arr, compare);
+    }
+
+    // Sort every run on its own thread through a window onto the buffer
+    size_t runs = 0;
+    for (size_t begin = 0; begin < count; begin += run_length) {
+        size_t length = count - begin < run_length ? count - begin : run_length;
+        sort_tasks[runs].run = *arr;
+        sort_tasks[runs].run.size = length;
+        sort_tasks[runs].run.capacity = length;
+        sort_tasks[runs].run.data = (char*)arr->data + begin * size;
+        sort_tasks[runs].compare = compare;
+        runs++;
+    }
+    run_tasks(sort_run_worker, sort_tasks, sizeof(SortRunTask), runs);
+
+    // Merge runs pairwise until one is left, alternating buffers each round
+    char* source = (char*)arr->data;
+    char* destination = (char*)scratch;
+    for (; run_length < count; run_length *= 2) {
+        for (size_t t = 0; t < threads; t++) {
+            merge_tasks[t].source = source;
+            merge_tasks[t].destination = destination;
+            merge_tasks[t].data_size = size;
+            merge_tasks[t].count = count;
+            merge_tasks[t].run_length = run_length;
+            merge_tasks[t].out_begin = count / threads * t;
+            merge_tasks[t].out_end =
+                t + 1 == threads ? count : count / threads * (t + 1);
+            merge_tasks[t].compare = compare;
+        }
+        run_tasks(merge_slice_worker, merge_tasks, sizeof(MergeSliceTask),
+                  threads);
+
+        char* temp = source;
+        source = destination;
+        destination = temp;
+    }
+
+    if (source != arr->data) {
+        memcpy(arr->data, source, count * size);
+    }
+
+    free(scratch);
+    free(sort_tasks);
+    free(merge_tasks);
+
+    return result;
+}
+
+// Index of the first element not ordered before element, or after it when
+// upper is set, among the count elements starting at low
+static size_t search_bound(const Array* arr, size_t low, size_t count,
+                           const T* element, CompareFunction compare,
+                           bool upper) {
+    while (count > 0) {
+        size_t half = count / 2;
+        size_t mid = low + half;
+
+        T current = {arr->data_size, element_at(arr, mid)};
+        int order = compare(&current, element);
+
+        if (upper ? order <= 0 : order < 0) {
+            low = mid + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+
+    return low;
+}
+
+ReturnSizeT Array_lower_bound(const Array* arr, T* element,
+                              CompareFunction compare) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
+
+    if (arr == NULL || element == NULL || compare == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.value = search_bound(arr, 0, arr->size, element, compare, false);
+    return result;
+}
+
+ReturnSizeT Array_upper_bound(const Array* arr, T* element,
+                              CompareFunction compare) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
+
+    if (arr == NULL || element == NULL || compare == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.value = search_bound(arr, 0, arr->size, element, compare, true);
+    return result;
+}
+
+ReturnRange Array_equal_range(const Array* arr, T* element,
+                              CompareFunction compare) {
+    ReturnRange result = {.error = NO_ERROR, .begin = SIZE_MAX,
+                          .end = SIZE_MAX};
+
+    if (arr == NULL || element == NULL || compare == NULL) {
+        result.error = ERROR_NULL;
+        return result;
     }
 
+    // The upper bound can only be at or after the lower bound
+    result.begin = search_bound(arr, 0, arr->size, element, compare, false);
+    result.end = search_bound(arr, result.begin, arr->size - result.begin,
+                              element, compare, true);
     return result;
-}
\ No newline at end of file
+}
+
+ReturnSizeT Array_bsearch(const Array* arr, T* element,
+                          CompareFunction compare) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
+
+    if (arr == NULL || element == NULL || compare == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    size_t index = search_bound(arr, 0, arr->size, element, compare, false);
+    if (index < arr->size) {
+        T current = {arr->data_size, element_at(arr, index)};
+        if (compare(&current, element) == 0) {
+            result.value = index;
+            return result;
+        }
+    }
+
+    result.error = ERROR_NOT_FOUND;
+    return result;
+}
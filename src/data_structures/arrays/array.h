@@ -19,6 +19,19 @@
  */
 ReturnArray Array_create(size_t data_size, size_t capacity);
 
+/**
+ * @brief Creates a new Array whose memory comes from a custom allocator.
+ *
+ * @param data_size Size of each element in bytes.
+ * @param capacity Maximum capacity of the Array.
+ * @param allocator Allocator for the Array and its buffer. It is copied into
+ * the Array; NULL uses the standard library.
+ *
+ * @return ReturnArrayType will either return an ErrorCode or an Array*
+ */
+ReturnArray Array_create_with_allocator(size_t data_size, size_t capacity,
+                                        const Allocator* allocator);
+
 /**
  * @brief Destroys a Array and frees associated memory.
  *
@@ -49,6 +62,21 @@ ReturnError Array_append(Array* arr, T* element);
  */
 ReturnError Array_insert(Array* arr, size_t index, T* element);
 
+/**
+ * @brief Inserts several elements at a specific index in the Array, shifting
+ * the existing tail once.
+ *
+ * @param arr Pointer to the Array.
+ * @param index Index at which the first element will be inserted.
+ * @param elements GenericDataType whose size is the Array's data_size and
+ * whose data points to count contiguous elements.
+ * @param count Number of elements to insert.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_insert_n(Array* arr, size_t index, T* elements,
+                           size_t count);
+
 /**
  * @brief Removes an element at a specific index from the Array.
  *
@@ -59,16 +87,29 @@ ReturnError Array_insert(Array* arr, size_t index, T* element);
  */
 ReturnError Array_remove(Array* arr, size_t index);
 
+/**
+ * @brief Removes a range of elements from the Array, shifting the remaining
+ * tail once.
+ *
+ * @param arr Pointer to the Array.
+ * @param index Index of the first element to be removed.
+ * @param count Number of elements to remove.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_remove_range(Array* arr, size_t index, size_t count);
+
 /**
  * @brief Retrieves an element at a specific index in the Array.
  *
  * @param arr Pointer to the Array.
  * @param index Index of the element to be retrieved.
  *
- * @return ReturnData will return a struct contain an ErrorCode enum and a
- * GenericDataType pointer
+ * @return ReturnView will return a struct contain an ErrorCode enum and a
+ * GenericDataType. The GenericDataType is a view into the Array's storage and
+ * is only valid until the Array is resized.
  */
-ReturnData Array_get(const Array* arr, size_t index);
+ReturnView Array_get(const Array* arr, size_t index);
 
 /**
  * @brief Updates the value of an element at a specific index in the Array.
@@ -92,6 +133,29 @@ ReturnError Array_set(Array* arr, size_t index, T* element);
  */
 ReturnSizeT Array_find(const Array* arr, T* element);
 
+/**
+ * @brief Marks every element in the Array equal to element in a bitmask.
+ *
+ * @param arr Pointer to the Array.
+ * @param element Pointer to the element to be searched for.
+ * @param mask Output of (size + 63) / 64 words. Bit i % 64 of word i / 64 is
+ * set when the element at index i matches.
+ *
+ * @return The number of matching elements.
+ */
+ReturnSizeT Array_find_mask(const Array* arr, T* element, uint64_t* mask);
+
+/**
+ * @brief Finds the index of every element in the Array equal to element.
+ *
+ * @param arr Pointer to the Array.
+ * @param element Pointer to the element to be searched for.
+ *
+ * @return ReturnArray holding a new Array of size_t indices in ascending
+ * order, empty if nothing matched. The caller owns and destroys it.
+ */
+ReturnArray Array_find_all(const Array* arr, T* element);
+
 /**
  * @brief Retrieves the current number of elements in the Array.
  *
@@ -139,6 +203,39 @@ ReturnBool Array_is_full(const Array* arr);
  */
 ReturnError Array_resize(Array* arr, size_t new_capacity);
 
+/**
+ * @brief Makes sure the Array can hold at least capacity elements without
+ * growing. Never shrinks the Array.
+ *
+ * @param arr Pointer to the Array.
+ * @param capacity Minimum capacity for the Array.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_reserve(Array* arr, size_t capacity);
+
+/**
+ * @brief Shrinks the capacity of the Array down to its size, releasing the
+ * buffer entirely when the Array is empty.
+ *
+ * @param arr Pointer to the Array.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_shrink_to_fit(Array* arr);
+
+/**
+ * @brief Sets how the Array grows when appends or inserts run out of room.
+ * Arrays start out GROWTH_GEOMETRIC with a factor of 2.
+ *
+ * @param arr Pointer to the Array.
+ * @param policy The new growth policy. GROWTH_GEOMETRIC and GROWTH_PAGE need a
+ * factor above 1, GROWTH_INCREMENT needs a non-zero increment.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_set_growth_policy(Array* arr, GrowthPolicy policy);
+
 /**
  * @brief Clears all elements from the Array.
  *
@@ -159,6 +256,63 @@ ReturnError Array_clear(Array* arr);
  */
 ReturnError Array_iterate(const Array* arr, CallbackFunction callback);
 
+/**
+ * @brief Iterates over the elements of the Array and applies a callback
+ * function that also receives a context pointer.
+ *
+ * @param arr Pointer to the Array.
+ * @param callback Callback function to apply to each element.
+ * @param context Pointer handed to every call of callback.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_iterate_ctx(const Array* arr,
+                              ContextCallbackFunction callback,
+                              void* context);
+
+/**
+ * @brief Hands the elements of the Array to a callback function one
+ * contiguous block at a time.
+ *
+ * The callback gets a pointer into the buffer and an element count, so it
+ * can run a plain loop over the block that the compiler can vectorize,
+ * instead of paying an indirect call for every element.
+ *
+ * @param arr Pointer to the Array.
+ * @param callback Callback function to apply to each block.
+ * @param context Pointer handed to every call of callback.
+ * @param block_elements Largest number of elements per block, or 0 to hand
+ * over the whole Array in one block.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_iterate_blocks(const Array* arr,
+                                 BlockCallbackFunction callback,
+                                 void* context, size_t block_elements);
+
+/**
+ * @brief Applies a callback function to every element on several threads of
+ * the shared ThreadPool.
+ *
+ * The Array is cut into chunks whose boundaries fall on cache line
+ * boundaries of the buffer, so two threads never write to the same line.
+ * Chunks are handed out one at a time, so uneven work balances out. Arrays
+ * too small to benefit, or a threads count of 1, are iterated on the calling
+ * thread. Elements may be visited in any order and callback must be safe to
+ * call from several threads at once.
+ *
+ * @param arr Pointer to the Array.
+ * @param callback Callback function to apply to each element.
+ * @param context Pointer handed to every call of callback.
+ * @param threads Maximum number of threads to use, including the caller, or
+ * 0 for every thread of the shared ThreadPool.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_parallel_for_each(Array* arr,
+                                    ContextCallbackFunction callback,
+                                    void* context, size_t threads);
+
 /**
  * @brief Swaps the elements at two indices in the Array.
  *
@@ -181,4 +335,79 @@ ReturnError Array_swap(Array* arr, size_t index_a, size_t index_b);
  */
 ReturnError Array_sort(Array* arr, CompareFunction compare);
 
+/**
+ * @brief Sorts the elements of the Array on several threads.
+ *
+ * The Array is split into one run per thread, the runs are sorted
+ * concurrently and then merged with a parallel merge. Arrays too small to
+ * benefit, or a threads count of 1, use Array_sort directly. The result is
+ * identical to Array_sort whenever compare only reports equality for
+ * identical elements; like Array_sort, the order of equal elements is
+ * unspecified.
+ *
+ * @param arr Pointer to the Array.
+ * @param compare Comparison function for sorting elements.
+ * @param threads Maximum number of threads to use, including the caller, or
+ * 0 for every thread of the shared ThreadPool. The work runs on the shared
+ * ThreadPool, so no more than its workers plus the caller are used even if
+ * threads is larger.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Array_sort_parallel(Array* arr, CompareFunction compare,
+                                size_t threads);
+
+/**
+ * @brief Finds the first element of a sorted Array that is not ordered
+ * before element.
+ *
+ * @param arr Pointer to an Array sorted by compare.
+ * @param element Pointer to the element to be searched for.
+ * @param compare Comparison function the Array was sorted with.
+ *
+ * @return The index of that element, or the Array's size if there is none.
+ */
+ReturnSizeT Array_lower_bound(const Array* arr, T* element,
+                              CompareFunction compare);
+
+/**
+ * @brief Finds the first element of a sorted Array that is ordered after
+ * element.
+ *
+ * @param arr Pointer to an Array sorted by compare.
+ * @param element Pointer to the element to be searched for.
+ * @param compare Comparison function the Array was sorted with.
+ *
+ * @return The index of that element, or the Array's size if there is none.
+ */
+ReturnSizeT Array_upper_bound(const Array* arr, T* element,
+                              CompareFunction compare);
+
+/**
+ * @brief Finds the range of elements in a sorted Array that compare equal to
+ * element.
+ *
+ * @param arr Pointer to an Array sorted by compare.
+ * @param element Pointer to the element to be searched for.
+ * @param compare Comparison function the Array was sorted with.
+ *
+ * @return ReturnRange holding the lower and upper bound; the range is empty
+ * when no element matches.
+ */
+ReturnRange Array_equal_range(const Array* arr, T* element,
+                              CompareFunction compare);
+
+/**
+ * @brief Binary searches a sorted Array for an element.
+ *
+ * @param arr Pointer to an Array sorted by compare.
+ * @param element Pointer to the element to be searched for.
+ * @param compare Comparison function the Array was sorted with.
+ *
+ * @return The index of the first element equal to element, or SIZE_MAX with
+ * ERROR_NOT_FOUND.
+ */
+ReturnSizeT Array_bsearch(const Array* arr, T* element,
+                          CompareFunction compare);
+
 #endif
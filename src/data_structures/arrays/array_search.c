@@ -0,0 +1,364 @@
+#include "array_search.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ARRAY_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+// Selects the first byte of every element in a vector compare byte mask
+static const uint32_t STRIDE_MASK[9] = {
+    [1] = 0xFFFFFFFFu,
+    [2] = 0x55555555u,
+    [4] = 0x11111111u,
+    [8] = 0x01010101u,
+};
+
+static inline void mask_set(uint64_t* mask, size_t index) {
+    mask[index / 64] |= (uint64_t)1 << (index % 64);
+}
+
+/*
+ * Scalar kernels
+ */
+
+#define SCALAR_FIND(type)                                               \
+    do {                                                                \
+        type target;                                                    \
+        memcpy(&target, key, sizeof(type));                             \
+        for (size_t i = 0; i < count; i++) {                            \
+            type value;                                                 \
+            memcpy(&value, bytes + i * sizeof(type), sizeof(type));     \
+            if (value == target) {                                      \
+                return i;                                               \
+            }                                                           \
+        }                                                               \
+        return SIZE_MAX;                                                \
+    } while (0)
+
+static size_t scalar_find(const char* bytes, size_t count, size_t width,
+                          const void* key) {
+    switch (width) {
+        case 1:
+            SCALAR_FIND(uint8_t);
+        case 2:
+            SCALAR_FIND(uint16_t);
+        case 4:
+            SCALAR_FIND(uint32_t);
+        case 8:
+            SCALAR_FIND(uint64_t);
+        default:
+            for (size_t i = 0; i < count; i++) {
+                if (memcmp(bytes + i * width, key, width) == 0) {
+                    return i;
+                }
+            }
+            return SIZE_MAX;
+    }
+}
+
+#undef SCALAR_FIND
+
+#define SCALAR_MASK(type)                                               \
+    do {                                                                \
+        type target;                                                    \
+        memcpy(&target, key, sizeof(type));                             \
+        for (size_t i = 0; i < count; i++) {                            \
+            type value;                                                 \
+            memcpy(&value, bytes + i * sizeof(type), sizeof(type));     \
+            if (value == target) {                                      \
+                mask_set(mask, first + i);                              \
+                matches++;                                              \
+            }                                                           \
+        }                                                               \
+    } while (0)
+
+// Marks matches among count elements, numbering them from first
+static size_t scalar_mask(const char* bytes, size_t count, size_t width,
+                          const void* key, uint64_t* mask, size_t first) {
+    size_t matches = 0;
+
+    switch (width) {
+        case 1:
+            SCALAR_MASK(uint8_t);
+            break;
+        case 2:
+            SCALAR_MASK(uint16_t);
+            break;
+        case 4:
+            SCALAR_MASK(uint32_t);
+            break;
+        case 8:
+            SCALAR_MASK(uint64_t);
+            break;
+        default:
+            for (size_t i = 0; i < count; i++) {
+                if (memcmp(bytes + i * width, key, width) == 0) {
+                    mask_set(mask, first + i);
+                    matches++;
+                }
+            }
+            break;
+    }
+
+    return matches;
+}
+
+#undef SCALAR_MASK
+
+#ifdef ARRAY_SEARCH_X86
+
+/*
+ * SSE2 kernels, 16 bytes per block. SSE2 has no 64 bit compare so 8 byte
+ * elements need both of their 32 bit halves to match.
+ */
+
+__attribute__((target("sse2"))) static inline __m128i sse2_broadcast(
+    uint64_t key, size_t width) {
+    switch (width) {
+        case 1:
+            return _mm_set1_epi8((char)key);
+        case 2:
+            return _mm_set1_epi16((short)key);
+        case 4:
+            return _mm_set1_epi32((int)key);
+        default:
+            return _mm_set1_epi64x((long long)key);
+    }
+}
+
+// Byte mask with the first bit of every matching element in the block set
+__attribute__((target("sse2"))) static inline uint32_t sse2_block(
+    const char* bytes, __m128i target, size_t width) {
+    __m128i values = _mm_loadu_si128((const __m128i*)bytes);
+    __m128i equal;
+
+    switch (width) {
+        case 1:
+            equal = _mm_cmpeq_epi8(values, target);
+            break;
+        case 2:
+            equal = _mm_cmpeq_epi16(values, target);
+            break;
+        case 4:
+            equal = _mm_cmpeq_epi32(values, target);
+            break;
+        default:
+            equal = _mm_cmpeq_epi32(values, target);
+            equal = _mm_and_si128(
+                equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+            break;
+    }
+
+    return (uint32_t)_mm_movemask_epi8(equal) & STRIDE_MASK[width];
+}
+
+__attribute__((target("sse2"))) static size_t sse2_find(const char* bytes,
+                                                        size_t count,
+                                                        size_t width,
+                                                        const void* key) {
+    uint64_t key_bits = 0;
+    memcpy(&key_bits, key, width);
+    __m128i target = sse2_broadcast(key_bits, width);
+
+    size_t total = count * width;
+    size_t offset = 0;
+    for (; offset + 16 <= total; offset += 16) {
+        uint32_t hits = sse2_block(bytes + offset, target, width);
+        if (hits != 0) {
+            return (offset + (size_t)__builtin_ctz(hits)) / width;
+        }
+    }
+
+    size_t done = offset / width;
+    size_t found = scalar_find(bytes + offset, count - done, width, key);
+    return found == SIZE_MAX ? SIZE_MAX : done + found;
+}
+
+__attribute__((target("sse2"))) static size_t sse2_mask(const char* bytes,
+                                                        size_t count,
+                                                        size_t width,
+                                                        const void* key,
+                                                        uint64_t* mask) {
+    uint64_t key_bits = 0;
+    memcpy(&key_bits, key, width);
+    __m128i target = sse2_broadcast(key_bits, width);
+
+    size_t matches = 0;
+    size_t total = count * width;
+    size_t offset = 0;
+    for (; offset + 16 <= total; offset += 16) {
+        uint32_t hits = sse2_block(bytes + offset, target, width);
+        while (hits != 0) {
+            mask_set(mask, (offset + (size_t)__builtin_ctz(hits)) / width);
+            matches++;
+            hits &= hits - 1;
+        }
+    }
+
+    size_t done = offset / width;
+    return matches + scalar_mask(bytes + offset, count - done, width, key,
+                                 mask, done);
+}
+
+/*
+ * AVX2 kernels, 32 bytes per block
+ */
+
+__attribute__((target("avx2"))) static inline __m256i avx2_broadcast(
+    uint64_t key, size_t width) {
+    switch (width) {
+        case 1:
+            return _mm256_set1_epi8((char)key);
+        case 2:
+            return _mm256_set1_epi16((short)key);
+        case 4:
+            return _mm256_set1_epi32((int)key);
+        default:
+            return _mm256_set1_epi64x((long long)key);
+    }
+}
+
+__attribute__((target("avx2"))) static inline uint32_t avx2_block(
+    const char* bytes, __m256i target, size_t width) {
+    __m256i values = _mm256_loadu_si256((const __m256i*)bytes);
+    __m256i equal;
+
+    switch (width) {
+        case 1:
+            equal = _mm256_cmpeq_epi8(values, target);
+            break;
+        case 2:
+            equal = _mm256_cmpeq_epi16(values, target);
+            break;
+        case 4:
+            equal = _mm256_cmpeq_epi32(values, target);
+            break;
+        default:
+            equal = _mm256_cmpeq_epi64(values, target);
+            break;
+    }
+
+    return (uint32_t)_mm256_movemask_epi8(equal) & STRIDE_MASK[width];
+}
+
+__attribute__((target("avx2"))) static size_t avx2_find(const char* bytes,
+                                                        size_t count,
+                                                        size_t width,
+                                                        const void* key) {
+    uint64_t key_bits = 0;
+    memcpy(&key_bits, key, width);
+    __m256i target = avx2_broadcast(key_bits, width);
+
+    size_t total = count * width;
+    size_t offset = 0;
+    for (; offset + 32 <= total; offset += 32) {
+        uint32_t hits = avx2_block(bytes + offset, target, width);
+        if (hits != 0) {
+            return (offset + (size_t)__builtin_ctz(hits)) / width;
+        }
+    }
+
+    size_t done = offset / width;
+    size_t found = scalar_find(bytes + offset, count - done, width, key);
+    return found == SIZE_MAX ? SIZE_MAX : done + found;
+}
+
+__attribute__((target("avx2"))) static size_t avx2_mask(const char* bytes,
+                                                        size_t count,
+                                                        size_t width,
+                                                        const void* key,
+                                                        uint64_t* mask) {
+    uint64_t key_bits = 0;
+    memcpy(&key_bits, key, width);
+    __m256i target = avx2_broadcast(key_bits, width);
+
+    size_t matches = 0;
+    size_t total = count * width;
+    size_t offset = 0;
+    for (; offset + 32 <= total; offset += 32) {
+        uint32_t hits = avx2_block(bytes + offset, target, width);
+        while (hits != 0) {
+            mask_set(mask, (offset + (size_t)__builtin_ctz(hits)) / width);
+            matches++;
+            hits &= hits - 1;
+        }
+    }
+
+    size_t done = offset / width;
+    return matches + scalar_mask(bytes + offset, count - done, width, key,
+                                 mask, done);
+}
+
+#endif
+
+typedef enum {
+    SEARCH_SCALAR = 0,
+    SEARCH_SSE2 = 1,
+    SEARCH_AVX2 = 2,
+} SearchLevel;
+
+static SearchLevel search_level(void) {
+#ifdef ARRAY_SEARCH_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return SEARCH_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SEARCH_SSE2;
+    }
+#endif
+    return SEARCH_SCALAR;
+}
+
+bool ArraySearch_is_vectorized(size_t width) {
+    return width == 1 || width == 2 || width == 4 || width == 8;
+}
+
+size_t ArraySearch_find(const void* base, size_t count, size_t width,
+                        const void* key) {
+    const char* bytes = (const char*)base;
+
+    if (base == NULL || key == NULL || width == 0) {
+        return SIZE_MAX;
+    }
+
+#ifdef ARRAY_SEARCH_X86
+    if (ArraySearch_is_vectorized(width)) {
+        switch (search_level()) {
+            case SEARCH_AVX2:
+                return avx2_find(bytes, count, width, key);
+            case SEARCH_SSE2:
+                return sse2_find(bytes, count, width, key);
+            default:
+                break;
+        }
+    }
+#endif
+
+    return scalar_find(bytes, count, width, key);
+}
+
+size_t ArraySearch_find_mask(const void* base, size_t count, size_t width,
+                             const void* key, uint64_t* mask) {
+    const char* bytes = (const char*)base;
+
+    if (base == NULL || key == NULL || mask == NULL || width == 0) {
+        return 0;
+    }
+
+    memset(mask, 0, (count + 63) / 64 * sizeof(uint64_t));
+
+#ifdef ARRAY_SEARCH_X86
+    if (ArraySearch_is_vectorized(width)) {
+        switch (search_level()) {
+            case SEARCH_AVX2:
+                return avx2_mask(bytes, count, width, key, mask);
+            case SEARCH_SSE2:
+                return sse2_mask(bytes, count, width, key, mask);
+            default:
+                break;
+        }
+    }
+#endif
+
+    return scalar_mask(bytes, count, width, key, mask, 0);
+}
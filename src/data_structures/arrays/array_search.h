@@ -0,0 +1,52 @@
+#ifndef ARRAY_SEARCH_H
+#define ARRAY_SEARCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Linear search kernels over a contiguous buffer of fixed width elements.
+ * Widths of 1, 2, 4 and 8 bytes are compared as integers with SSE2 or AVX2
+ * when the CPU supports them (checked at runtime through CPUID), and with a
+ * scalar loop otherwise. Any other width falls back to memcmp per element.
+ */
+
+/**
+ * @brief Returns true if the kernels have a dedicated path for this width.
+ *
+ * @param width Size of each element in bytes.
+ */
+bool ArraySearch_is_vectorized(size_t width);
+
+/**
+ * @brief Finds the first element equal to key.
+ *
+ * @param base Pointer to the first element.
+ * @param count Number of elements in the buffer.
+ * @param width Size of each element in bytes.
+ * @param key Pointer to width bytes to search for.
+ *
+ * @return The index of the first match, or SIZE_MAX if there is none.
+ */
+size_t ArraySearch_find(const void* base, size_t count, size_t width,
+                        const void* key);
+
+/**
+ * @brief Marks every element equal to key in a bitmask.
+ *
+ * @param base Pointer to the first element.
+ * @param count Number of elements in the buffer.
+ * @param width Size of each element in bytes.
+ * @param key Pointer to width bytes to search for.
+ * @param mask Output of (count + 63) / 64 words. Bit i % 64 of word i / 64 is
+ * set when element i matches; all other bits are cleared.
+ *
+ * @return The number of matching elements.
+ */
+size_t ArraySearch_find_mask(const void* base, size_t count, size_t width,
+                             const void* key, uint64_t* mask);
+
+#endif
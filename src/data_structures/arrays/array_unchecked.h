@@ -0,0 +1,111 @@
+#ifndef ARRAY_UNCHECKED_H
+#define ARRAY_UNCHECKED_H
+
+#include <assert.h>
+
+#include "array.h"
+
+/*
+ * Unchecked fast path for Arrays.
+ *
+ * These are static inline so they compile down to plain pointer arithmetic
+ * and memcpy at the call site, with no return struct to build and inspect.
+ * They are meant for hot loops whose indices and sizes were already checked
+ * once up front. Their preconditions are asserted, so debug builds still
+ * catch misuse, and defining NDEBUG removes every check. Breaking a
+ * precondition in a build with NDEBUG is undefined behaviour.
+ */
+
+/**
+ * @brief Returns the Array's contiguous buffer.
+ *
+ * @param arr Pointer to the Array, must not be NULL.
+ *
+ * @return Pointer to element 0. Valid until the Array is resized.
+ */
+static inline void* Array_data_ptr(const Array* arr) {
+    assert(arr != NULL);
+    return arr->data;
+}
+
+/**
+ * @brief Returns a pointer to the element at an index.
+ *
+ * @param arr Pointer to the Array, must not be NULL.
+ * @param index Index of the element, must be below the size.
+ *
+ * @return Pointer to the element inside the buffer.
+ */
+static inline void* Array_at_unchecked(const Array* arr, size_t index) {
+    assert(arr != NULL && index < arr->size);
+    return (char*)arr->data + index * arr->data_size;
+}
+
+/**
+ * @brief Copies the element at an index out of the Array.
+ *
+ * @param arr Pointer to the Array, must not be NULL.
+ * @param index Index of the element, must be below the size.
+ * @param out Pointer to data_size bytes the element is copied to.
+ */
+static inline void Array_get_unchecked(const Array* arr, size_t index,
+                                       void* out) {
+    memcpy(out, Array_at_unchecked(arr, index), arr->data_size);
+}
+
+/**
+ * @brief Overwrites the element at an index.
+ *
+ * @param arr Pointer to the Array, must not be NULL.
+ * @param index Index of the element, must be below the size.
+ * @param element Pointer to data_size bytes holding the new element, which
+ * must not overlap a different element of the Array.
+ */
+static inline void Array_set_unchecked(Array* arr, size_t index,
+                                       const void* element) {
+    memmove(Array_at_unchecked(arr, index), element, arr->data_size);
+}
+
+/**
+ * @brief Appends an element without growing the Array.
+ *
+ * @param arr Pointer to the Array, must not be NULL and must have room for
+ * one more element, e.g. after Array_reserve.
+ * @param element Pointer to data_size bytes holding the new element.
+ */
+static inline void Array_push_unchecked(Array* arr, const void* element) {
+    assert(arr != NULL && arr->size < arr->capacity);
+    memcpy((char*)arr->data + arr->size * arr->data_size, element,
+           arr->data_size);
+    arr->size++;
+}
+
+/**
+ * @brief Removes the last element.
+ *
+ * @param arr Pointer to the Array, must not be NULL or empty.
+ * @param out Pointer to data_size bytes the element is copied to, may be
+ * NULL.
+ */
+static inline void Array_pop_unchecked(Array* arr, void* out) {
+    assert(arr != NULL && arr->size > 0);
+    arr->size--;
+    if (out != NULL) {
+        memcpy(out, (char*)arr->data + arr->size * arr->data_size,
+               arr->data_size);
+    }
+}
+
+/**
+ * @brief Returns a pointer to the last element.
+ *
+ * @param arr Pointer to the Array, must not be NULL or empty.
+ *
+ * @return Pointer to the element inside the buffer.
+ */
+static inline void* Array_back_unchecked(const Array* arr) {
+    assert(arr != NULL && arr->size > 0);
+    return Array_at_unchecked(arr, arr->size - 1);
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include "eytzinger_array.h"
+
+// Elements one cache line's worth of levels ahead of the current slot
+#define EYTZINGER_PREFETCH_DISTANCE 16
+
+static inline void* slot_at(const EytzingerArray* arr, size_t k) {
+    return (char*)arr->data + k * arr->data_size;
+}
+
+// Fills the slots in order by walking the implicit tree in order. Returns the
+// next sorted index to place.
+static size_t build(EytzingerArray* arr, const Array* sorted, size_t next,
+                    size_t k) {
+    if (k <= arr->size) {
+        next = build(arr, sorted, next, 2 * k);
+        const char* source = (const char*)sorted->data + next * arr->data_size;
+        memcpy(slot_at(arr, k), source, arr->data_size);
+        arr->ranks[k] = next++;
+        next = build(arr, sorted, next, 2 * k + 1);
+    }
+    return next;
+}
+
+ReturnEytzingerArray EytzingerArray_create(const Array* sorted) {
+    ReturnEytzingerArray result = {.error = NO_ERROR, .arr = NULL};
+
+    if (sorted == NULL || (sorted->size > 0 && sorted->data == NULL)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (sorted->size >= SIZE_MAX / sorted->data_size ||
+        sorted->size >= SIZE_MAX / sizeof(size_t)) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    EytzingerArray* arr = (EytzingerArray*)malloc(sizeof(EytzingerArray));
+    if (arr == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    arr->size = sorted->size;
+    arr->data_size = sorted->data_size;
+    arr->data = malloc((arr->size + 1) * arr->data_size);
+    arr->ranks = (size_t*)malloc((arr->size + 1) * sizeof(size_t));
+    if (arr->data == NULL || arr->ranks == NULL) {
+        result.error = ERROR_ALLOCATION;
+        free(arr->data);
+        free(arr->ranks);
+        free(arr);
+        return result;
+    }
+
+    build(arr, sorted, 0, 1);
+
+    result.arr = arr;
+    return result;
+}
+
+ReturnError EytzingerArray_destroy(EytzingerArray** arr) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (arr == NULL || *arr == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    free((*arr)->data);
+    free((*arr)->ranks);
+    free(*arr);
+    *arr = NULL;
+
+    return result;
+}
+
+// Slot of the first element not ordered before element, 0 if there is none
+static size_t lower_bound_slot(const EytzingerArray* arr, const T* element,
+                               CompareFunction compare) {
+    size_t k = 1;
+
+    while (k <= arr->size) {
+#ifdef __GNUC__
+        // Slots k * 16 .. k * 16 + 15 are four levels down
+        if (k * EYTZINGER_PREFETCH_DISTANCE <= arr->size) {
+            __builtin_prefetch(slot_at(arr, k * EYTZINGER_PREFETCH_DISTANCE));
+        }
+#endif
+        T current = {arr->data_size, slot_at(arr, k)};
+        k = 2 * k + (compare(&current, element) < 0);
+    }
+
+    // Undo the right turns taken after the last left turn, plus that left
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+ReturnSizeT EytzingerArray_lower_bound(const EytzingerArray* arr, T* element,
+                                       CompareFunction compare) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
+
+    if (arr == NULL || element == NULL || compare == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    size_t k = lower_bound_slot(arr, element, compare);
+    result.value = k == 0 ? arr->size : arr->ranks[k];
+    return result;
+}
+
+ReturnSizeT EytzingerArray_bsearch(const EytzingerArray* arr, T* element,
+                                   CompareFunction compare) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
+
+    if (arr == NULL || element == NULL || compare == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    size_t k = lower_bound_slot(arr, element, compare);
+    if (k != 0) {
+        T current = {arr->data_size, slot_at(arr, k)};
+        if (compare(&current, element) == 0) {
+            result.value = arr->ranks[k];
+            return result;
+        }
+    }
+
+    result.error = ERROR_NOT_FOUND;
+    return result;
+}
@@ -0,0 +1,72 @@
+#ifndef EYTZINGER_ARRAY_H
+#define EYTZINGER_ARRAY_H
+
+#include "array.h"
+
+/**
+ * @brief Read-only copy of a sorted Array stored in Eytzinger (BFS) order.
+ *
+ * Element k has its children at 2k and 2k + 1, so the first levels of every
+ * search share the same few cache lines and the next levels can be
+ * prefetched. Meant for lookup tables that are sorted once and then searched
+ * many times; the source Array is left untouched and the copy does not follow
+ * later changes to it.
+ */
+typedef struct EytzingerArray {
+    size_t size;       ///< Number of elements
+    size_t data_size;  ///< Size of each element in bytes
+    void* data;        ///< size + 1 slots, slot 0 is unused
+    size_t* ranks;     ///< Index in the sorted Array of each slot
+} EytzingerArray;
+
+typedef struct ReturnEytzingerArrayType {
+    ErrorCode error;
+    EytzingerArray* arr;
+} ReturnEytzingerArray;
+
+/**
+ * @brief Builds an EytzingerArray from a sorted Array.
+ *
+ * @param sorted Pointer to an Array sorted in ascending order.
+ *
+ * @return ReturnEytzingerArray will either return an ErrorCode or an
+ * EytzingerArray*
+ */
+ReturnEytzingerArray EytzingerArray_create(const Array* sorted);
+
+/**
+ * @brief Destroys an EytzingerArray and frees associated memory.
+ *
+ * @param arr Pointer to the EytzingerArray to be destroyed.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError EytzingerArray_destroy(EytzingerArray** arr);
+
+/**
+ * @brief Finds the first element that is not ordered before element.
+ *
+ * @param arr Pointer to the EytzingerArray.
+ * @param element Pointer to the element to be searched for.
+ * @param compare Comparison function the source Array was sorted with.
+ *
+ * @return The index of that element in the source Array, or the size of the
+ * Array if there is none.
+ */
+ReturnSizeT EytzingerArray_lower_bound(const EytzingerArray* arr, T* element,
+                                       CompareFunction compare);
+
+/**
+ * @brief Searches for an element.
+ *
+ * @param arr Pointer to the EytzingerArray.
+ * @param element Pointer to the element to be searched for.
+ * @param compare Comparison function the source Array was sorted with.
+ *
+ * @return The index in the source Array of the first element equal to
+ * element, or SIZE_MAX with ERROR_NOT_FOUND.
+ */
+ReturnSizeT EytzingerArray_bsearch(const EytzingerArray* arr, T* element,
+                                   CompareFunction compare);
+
+#endif
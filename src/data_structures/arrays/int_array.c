@@ -1,5 +1,7 @@
 #include "int_array.h"
 
+#include <limits.h>
+
 Array* IntArray_create(size_t capacity) {
     ReturnArray result = Array_create(sizeof(int), capacity);
     if (result.error > 0) {
@@ -47,13 +49,13 @@ void IntArray_remove(Array* arr, size_t index) {
 }
 
 int IntArray_get(const Array* arr, size_t index) {
-    ReturnData result = Array_get(arr, index);
+    ReturnView result = Array_get(arr, index);
     if (result.error > 0) {
         /**
          * TODO: Error handling
          */
     }
-    return *(int*)result.value->data;
+    return *(int*)result.value.data;
 }
 
 void IntArray_set(Array* arr, size_t index, int element) {
@@ -142,6 +144,84 @@ void IntArray_iterate(const Array* arr, CallbackFunction callback) {
     }
 }
 
+typedef struct IntCallback {
+    IntCallbackFunction callback;
+    void* context;
+} IntCallback;
+
+static void __apply_int__(T* element, void* context) {
+    IntCallback* int_callback = (IntCallback*)context;
+    int_callback->callback((int*)element->data, int_callback->context);
+}
+
+void IntArray_parallel_for_each(Array* arr, IntCallbackFunction callback,
+                                void* context, size_t threads) {
+    IntCallback int_callback = {callback, context};
+    ReturnError result = Array_parallel_for_each(
+        arr, callback != NULL ? __apply_int__ : NULL, &int_callback, threads);
+    if (result.error > 0) {
+        /**
+         * TODO: Error handling
+         */
+    }
+}
+
+typedef struct IntBlock {
+    IntBlockFunction callback;
+    void* context;
+} IntBlock;
+
+static void __apply_block__(void* elements, size_t count, void* context) {
+    IntBlock* int_block = (IntBlock*)context;
+    int_block->callback((int*)elements, count, int_block->context);
+}
+
+void IntArray_apply(Array* arr, IntBlockFunction callback, void* context) {
+    IntBlock int_block = {callback, context};
+    ReturnError result = Array_iterate_blocks(
+        arr, callback != NULL ? __apply_block__ : NULL, &int_block, 0);
+    if (result.error > 0) {
+        /**
+         * TODO: Error handling
+         */
+    }
+}
+
+// Unsigned arithmetic so overflow wraps instead of being undefined
+static void __add__(void* elements, size_t count, void* context) {
+    int* ints = (int*)elements;
+    unsigned value = (unsigned)*(int*)context;
+    for (size_t i = 0; i < count; i++) {
+        ints[i] = (int)((unsigned)ints[i] + value);
+    }
+}
+
+static void __scale__(void* elements, size_t count, void* context) {
+    int* ints = (int*)elements;
+    unsigned factor = (unsigned)*(int*)context;
+    for (size_t i = 0; i < count; i++) {
+        ints[i] = (int)((unsigned)ints[i] * factor);
+    }
+}
+
+void IntArray_apply_add(Array* arr, int value) {
+    ReturnError result = Array_iterate_blocks(arr, __add__, &value, 0);
+    if (result.error > 0) {
+        /**
+         * TODO: Error handling
+         */
+    }
+}
+
+void IntArray_apply_scale(Array* arr, int factor) {
+    ReturnError result = Array_iterate_blocks(arr, __scale__, &factor, 0);
+    if (result.error > 0) {
+        /**
+         * TODO: Error handling
+         */
+    }
+}
+
 void IntArray_swap(Array* arr, size_t index_a, size_t index_b) {
     ReturnError result = Array_swap(arr, index_a, index_b);
     if (result.error > 0) {
@@ -164,7 +244,94 @@ static int __compare__(const T* a, const T* b) {
     }
 }
 
+/*
+ * LSD radix sort for int Arrays. Keys are biased by flipping the sign bit so
+ * that negative values order before positive ones as unsigned integers. All
+ * digit histograms are built in a single pass up front, and any pass where
+ * every key falls into one bucket is skipped. Small Arrays, or a failed
+ * scratch allocation, fall back to the comparison sort.
+ */
+
+#define RADIX_SORT_MIN_SIZE 256
+#define RADIX_SORT_WIDE_SIZE ((size_t)1 << 18)
+#define RADIX_KEY_BITS (sizeof(unsigned int) * CHAR_BIT)
+#define RADIX_SIGN_BIT (1u << (RADIX_KEY_BITS - 1))
+
+static bool radix_sort(unsigned int* keys, size_t count) {
+    // 11 bit digits take fewer passes but need larger histograms
+    unsigned int digit_bits = count >= RADIX_SORT_WIDE_SIZE ? 11 : 8;
+    unsigned int passes = (RADIX_KEY_BITS + digit_bits - 1) / digit_bits;
+    size_t radix = (size_t)1 << digit_bits;
+    unsigned int mask = (unsigned int)radix - 1;
+
+    unsigned int* scratch = (unsigned int*)malloc(count * sizeof(unsigned int));
+    size_t* counts = (size_t*)calloc(passes * radix, sizeof(size_t));
+    if (scratch == NULL || counts == NULL) {
+        free(scratch);
+        free(counts);
+        return false;
+    }
+
+    // Bias the keys and build every histogram in one sweep
+    for (size_t i = 0; i < count; i++) {
+        unsigned int key = keys[i] ^ RADIX_SIGN_BIT;
+        keys[i] = key;
+        for (unsigned int pass = 0; pass < passes; pass++) {
+            counts[pass * radix + ((key >> (pass * digit_bits)) & mask)]++;
+        }
+    }
+
+    unsigned int* source = keys;
+    unsigned int* destination = scratch;
+
+    for (unsigned int pass = 0; pass < passes; pass++) {
+        size_t* bucket = &counts[pass * radix];
+        unsigned int shift = pass * digit_bits;
+
+        // Every key has the same digit, this pass would not move anything
+        if (bucket[(source[0] >> shift) & mask] == count) {
+            continue;
+        }
+
+        // Turn the histogram into starting offsets
+        size_t offset = 0;
+        for (size_t digit = 0; digit < radix; digit++) {
+            size_t bucket_size = bucket[digit];
+            bucket[digit] = offset;
+            offset += bucket_size;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            unsigned int key = source[i];
+            destination[bucket[(key >> shift) & mask]++] = key;
+        }
+
+        unsigned int* temp = source;
+        source = destination;
+        destination = temp;
+    }
+
+    if (source != keys) {
+        memcpy(keys, source, count * sizeof(unsigned int));
+    }
+
+    // Remove the bias
+    for (size_t i = 0; i < count; i++) {
+        keys[i] ^= RADIX_SIGN_BIT;
+    }
+
+    free(scratch);
+    free(counts);
+    return true;
+}
+
 void IntArray_sort(Array* arr) {
+    if (arr != NULL && arr->data_size == sizeof(int) &&
+        arr->size >= RADIX_SORT_MIN_SIZE &&
+        radix_sort((unsigned int*)arr->data, arr->size)) {
+        return;
+    }
+
     ReturnError result = Array_sort(arr, __compare__);
     if (result.error > 0) {
         /**
@@ -173,6 +340,52 @@ void IntArray_sort(Array* arr) {
     }
 }
 
+/*
+ * Branchless binary search. Each step halves the window with a conditional
+ * move instead of a branch, so the loop runs exactly log2(n) times whatever
+ * the data looks like.
+ */
+static size_t branchless_bound(const int* values, size_t count, int element,
+                               bool upper) {
+    if (count == 0) {
+        return 0;
+    }
+
+    const int* base = values;
+    while (count > 1) {
+        size_t half = count / 2;
+        bool right = upper ? base[half] <= element : base[half] < element;
+        base = right ? base + half : base;
+        count -= half;
+    }
+
+    bool after = upper ? *base <= element : *base < element;
+    return (size_t)(base - values) + after;
+}
+
+size_t IntArray_lower_bound(const Array* arr, int element) {
+    if (arr == NULL || arr->data_size != sizeof(int)) {
+        return SIZE_MAX;
+    }
+    return branchless_bound((const int*)arr->data, arr->size, element, false);
+}
+
+size_t IntArray_upper_bound(const Array* arr, int element) {
+    if (arr == NULL || arr->data_size != sizeof(int)) {
+        return SIZE_MAX;
+    }
+    return branchless_bound((const int*)arr->data, arr->size, element, true);
+}
+
+size_t IntArray_bsearch(const Array* arr, int element) {
+    size_t index = IntArray_lower_bound(arr, element);
+    if (arr != NULL && index < arr->size &&
+        ((const int*)arr->data)[index] == element) {
+        return index;
+    }
+    return SIZE_MAX;
+}
+
 static void __print__(T* element) { printf("%d ", *(int*)element->data); }
 
 void IntArray_print(Array* arr) { IntArray_iterate(arr, __print__); }
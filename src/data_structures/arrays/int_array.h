@@ -2,6 +2,7 @@
 #define INT_ARRAY_H
 
 #include "array.h"
+#include "array_unchecked.h"
 
 /**
  * @brief Creates a new Array for ints
@@ -129,6 +130,64 @@ void IntArray_clear(Array* arr);
  */
 void IntArray_iterate(const Array* arr, CallbackFunction callback);
 
+/**
+ * @brief Callback function applied to an int in place.
+ *
+ * @param element Pointer to the int inside the Array.
+ * @param context The pointer handed to the iterating function.
+ */
+typedef void (*IntCallbackFunction)(int* element, void* context);
+
+/**
+ * @brief Applies a callback function to every int in place on several
+ * threads, see Array_parallel_for_each.
+ *
+ * @param arr Pointer to the Array.
+ * @param callback Callback function to apply to each element.
+ * @param context Pointer handed to every call of callback.
+ * @param threads Maximum number of threads to use, including the caller, or
+ * 0 for every thread of the shared ThreadPool.
+ */
+void IntArray_parallel_for_each(Array* arr, IntCallbackFunction callback,
+                                void* context, size_t threads);
+
+/**
+ * @brief Callback function applied to a contiguous run of ints in place.
+ *
+ * @param elements Pointer to the first int of the run inside the Array.
+ * @param count Number of ints in the run.
+ * @param context The pointer handed to IntArray_apply.
+ */
+typedef void (*IntBlockFunction)(int* elements, size_t count, void* context);
+
+/**
+ * @brief Hands every int of the Array to a callback function in one
+ * contiguous block, see Array_iterate_blocks.
+ *
+ * @param arr Pointer to the Array.
+ * @param callback Callback function to apply to the block.
+ * @param context Pointer handed to callback.
+ */
+void IntArray_apply(Array* arr, IntBlockFunction callback, void* context);
+
+/**
+ * @brief Adds a value to every int of the Array in a vectorizable loop.
+ * Overflow wraps around.
+ *
+ * @param arr Pointer to the Array.
+ * @param value Value to add.
+ */
+void IntArray_apply_add(Array* arr, int value);
+
+/**
+ * @brief Multiplies every int of the Array by a factor in a vectorizable
+ * loop. Overflow wraps around.
+ *
+ * @param arr Pointer to the Array.
+ * @param factor Factor to multiply by.
+ */
+void IntArray_apply_scale(Array* arr, int factor);
+
 /**
  * @brief Swaps the elements at two indices in the Array.
  *
@@ -145,6 +204,77 @@ void IntArray_swap(Array* arr, size_t index_a, size_t index_b);
  */
 void IntArray_sort(Array* arr);
 
+/**
+ * @brief Finds the first element of a sorted Array that is not less than
+ * element, using a branchless binary search.
+ *
+ * @param arr Pointer to a sorted Array.
+ * @param element The element to be searched for.
+ * @return The index of that element, or the size of the Array if there is
+ * none. SIZE_MAX if arr is NULL.
+ */
+size_t IntArray_lower_bound(const Array* arr, int element);
+
+/**
+ * @brief Finds the first element of a sorted Array that is greater than
+ * element, using a branchless binary search.
+ *
+ * @param arr Pointer to a sorted Array.
+ * @param element The element to be searched for.
+ * @return The index of that element, or the size of the Array if there is
+ * none. SIZE_MAX if arr is NULL.
+ */
+size_t IntArray_upper_bound(const Array* arr, int element);
+
+/**
+ * @brief Binary searches a sorted Array for an element.
+ *
+ * @param arr Pointer to a sorted Array.
+ * @param element The element to be searched for.
+ * @return The index of the first occurrence of the element, or SIZE_MAX if not
+ * found.
+ */
+size_t IntArray_bsearch(const Array* arr, int element);
+
 void IntArray_print(Array* arr);
 
+/**
+ * @brief Returns the int at an index without any checks in release builds,
+ * see array_unchecked.h.
+ *
+ * @param arr Pointer to an Array of ints, must not be NULL.
+ * @param index Index of the element, must be below the size.
+ *
+ * @return The int at index.
+ */
+static inline int IntArray_get_unchecked(const Array* arr, size_t index) {
+    assert(arr != NULL && arr->data_size == sizeof(int));
+    return *(const int*)Array_at_unchecked(arr, index);
+}
+
+/**
+ * @brief Sets the int at an index without any checks in release builds.
+ *
+ * @param arr Pointer to an Array of ints, must not be NULL.
+ * @param index Index of the element, must be below the size.
+ * @param element The new value.
+ */
+static inline void IntArray_set_unchecked(Array* arr, size_t index,
+                                          int element) {
+    assert(arr != NULL && arr->data_size == sizeof(int));
+    *(int*)Array_at_unchecked(arr, index) = element;
+}
+
+/**
+ * @brief Appends an int without growing the Array or any checks in release
+ * builds.
+ *
+ * @param arr Pointer to an Array of ints with room for one more element.
+ * @param element The int to append.
+ */
+static inline void IntArray_push_unchecked(Array* arr, int element) {
+    assert(arr != NULL && arr->data_size == sizeof(int));
+    Array_push_unchecked(arr, &element);
+}
+
 #endif
\ No newline at end of file
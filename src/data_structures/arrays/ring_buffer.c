@@ -0,0 +1,477 @@
+#include "ring_buffer.h"
+
+// Address of the slot at a buffer position, not an index from the front
+static inline void* slot_at(const RingBuffer* ring, size_t slot) {
+    return (char*)ring->data + slot * ring->data_size;
+}
+
+// Buffer position of the element index places from the front
+static inline size_t slot_of(const RingBuffer* ring, size_t index) {
+    return (ring->head + index) & (ring->capacity - 1);
+}
+
+// Smallest power of two holding count, 0 if there is none
+static size_t round_up_capacity(size_t count) {
+    size_t capacity = 1;
+    while (capacity < count) {
+        if (capacity > SIZE_MAX / 2) {
+            return 0;
+        }
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// Copies count elements starting at buffer position slot out to dst, in at
+// most two spans since the range may wrap past the end of the buffer
+static void copy_out(const RingBuffer* ring, size_t slot, size_t count,
+                     void* dst) {
+    size_t first = ring->capacity - slot;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(dst, slot_at(ring, slot), first * ring->data_size);
+    memcpy((char*)dst + first * ring->data_size, ring->data,
+           (count - first) * ring->data_size);
+}
+
+// Copies count elements from src into the buffer starting at position slot
+static void copy_in(RingBuffer* ring, size_t slot, const void* src,
+                    size_t count) {
+    size_t first = ring->capacity - slot;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(slot_at(ring, slot), src, first * ring->data_size);
+    memcpy(ring->data, (const char*)src + first * ring->data_size,
+           (count - first) * ring->data_size);
+}
+
+// Moves the elements into a larger buffer, unwrapped so the front is at
+// position 0. The old buffer is handed back rather than freed, since the
+// caller may still be reading the elements being pushed out of it.
+static ReturnError grow(RingBuffer* ring, size_t required, void** old_data,
+                        size_t* old_bytes) {
+    ReturnError result = {.error = NO_ERROR};
+
+    size_t capacity = ring->capacity;
+    while (capacity < required) {
+        if (capacity > SIZE_MAX / 2 / ring->data_size) {
+            result.error = ERROR_ALLOCATION;
+            return result;
+        }
+        capacity <<= 1;
+    }
+
+    void* data = Allocator_alloc(&ring->allocator, capacity * ring->data_size);
+    if (data == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+    copy_out(ring, ring->head, ring->size, data);
+
+    *old_data = ring->data;
+    *old_bytes = ring->capacity * ring->data_size;
+    ring->data = data;
+    ring->capacity = capacity;
+    ring->head = 0;
+
+    return result;
+}
+
+ReturnRingBuffer RingBuffer_create(size_t data_size, size_t capacity) {
+    return RingBuffer_create_with_allocator(data_size, capacity, NULL);
+}
+
+ReturnRingBuffer RingBuffer_create_with_allocator(size_t data_size,
+                                                  size_t capacity,
+                                                  const Allocator* allocator) {
+    ReturnRingBuffer result = {.error = NO_ERROR, .ring = NULL};
+
+    // Check valid arguments
+    if (data_size == 0 || capacity == 0) {
+        result.error = ERROR;
+        return result;
+    }
+
+    // Guard against capacity * data_size overflowing
+    capacity = round_up_capacity(capacity);
+    if (capacity == 0 || capacity > SIZE_MAX / data_size) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    RingBuffer* ring =
+        (RingBuffer*)Allocator_alloc(allocator, sizeof(RingBuffer));
+    if (ring == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    // Keep a copy of the allocator, a zeroed one means the standard library
+    if (allocator != NULL) {
+        ring->allocator = *allocator;
+    } else {
+        memset(&ring->allocator, 0, sizeof(Allocator));
+    }
+
+    ring->size = 0;
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->data_size = data_size;
+
+    ring->data = Allocator_alloc(allocator, capacity * data_size);
+    if (ring->data == NULL) {
+        result.error = ERROR_ALLOCATION;
+        Allocator_free(allocator, ring, sizeof(RingBuffer));
+        return result;
+    }
+
+    result.ring = ring;
+    return result;
+}
+
+ReturnError RingBuffer_destroy(RingBuffer** ring) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL || *ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    // Copy the allocator out, it lives inside the block being freed
+    Allocator allocator = (*ring)->allocator;
+    Allocator_free(&allocator, (*ring)->data,
+                   (*ring)->capacity * (*ring)->data_size);
+    Allocator_free(&allocator, *ring, sizeof(RingBuffer));
+    *ring = NULL;
+
+    return result;
+}
+
+ReturnSizeT RingBuffer_size(const RingBuffer* ring) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = 0};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.value = ring->size;
+    return result;
+}
+
+ReturnSizeT RingBuffer_capacity(const RingBuffer* ring) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = 0};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.value = ring->capacity;
+    return result;
+}
+
+ReturnBool RingBuffer_is_empty(const RingBuffer* ring) {
+    ReturnBool result = {.error = NO_ERROR, .value = false};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.value = ring->size == 0;
+    return result;
+}
+
+ReturnError RingBuffer_reserve(RingBuffer* ring, size_t capacity) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (capacity <= ring->capacity) {
+        return result;
+    }
+
+    void* old_data;
+    size_t old_bytes;
+    result = grow(ring, capacity, &old_data, &old_bytes);
+    if (result.error == NO_ERROR) {
+        Allocator_free(&ring->allocator, old_data, old_bytes);
+    }
+    return result;
+}
+
+ReturnError RingBuffer_clear(RingBuffer* ring) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ring->size = 0;
+    ring->head = 0;
+    return result;
+}
+
+ReturnError RingBuffer_push_back(RingBuffer* ring, T* element) {
+    return RingBuffer_push_back_n(ring, element, 1);
+}
+
+ReturnError RingBuffer_push_front(RingBuffer* ring, T* element) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL || element == NULL || element->data == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (element->size != ring->data_size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    void* old_data = NULL;
+    size_t old_bytes = 0;
+    if (ring->size == ring->capacity) {
+        result = grow(ring, ring->size + 1, &old_data, &old_bytes);
+        if (result.error != NO_ERROR) {
+            return result;
+        }
+    }
+
+    // Step the head back one slot, wrapping to the end of the buffer
+    ring->head = (ring->head - 1) & (ring->capacity - 1);
+    memmove(slot_at(ring, ring->head), element->data, ring->data_size);
+    ring->size++;
+
+    Allocator_free(&ring->allocator, old_data, old_bytes);
+    return result;
+}
+
+ReturnError RingBuffer_push_back_n(RingBuffer* ring, T* elements,
+                                   size_t count) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL || elements == NULL ||
+        (elements->data == NULL && count > 0)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (elements->size != ring->data_size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    if (count == 0) {
+        return result;
+    }
+
+    if (count > SIZE_MAX - ring->size) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    void* old_data = NULL;
+    size_t old_bytes = 0;
+    if (ring->size + count > ring->capacity) {
+        result = grow(ring, ring->size + count, &old_data, &old_bytes);
+        if (result.error != NO_ERROR) {
+            return result;
+        }
+    }
+
+    if (count == 1) {
+        // memmove since element may be a view into this same RingBuffer
+        memmove(slot_at(ring, slot_of(ring, ring->size)), elements->data,
+                ring->data_size);
+    } else {
+        copy_in(ring, slot_of(ring, ring->size), elements->data, count);
+    }
+    ring->size += count;
+
+    Allocator_free(&ring->allocator, old_data, old_bytes);
+    return result;
+}
+
+// Checks out can receive elements, NULL is allowed and means drop them
+static bool valid_out(const RingBuffer* ring, const T* out) {
+    return out == NULL || (out->size == ring->data_size && out->data != NULL);
+}
+
+ReturnError RingBuffer_pop_front(RingBuffer* ring, T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (!valid_out(ring, out)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    if (ring->size == 0) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    if (out != NULL) {
+        memcpy(out->data, slot_at(ring, ring->head), ring->data_size);
+    }
+    ring->head = (ring->head + 1) & (ring->capacity - 1);
+    ring->size--;
+
+    return result;
+}
+
+ReturnError RingBuffer_pop_back(RingBuffer* ring, T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (!valid_out(ring, out)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    if (ring->size == 0) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    ring->size--;
+    if (out != NULL) {
+        memcpy(out->data, slot_at(ring, slot_of(ring, ring->size)),
+               ring->data_size);
+    }
+
+    return result;
+}
+
+ReturnSizeT RingBuffer_pop_front_n(RingBuffer* ring, T* out, size_t count) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = 0};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (!valid_out(ring, out)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    if (count > ring->size) {
+        count = ring->size;
+    }
+
+    if (out != NULL) {
+        copy_out(ring, ring->head, count, out->data);
+    }
+    ring->head = slot_of(ring, count);
+    ring->size -= count;
+
+    result.value = count;
+    return result;
+}
+
+ReturnView RingBuffer_get(const RingBuffer* ring, size_t index) {
+    ReturnView result = {.error = NO_ERROR, .value = {0, NULL}};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (index >= ring->size) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    result.value.size = ring->data_size;
+    result.value.data = slot_at(ring, slot_of(ring, index));
+
+    return result;
+}
+
+ReturnView RingBuffer_front(const RingBuffer* ring) {
+    return RingBuffer_get(ring, 0);
+}
+
+ReturnView RingBuffer_back(const RingBuffer* ring) {
+    ReturnView result = {.error = NO_ERROR, .value = {0, NULL}};
+
+    if (ring == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (ring->size == 0) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    return RingBuffer_get(ring, ring->size - 1);
+}
+
+ReturnError RingBuffer_set(RingBuffer* ring, size_t index, T* element) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL || element == NULL || element->data == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (index >= ring->size) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    if (element->size != ring->data_size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    // memmove since element may be a view into this same RingBuffer
+    memmove(slot_at(ring, slot_of(ring, index)), element->data,
+            ring->data_size);
+
+    return result;
+}
+
+ReturnError RingBuffer_iterate(RingBuffer* ring, CallbackFunction callback) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (ring == NULL || callback == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    // Walk the two spans directly instead of masking every index
+    T element = {ring->data_size, NULL};
+    size_t first = ring->capacity - ring->head;
+    if (first > ring->size) {
+        first = ring->size;
+    }
+    for (size_t i = 0; i < first; i++) {
+        element.data = slot_at(ring, ring->head + i);
+        callback(&element);
+    }
+    for (size_t i = 0; i < ring->size - first; i++) {
+        element.data = slot_at(ring, i);
+        callback(&element);
+    }
+
+    return result;
+}
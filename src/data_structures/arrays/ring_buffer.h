@@ -0,0 +1,231 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "array.h"
+
+/**
+ * @brief Double ended queue of fixed size elements in one contiguous buffer.
+ *
+ * Elements are stored like in an Array, but the buffer wraps around: the
+ * capacity is a power of two and positions are masked into it, so pushing
+ * and popping at either end is O(1) and never shifts other elements. The
+ * elements therefore occupy at most two contiguous spans of the buffer,
+ * which bulk operations copy with one memcpy each.
+ */
+typedef struct RingBuffer {
+    size_t size;          ///< Current number of elements
+    size_t capacity;      ///< Number of slots, a power of two
+    size_t head;          ///< Slot of the front element
+    size_t data_size;     ///< Size of each element in bytes
+    void* data;           ///< Buffer of capacity * data_size bytes
+    Allocator allocator;  ///< Where the RingBuffer and its buffer come from
+} RingBuffer;
+
+typedef struct ReturnRingBufferType {
+    ErrorCode error;
+    RingBuffer* ring;
+} ReturnRingBuffer;
+
+/**
+ * @brief Creates a new, empty RingBuffer.
+ *
+ * @param data_size Size of each element in bytes.
+ * @param capacity Initial capacity, rounded up to a power of two.
+ *
+ * @return ReturnRingBuffer will either return an ErrorCode or a RingBuffer*
+ */
+ReturnRingBuffer RingBuffer_create(size_t data_size, size_t capacity);
+
+/**
+ * @brief Creates a new, empty RingBuffer whose memory comes from a custom
+ * allocator.
+ *
+ * @param data_size Size of each element in bytes.
+ * @param capacity Initial capacity, rounded up to a power of two.
+ * @param allocator Allocator for the RingBuffer and its buffer. It is copied
+ * into the RingBuffer; NULL uses the standard library.
+ *
+ * @return ReturnRingBuffer will either return an ErrorCode or a RingBuffer*
+ */
+ReturnRingBuffer RingBuffer_create_with_allocator(size_t data_size,
+                                                  size_t capacity,
+                                                  const Allocator* allocator);
+
+/**
+ * @brief Destroys a RingBuffer and frees associated memory.
+ *
+ * @param ring Pointer to the RingBuffer to be destroyed.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_destroy(RingBuffer** ring);
+
+/**
+ * @brief Returns the number of elements in the RingBuffer.
+ *
+ * @param ring Pointer to the RingBuffer.
+ *
+ * @return ReturnSizeT will either return an ErrorCode or a size_t
+ */
+ReturnSizeT RingBuffer_size(const RingBuffer* ring);
+
+/**
+ * @brief Returns the capacity of the RingBuffer.
+ *
+ * @param ring Pointer to the RingBuffer.
+ *
+ * @return ReturnSizeT will either return an ErrorCode or a size_t
+ */
+ReturnSizeT RingBuffer_capacity(const RingBuffer* ring);
+
+/**
+ * @brief Checks if the RingBuffer is empty.
+ *
+ * @param ring Pointer to the RingBuffer.
+ *
+ * @return ReturnBool will either return an ErrorCode or a bool
+ */
+ReturnBool RingBuffer_is_empty(const RingBuffer* ring);
+
+/**
+ * @brief Grows the buffer so that capacity elements fit without growing
+ * again.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param capacity Number of elements to make room for, rounded up to a power
+ * of two.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_reserve(RingBuffer* ring, size_t capacity);
+
+/**
+ * @brief Removes every element, keeping the buffer for reuse.
+ *
+ * @param ring Pointer to the RingBuffer.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_clear(RingBuffer* ring);
+
+/**
+ * @brief Adds an element after the back of the RingBuffer.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param element Pointer to the element, its size must be data_size.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_push_back(RingBuffer* ring, T* element);
+
+/**
+ * @brief Adds an element before the front of the RingBuffer.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param element Pointer to the element, its size must be data_size.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_push_front(RingBuffer* ring, T* element);
+
+/**
+ * @brief Removes the front element.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param out GenericDataType of data_size bytes the element is copied to, may
+ * be NULL.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_INDEX if the RingBuffer is empty.
+ */
+ReturnError RingBuffer_pop_front(RingBuffer* ring, T* out);
+
+/**
+ * @brief Removes the back element.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param out GenericDataType of data_size bytes the element is copied to, may
+ * be NULL.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_INDEX if the RingBuffer is empty.
+ */
+ReturnError RingBuffer_pop_back(RingBuffer* ring, T* out);
+
+/**
+ * @brief Adds several elements after the back of the RingBuffer, in order.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param elements GenericDataType whose size is the RingBuffer's data_size
+ * and whose data points to count contiguous elements.
+ * @param count Number of elements to add.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_push_back_n(RingBuffer* ring, T* elements,
+                                   size_t count);
+
+/**
+ * @brief Removes up to count elements from the front of the RingBuffer.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param out GenericDataType whose size is the RingBuffer's data_size and
+ * whose data has room for count elements, which are copied there in order.
+ * May be NULL to drop the elements.
+ * @param count Largest number of elements to remove.
+ *
+ * @return ReturnSizeT with the number of elements removed.
+ */
+ReturnSizeT RingBuffer_pop_front_n(RingBuffer* ring, T* out, size_t count);
+
+/**
+ * @brief Gets the element at an index, counting from the front.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param index Index of the element.
+ *
+ * @return ReturnView with a view of the element inside the RingBuffer. The
+ * view is valid until the next call that changes the RingBuffer.
+ */
+ReturnView RingBuffer_get(const RingBuffer* ring, size_t index);
+
+/**
+ * @brief Gets the front element.
+ *
+ * @param ring Pointer to the RingBuffer.
+ *
+ * @return ReturnView with a view of the element, ERROR_INDEX if empty.
+ */
+ReturnView RingBuffer_front(const RingBuffer* ring);
+
+/**
+ * @brief Gets the back element.
+ *
+ * @param ring Pointer to the RingBuffer.
+ *
+ * @return ReturnView with a view of the element, ERROR_INDEX if empty.
+ */
+ReturnView RingBuffer_back(const RingBuffer* ring);
+
+/**
+ * @brief Sets the element at an index, counting from the front.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param index Index of the element.
+ * @param element Pointer to the new element, its size must be data_size.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_set(RingBuffer* ring, size_t index, T* element);
+
+/**
+ * @brief Calls callback on every element from the front to the back.
+ *
+ * @param ring Pointer to the RingBuffer.
+ * @param callback Function called with a view of each element.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError RingBuffer_iterate(RingBuffer* ring, CallbackFunction callback);
+
+#endif
@@ -0,0 +1,339 @@
+#ifndef TYPED_VECTOR_H
+#define TYPED_VECTOR_H
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "array.h"
+
+/*
+ * Typed vectors generated by macro.
+ *
+ * DEFINE_VECTOR(name, type) defines a vector type called name that holds
+ * elements of type. A name* is an Array of sizeof(type) bytes per element
+ * under a distinct pointer type, so it keeps the Array's allocator and growth
+ * policy and name_array hands it to any Array function. Every function is
+ * static inline and reads and writes elements as type directly, so the
+ * element size is a compile time constant and no T is built per call.
+ *
+ *     name_create(capacity)       Return##name, capacity must not be 0
+ *     name_destroy(&vec)          ReturnError
+ *     name_array(vec)             Array* sharing the storage
+ *     name_size(vec)              size_t
+ *     name_capacity(vec)          size_t
+ *     name_data(vec)              type* to element 0
+ *     name_at(vec, index)         type* to an element
+ *     name_get(vec, index)        type
+ *     name_set(vec, index, elem)  void
+ *     name_push(vec, elem)        ReturnError, grows when full
+ *     name_pop(vec)               type, the removed last element
+ *     name_reserve(vec, capacity) ReturnError
+ *     name_clear(vec)             void, keeps the buffer
+ *
+ * DEFINE_VECTOR_ORDER(name, type, compare) adds searching and sorting to a
+ * vector defined before. compare is a function or macro taking two
+ * const type* and returning an int like a CompareFunction. It is called by
+ * name, so it is inlined into the loops.
+ *
+ *     name_sort(vec)                 void, introsort, not stable
+ *     name_find(vec, elem)           size_t, first equal index or SIZE_MAX
+ *     name_lower_bound(vec, elem)    size_t
+ *     name_upper_bound(vec, elem)    size_t
+ *     name_bsearch(vec, elem)        size_t, first equal index or SIZE_MAX
+ *
+ * Preconditions on indices and sizes are asserted like in array_unchecked.h
+ * and compile out under NDEBUG.
+ *
+ * The Vector_ macros at the end pick the function of the right vector type
+ * with _Generic. They dispatch over VECTOR_TYPES(op), or
+ * VECTOR_ORDERED_TYPES(op) for the searching and sorting macros. Both must be
+ * defined by the user before a Vector_ macro is used, as a comma separated
+ * list of VECTOR_ENTRY(name, op), e.g.
+ *
+ *     #define VECTOR_TYPES(op) \
+ *         VECTOR_ENTRY(IntVector, op), VECTOR_ENTRY(PersonVector, op)
+ */
+
+// Vector types below this many elements are sorted by insertion sort
+#define VECTOR_INSERTION_SORT_THRESHOLD 16
+
+#define DEFINE_VECTOR(name, type)                                            \
+    typedef struct name name;                                                \
+                                                                             \
+    typedef struct Return##name##Type {                                      \
+        ErrorCode error;                                                     \
+        name* vec;                                                           \
+    } Return##name;                                                          \
+                                                                             \
+    static inline Array* name##_array(name* vec) { return (Array*)vec; }     \
+                                                                             \
+    static inline Return##name name##_create(size_t capacity) {              \
+        ReturnArray created = Array_create(sizeof(type), capacity);          \
+        Return##name result = {.error = created.error,                       \
+                               .vec = (name*)created.arr};                   \
+        return result;                                                       \
+    }                                                                        \
+                                                                             \
+    static inline ReturnError name##_destroy(name** vec) {                   \
+        ReturnError result = {.error = ERROR_NULL};                          \
+        if (vec == NULL) {                                                   \
+            return result;                                                   \
+        }                                                                    \
+        Array* arr = (Array*)*vec;                                           \
+        result = Array_destroy(&arr);                                        \
+        *vec = (name*)arr;                                                   \
+        return result;                                                       \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_size(const name* vec) {                      \
+        assert(vec != NULL);                                                 \
+        return ((const Array*)vec)->size;                                    \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_capacity(const name* vec) {                  \
+        assert(vec != NULL);                                                 \
+        return ((const Array*)vec)->capacity;                                \
+    }                                                                        \
+                                                                             \
+    static inline type* name##_data(const name* vec) {                       \
+        assert(vec != NULL);                                                 \
+        return (type*)((const Array*)vec)->data;                             \
+    }                                                                        \
+                                                                             \
+    static inline type* name##_at(const name* vec, size_t index) {           \
+        assert(index < name##_size(vec));                                    \
+        return name##_data(vec) + index;                                     \
+    }                                                                        \
+                                                                             \
+    static inline type name##_get(const name* vec, size_t index) {           \
+        return *name##_at(vec, index);                                       \
+    }                                                                        \
+                                                                             \
+    static inline void name##_set(name* vec, size_t index, type element) {   \
+        *name##_at(vec, index) = element;                                    \
+    }                                                                        \
+                                                                             \
+    static inline ReturnError name##_push(name* vec, type element) {         \
+        assert(vec != NULL);                                                 \
+        Array* arr = (Array*)vec;                                            \
+        if (arr->size < arr->capacity) {                                     \
+            ((type*)arr->data)[arr->size++] = element;                       \
+            ReturnError result = {.error = NO_ERROR};                        \
+            return result;                                                   \
+        }                                                                    \
+        /* Full, let the Array grow along its growth policy */               \
+        T boxed = {sizeof(type), &element};                                  \
+        return Array_append(arr, &boxed);                                    \
+    }                                                                        \
+                                                                             \
+    static inline type name##_pop(name* vec) {                               \
+        assert(name##_size(vec) > 0);                                        \
+        Array* arr = (Array*)vec;                                            \
+        return ((type*)arr->data)[--arr->size];                              \
+    }                                                                        \
+                                                                             \
+    static inline ReturnError name##_reserve(name* vec, size_t capacity) {   \
+        return Array_reserve((Array*)vec, capacity);                         \
+    }                                                                        \
+                                                                             \
+    static inline void name##_clear(name* vec) {                             \
+        assert(vec != NULL);                                                 \
+        ((Array*)vec)->size = 0;                                             \
+    }
+
+#define DEFINE_VECTOR_ORDER(name, type, compare)                             \
+    static inline void name##_insertion_sort(type* data, size_t count) {     \
+        for (size_t i = 1; i < count; i++) {                                 \
+            type moving = data[i];                                           \
+            size_t j = i;                                                    \
+            while (j > 0 && compare(&moving, &data[j - 1]) < 0) {            \
+                data[j] = data[j - 1];                                       \
+                j--;                                                         \
+            }                                                                \
+            data[j] = moving;                                                \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    static inline void name##_sift_down(type* data, size_t root,             \
+                                        size_t count) {                      \
+        type moving = data[root];                                            \
+        size_t child;                                                        \
+        while ((child = 2 * root + 1) < count) {                             \
+            if (child + 1 < count &&                                         \
+                compare(&data[child], &data[child + 1]) < 0) {               \
+                child++;                                                     \
+            }                                                                \
+            if (compare(&moving, &data[child]) >= 0) {                       \
+                break;                                                       \
+            }                                                                \
+            data[root] = data[child];                                        \
+            root = child;                                                    \
+        }                                                                    \
+        data[root] = moving;                                                 \
+    }                                                                        \
+                                                                             \
+    static inline void name##_heap_sort(type* data, size_t count) {          \
+        for (size_t i = count / 2; i > 0; i--) {                             \
+            name##_sift_down(data, i - 1, count);                            \
+        }                                                                    \
+        for (size_t end = count - 1; end > 0; end--) {                       \
+            type top = data[0];                                              \
+            data[0] = data[end];                                             \
+            data[end] = top;                                                 \
+            name##_sift_down(data, 0, end);                                  \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    static inline void name##_swap(type* a, type* b) {                       \
+        type temp = *a;                                                      \
+        *a = *b;                                                             \
+        *b = temp;                                                           \
+    }                                                                        \
+                                                                             \
+    static void name##_introsort(type* data, size_t count, size_t depth) {   \
+        while (count > VECTOR_INSERTION_SORT_THRESHOLD) {                    \
+            /* Too many bad pivots, finish with a guaranteed n log n */      \
+            if (depth == 0) {                                                \
+                name##_heap_sort(data, count);                               \
+                return;                                                      \
+            }                                                                \
+            depth--;                                                         \
+                                                                             \
+            /* Order first, middle and last, then park the median first */   \
+            type* first = &data[0];                                          \
+            type* middle = &data[count / 2];                                 \
+            type* last = &data[count - 1];                                   \
+            if (compare(middle, first) < 0) {                                \
+                name##_swap(middle, first);                                  \
+            }                                                                \
+            if (compare(last, middle) < 0) {                                 \
+                name##_swap(last, middle);                                   \
+                if (compare(middle, first) < 0) {                            \
+                    name##_swap(middle, first);                              \
+                }                                                            \
+            }                                                                \
+            name##_swap(first, middle);                                      \
+                                                                             \
+            /* Hoare partition, the ends act as sentinels */                 \
+            type pivot = data[0];                                            \
+            size_t i = 0;                                                    \
+            size_t j = count;                                                \
+            for (;;) {                                                       \
+                while (compare(&data[++i], &pivot) < 0) {                    \
+                }                                                            \
+                while (compare(&pivot, &data[--j]) < 0) {                    \
+                }                                                            \
+                if (i >= j) {                                                \
+                    break;                                                   \
+                }                                                            \
+                name##_swap(&data[i], &data[j]);                             \
+            }                                                                \
+            name##_swap(&data[0], &data[j]);                                 \
+                                                                             \
+            /* Recurse into the smaller side, loop on the larger one */      \
+            size_t left = j;                                                 \
+            size_t right = count - j - 1;                                    \
+            if (left < right) {                                              \
+                name##_introsort(data, left, depth);                         \
+                data += j + 1;                                               \
+                count = right;                                               \
+            } else {                                                         \
+                name##_introsort(data + j + 1, right, depth);                \
+                count = left;                                                \
+            }                                                                \
+        }                                                                    \
+        name##_insertion_sort(data, count);                                  \
+    }                                                                        \
+                                                                             \
+    static inline void name##_sort(name* vec) {                              \
+        size_t count = name##_size(vec);                                     \
+        size_t depth = 0;                                                    \
+        for (size_t n = count; n > 1; n /= 2) {                              \
+            depth += 2;                                                      \
+        }                                                                    \
+        name##_introsort(name##_data(vec), count, depth);                    \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_find(const name* vec, type element) {        \
+        const type* data = name##_data(vec);                                 \
+        size_t count = name##_size(vec);                                     \
+        for (size_t i = 0; i < count; i++) {                                 \
+            if (compare(&data[i], &element) == 0) {                          \
+                return i;                                                    \
+            }                                                                \
+        }                                                                    \
+        return SIZE_MAX;                                                     \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_lower_bound(const name* vec, type element) { \
+        const type* data = name##_data(vec);                                 \
+        size_t low = 0;                                                      \
+        size_t count = name##_size(vec);                                     \
+        while (count > 0) {                                                  \
+            size_t half = count / 2;                                         \
+            if (compare(&data[low + half], &element) < 0) {                  \
+                low += half + 1;                                             \
+                count -= half + 1;                                           \
+            } else {                                                         \
+                count = half;                                                \
+            }                                                                \
+        }                                                                    \
+        return low;                                                          \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_upper_bound(const name* vec, type element) { \
+        const type* data = name##_data(vec);                                 \
+        size_t low = 0;                                                      \
+        size_t count = name##_size(vec);                                     \
+        while (count > 0) {                                                  \
+            size_t half = count / 2;                                         \
+            if (compare(&element, &data[low + half]) >= 0) {                 \
+                low += half + 1;                                             \
+                count -= half + 1;                                           \
+            } else {                                                         \
+                count = half;                                                \
+            }                                                                \
+        }                                                                    \
+        return low;                                                          \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_bsearch(const name* vec, type element) {     \
+        size_t index = name##_lower_bound(vec, element);                     \
+        if (index < name##_size(vec) &&                                      \
+            compare(name##_at(vec, index), &element) == 0) {                 \
+            return index;                                                    \
+        }                                                                    \
+        return SIZE_MAX;                                                     \
+    }
+
+// One _Generic association per pointer type of a vector, for VECTOR_TYPES
+#define VECTOR_ENTRY(name, op) \
+    name* : name##_##op, const name* : name##_##op
+
+#define Vector_size(vec) _Generic((vec), VECTOR_TYPES(size))(vec)
+#define Vector_capacity(vec) _Generic((vec), VECTOR_TYPES(capacity))(vec)
+#define Vector_data(vec) _Generic((vec), VECTOR_TYPES(data))(vec)
+#define Vector_at(vec, index) \
+    _Generic((vec), VECTOR_TYPES(at))((vec), (index))
+#define Vector_get(vec, index) \
+    _Generic((vec), VECTOR_TYPES(get))((vec), (index))
+#define Vector_set(vec, index, element) \
+    _Generic((vec), VECTOR_TYPES(set))((vec), (index), (element))
+#define Vector_push(vec, element) \
+    _Generic((vec), VECTOR_TYPES(push))((vec), (element))
+#define Vector_pop(vec) _Generic((vec), VECTOR_TYPES(pop))(vec)
+#define Vector_reserve(vec, capacity) \
+    _Generic((vec), VECTOR_TYPES(reserve))((vec), (capacity))
+#define Vector_clear(vec) _Generic((vec), VECTOR_TYPES(clear))(vec)
+
+#define Vector_sort(vec) _Generic((vec), VECTOR_ORDERED_TYPES(sort))(vec)
+#define Vector_find(vec, element) \
+    _Generic((vec), VECTOR_ORDERED_TYPES(find))((vec), (element))
+#define Vector_lower_bound(vec, element) \
+    _Generic((vec), VECTOR_ORDERED_TYPES(lower_bound))((vec), (element))
+#define Vector_upper_bound(vec, element) \
+    _Generic((vec), VECTOR_ORDERED_TYPES(upper_bound))((vec), (element))
+#define Vector_bsearch(vec, element) \
+    _Generic((vec), VECTOR_ORDERED_TYPES(bsearch))((vec), (element))
+
+#endif
@@ -0,0 +1,313 @@
+// pthread_rwlock_t is POSIX, not part of C11
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent_dictionary.h"
+
+#include <pthread.h>
+
+// Shards are padded to their own cache lines so locking one never slows
+// down threads working on its neighbours
+#define SHARD_ALIGNMENT 64
+
+typedef struct ConcurrentDictionaryShard {
+    _Alignas(SHARD_ALIGNMENT) pthread_rwlock_t lock;
+    Dictionary* dict;
+    void* scratch;  ///< value_size zeroed bytes for compute, write locked
+} ConcurrentDictionaryShard;
+
+static bool valid_key(const T* key) {
+    return key != NULL && (key->data != NULL || key->size == 0);
+}
+
+// Top bits of the hash pick the shard, the Dictionary inside uses the low
+// bits, so the two choices stay independent
+static ConcurrentDictionaryShard* shard_for(const ConcurrentDictionary* dict,
+                                            const T* key) {
+    if (dict->shard_bits == 0) {
+        return dict->shards;
+    }
+    uint64_t hash = dict->hash(key->data, key->size, dict->seed);
+    return &dict->shards[hash >> (64 - dict->shard_bits)];
+}
+
+static void destroy_shards(ConcurrentDictionary* dict, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        pthread_rwlock_destroy(&dict->shards[i].lock);
+        Dictionary_destroy(&dict->shards[i].dict);
+        free(dict->shards[i].scratch);
+    }
+    free(dict->shards);
+}
+
+ReturnConcurrentDictionary ConcurrentDictionary_create(size_t key_size,
+                                                       size_t value_size,
+                                                       size_t shards) {
+    return ConcurrentDictionary_create_with_hash(key_size, value_size, shards,
+                                                 NULL, 0);
+}
+
+ReturnConcurrentDictionary ConcurrentDictionary_create_with_hash(
+    size_t key_size, size_t value_size, size_t shards, HashFunction hash,
+    uint64_t seed) {
+    ReturnConcurrentDictionary result = {.error = NO_ERROR, .dict = NULL};
+
+    // The shard count must be a power of two
+    if (shards == 0 || (shards & (shards - 1)) != 0 ||
+        shards > SIZE_MAX / sizeof(ConcurrentDictionaryShard)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    ConcurrentDictionary* dict =
+        (ConcurrentDictionary*)malloc(sizeof(ConcurrentDictionary));
+    if (dict == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    dict->shard_count = shards;
+    dict->shard_bits = 0;
+    while (((size_t)1 << dict->shard_bits) < shards) {
+        dict->shard_bits++;
+    }
+    dict->key_size = key_size;
+    dict->value_size = value_size;
+    dict->hash = hash != NULL ? hash : Dictionary_hash_bytes;
+    dict->seed = seed;
+    dict->shards = (ConcurrentDictionaryShard*)aligned_alloc(
+        SHARD_ALIGNMENT, shards * sizeof(ConcurrentDictionaryShard));
+    if (dict->shards == NULL) {
+        free(dict);
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    for (size_t i = 0; i < shards; i++) {
+        ConcurrentDictionaryShard* shard = &dict->shards[i];
+        ReturnDictionary created =
+            Dictionary_create_with_hash(key_size, value_size, hash, seed);
+        shard->dict = created.dict;
+        shard->scratch = calloc(1, value_size > 0 ? value_size : 1);
+
+        if (created.error != NO_ERROR || shard->scratch == NULL ||
+            pthread_rwlock_init(&shard->lock, NULL) != 0) {
+            Dictionary_destroy(&shard->dict);
+            free(shard->scratch);
+            destroy_shards(dict, i);
+            free(dict);
+            result.error = created.error != NO_ERROR ? created.error
+                                                     : ERROR_ALLOCATION;
+            return result;
+        }
+    }
+
+    result.dict = dict;
+    return result;
+}
+
+ReturnError ConcurrentDictionary_destroy(ConcurrentDictionary** dict) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || *dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    destroy_shards(*dict, (*dict)->shard_count);
+    free(*dict);
+    *dict = NULL;
+
+    return result;
+}
+
+size_t ConcurrentDictionary_size(ConcurrentDictionary* dict) {
+    if (dict == NULL) {
+        return SIZE_MAX;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < dict->shard_count; i++) {
+        pthread_rwlock_rdlock(&dict->shards[i].lock);
+        size += Dictionary_size(dict->shards[i].dict);
+        pthread_rwlock_unlock(&dict->shards[i].lock);
+    }
+    return size;
+}
+
+ReturnError ConcurrentDictionary_reserve(ConcurrentDictionary* dict,
+                                         size_t count) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    // Leave some slack for keys spreading unevenly
+    size_t per_shard = count / dict->shard_count;
+    per_shard += per_shard / 8 + 1;
+
+    for (size_t i = 0; i < dict->shard_count; i++) {
+        pthread_rwlock_wrlock(&dict->shards[i].lock);
+        result = Dictionary_reserve(dict->shards[i].dict, per_shard);
+        pthread_rwlock_unlock(&dict->shards[i].lock);
+        if (result.error != NO_ERROR) {
+            break;
+        }
+    }
+    return result;
+}
+
+ReturnError ConcurrentDictionary_insert(ConcurrentDictionary* dict,
+                                        const T* key, const T* value) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || !valid_key(key)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ConcurrentDictionaryShard* shard = shard_for(dict, key);
+    pthread_rwlock_wrlock(&shard->lock);
+    result = Dictionary_insert(shard->dict, key, value);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+ReturnError ConcurrentDictionary_get(ConcurrentDictionary* dict, const T* key,
+                                     T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || !valid_key(key)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ConcurrentDictionaryShard* shard = shard_for(dict, key);
+    pthread_rwlock_rdlock(&shard->lock);
+    result = Dictionary_get_copy(shard->dict, key, out);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+ReturnBool ConcurrentDictionary_contains(ConcurrentDictionary* dict,
+                                         const T* key) {
+    ReturnBool result = {.error = NO_ERROR, .value = false};
+
+    if (dict == NULL || !valid_key(key)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ConcurrentDictionaryShard* shard = shard_for(dict, key);
+    pthread_rwlock_rdlock(&shard->lock);
+    result = Dictionary_contains(shard->dict, key);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+ReturnError ConcurrentDictionary_remove(ConcurrentDictionary* dict,
+                                        const T* key) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || !valid_key(key)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ConcurrentDictionaryShard* shard = shard_for(dict, key);
+    pthread_rwlock_wrlock(&shard->lock);
+    result = Dictionary_remove(shard->dict, key);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+ReturnBool ConcurrentDictionary_get_or_insert(ConcurrentDictionary* dict,
+                                              const T* key, const T* value,
+                                              T* out) {
+    ReturnBool result = {.error = NO_ERROR, .value = false};
+
+    if (dict == NULL || !valid_key(key) || value == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ConcurrentDictionaryShard* shard = shard_for(dict, key);
+
+    // Most calls find the key, so try under the shared lock first
+    if (out != NULL) {
+        pthread_rwlock_rdlock(&shard->lock);
+        ReturnError found = Dictionary_get_copy(shard->dict, key, out);
+        pthread_rwlock_unlock(&shard->lock);
+        if (found.error != ERROR_NOT_FOUND) {
+            result.error = found.error;
+            return result;
+        }
+    }
+
+    // Another thread may have inserted the key in between, look again
+    pthread_rwlock_wrlock(&shard->lock);
+    ReturnView stored = Dictionary_get(shard->dict, key);
+    if (stored.error == ERROR_NOT_FOUND) {
+        ReturnError inserted = Dictionary_insert(shard->dict, key, value);
+        result.error = inserted.error;
+        result.value = inserted.error == NO_ERROR;
+        if (result.value) {
+            stored = Dictionary_get(shard->dict, key);
+        }
+    } else {
+        result.error = stored.error;
+    }
+
+    if (result.error == NO_ERROR && out != NULL) {
+        if (out->size != dict->value_size ||
+            (out->data == NULL && dict->value_size > 0)) {
+            result.error = ERROR;
+        } else if (dict->value_size > 0) {
+            memcpy(out->data, stored.value.data, dict->value_size);
+        }
+    }
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+ReturnBool ConcurrentDictionary_compute(ConcurrentDictionary* dict,
+                                        const T* key, ComputeFunction compute,
+                                        void* context) {
+    ReturnBool result = {.error = NO_ERROR, .value = false};
+
+    if (dict == NULL || !valid_key(key) || compute == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    ConcurrentDictionaryShard* shard = shard_for(dict, key);
+    pthread_rwlock_wrlock(&shard->lock);
+
+    ReturnView stored = Dictionary_get(shard->dict, key);
+    if (stored.error == NO_ERROR) {
+        // Update the value in place, nothing else can touch it while locked
+        result.value = compute(key, &stored.value, true, context);
+        if (!result.value) {
+            result.error = Dictionary_remove(shard->dict, key).error;
+        }
+    } else if (stored.error == ERROR_NOT_FOUND) {
+        T value = {dict->value_size, shard->scratch};
+        result.value = compute(key, &value, false, context);
+        if (result.value) {
+            result.error = Dictionary_insert(shard->dict, key, &value).error;
+            result.value = result.error == NO_ERROR;
+        }
+        memset(shard->scratch, 0, dict->value_size);
+    } else {
+        result.error = stored.error;
+    }
+
+    pthread_rwlock_unlock(&shard->lock);
+    return result;
+}
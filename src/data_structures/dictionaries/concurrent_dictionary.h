@@ -0,0 +1,197 @@
+#ifndef CONCURRENT_DICTIONARY_H
+#define CONCURRENT_DICTIONARY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dictionary.h"
+
+/**
+ * @brief Dictionary that many threads can use at once.
+ *
+ * Keys are spread over a power of two number of shards by the top bits of
+ * their hash. Each shard is a Dictionary behind its own reader-writer lock,
+ * so lookups of a shard run in parallel, writers only block their own shard,
+ * and a shard that grows rehashes without stalling the others. Values are
+ * copied out rather than handed out as views, since a view could be changed
+ * by another thread as soon as the lock is released.
+ */
+typedef struct ConcurrentDictionary {
+    size_t shard_count;    ///< Number of shards, a power of two
+    unsigned shard_bits;   ///< log2 of shard_count
+    size_t key_size;       ///< Size of each key in bytes, 0 for byte strings
+    size_t value_size;     ///< Size of each value in bytes
+    HashFunction hash;     ///< Hash function used to pick a shard
+    uint64_t seed;         ///< Seed handed to the hash function
+    struct ConcurrentDictionaryShard* shards;  ///< shard_count shards
+} ConcurrentDictionary;
+
+typedef struct ReturnConcurrentDictionaryType {
+    ErrorCode error;
+    ConcurrentDictionary* dict;
+} ReturnConcurrentDictionary;
+
+/**
+ * @brief Updates the entry for one key while its shard is locked.
+ *
+ * @param key The key being updated.
+ * @param value value_size bytes holding the current value, or zeroes if the
+ * key is not present. The function may change them.
+ * @param present Whether the key is present.
+ * @param context Pointer passed through from ConcurrentDictionary_compute.
+ *
+ * @return true to store value for the key, false to remove the key.
+ */
+typedef bool (*ComputeFunction)(const T* key, T* value, bool present,
+                                void* context);
+
+/**
+ * @brief Creates a new ConcurrentDictionary.
+ *
+ * @param key_size Size of each key in bytes, or 0 for byte string keys.
+ * @param value_size Size of each value in bytes.
+ * @param shards Number of shards, a power of two. Around four times the
+ * number of threads keeps contention low.
+ *
+ * @return ReturnConcurrentDictionary will either return an ErrorCode or a
+ * ConcurrentDictionary*
+ */
+ReturnConcurrentDictionary ConcurrentDictionary_create(size_t key_size,
+                                                       size_t value_size,
+                                                       size_t shards);
+
+/**
+ * @brief Creates a new ConcurrentDictionary with a custom hash function.
+ *
+ * @param key_size Size of each key in bytes, or 0 for byte string keys.
+ * @param value_size Size of each value in bytes.
+ * @param shards Number of shards, a power of two.
+ * @param hash Hash function for the keys, NULL uses Dictionary_hash_bytes.
+ * @param seed Seed handed to every call of the hash function.
+ *
+ * @return ReturnConcurrentDictionary will either return an ErrorCode or a
+ * ConcurrentDictionary*
+ */
+ReturnConcurrentDictionary ConcurrentDictionary_create_with_hash(
+    size_t key_size, size_t value_size, size_t shards, HashFunction hash,
+    uint64_t seed);
+
+/**
+ * @brief Destroys a ConcurrentDictionary and frees associated memory. No
+ * other thread may be using it.
+ *
+ * @param dict Pointer to the ConcurrentDictionary to be destroyed.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError ConcurrentDictionary_destroy(ConcurrentDictionary** dict);
+
+/**
+ * @brief Returns the number of entries. Shards are counted one after the
+ * other, so concurrent updates may or may not be included.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ *
+ * @return size_t number of entries, SIZE_MAX if dict is NULL
+ */
+size_t ConcurrentDictionary_size(ConcurrentDictionary* dict);
+
+/**
+ * @brief Grows every shard so that count entries spread evenly over them fit
+ * without rehashing.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ * @param count Number of entries to make room for.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError ConcurrentDictionary_reserve(ConcurrentDictionary* dict,
+                                         size_t count);
+
+/**
+ * @brief Inserts a key with its value, replacing the value if the key is
+ * already present.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ * @param key Key to insert.
+ * @param value Value to store, its size must be value_size.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError ConcurrentDictionary_insert(ConcurrentDictionary* dict,
+                                        const T* key, const T* value);
+
+/**
+ * @brief Copies the value stored for a key.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ * @param key Key to look up.
+ * @param out GenericDataType of value_size bytes the value is copied to.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_NOT_FOUND if the key is not present.
+ */
+ReturnError ConcurrentDictionary_get(ConcurrentDictionary* dict, const T* key,
+                                     T* out);
+
+/**
+ * @brief Checks whether a key is present.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ * @param key Key to look up.
+ *
+ * @return ReturnBool will either return an ErrorCode or a bool
+ */
+ReturnBool ConcurrentDictionary_contains(ConcurrentDictionary* dict,
+                                         const T* key);
+
+/**
+ * @brief Removes a key and its value.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ * @param key Key to remove.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_NOT_FOUND if the key was not present.
+ */
+ReturnError ConcurrentDictionary_remove(ConcurrentDictionary* dict,
+                                        const T* key);
+
+/**
+ * @brief Returns the value stored for a key, inserting value first if the key
+ * is not present. The lookup and the insert happen atomically.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ * @param key Key to look up.
+ * @param value Value to insert if the key is not present.
+ * @param out GenericDataType of value_size bytes the stored value is copied
+ * to, may be NULL.
+ *
+ * @return ReturnBool whose value is true if value was inserted, false if the
+ * key was already present.
+ */
+ReturnBool ConcurrentDictionary_get_or_insert(ConcurrentDictionary* dict,
+                                              const T* key, const T* value,
+                                              T* out);
+
+/**
+ * @brief Atomically updates, inserts or removes the entry for a key.
+ *
+ * compute runs while the key's shard is write locked, so it must be short and
+ * must not use the ConcurrentDictionary itself.
+ *
+ * @param dict Pointer to the ConcurrentDictionary.
+ * @param key Key to update.
+ * @param compute Function deciding the new value, see ComputeFunction.
+ * @param context Pointer passed through to compute.
+ *
+ * @return ReturnBool whose value is true if the key is present afterwards.
+ */
+ReturnBool ConcurrentDictionary_compute(ConcurrentDictionary* dict,
+                                        const T* key, ComputeFunction compute,
+                                        void* context);
+
+#endif
@@ -1,6 +1,586 @@
-#ifndef DICTIONARY_H
-#define DICTIONARY_H
+#include "dictionary.h"
 
-#include "/home/tj/Documents/MyUtilLib/src/data_structures/arrays/array.h"
+#if defined(__SSE2__)
+#define DICTIONARY_SSE2 1
+#include <emmintrin.h>
+#endif
 
-#endif
\ No newline at end of file
+// Control bytes compared per probe step
+#define GROUP_WIDTH 16
+#define MIN_CAPACITY GROUP_WIDTH
+#define CTRL_EMPTY ((uint8_t)0x80)
+
+#define HASH_PRIME_1 0x9E3779B97F4A7C15ull
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define HASH_PRIME_3 0x165667B19E3779F9ull
+
+/*
+ * Hashing
+ */
+
+static inline uint64_t rotate_left(uint64_t x, int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+static inline uint64_t hash_round(uint64_t hash, uint64_t word) {
+    word *= HASH_PRIME_2;
+    word = rotate_left(word, 31) * HASH_PRIME_1;
+    hash ^= word;
+    return rotate_left(hash, 27) * HASH_PRIME_1 + HASH_PRIME_3;
+}
+
+uint64_t Dictionary_hash_bytes(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = seed ^ ((uint64_t)size * HASH_PRIME_1);
+
+    for (; size >= 8; size -= 8, bytes += 8) {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        hash = hash_round(hash, word);
+    }
+    if (size > 0) {
+        uint64_t word = 0;
+        memcpy(&word, bytes, size);
+        hash = hash_round(hash, word);
+    }
+
+    // Final avalanche so the low bits used for h2 depend on every input bit
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/*
+ * Control byte groups. Bit i of a group mask stands for slot pos + i.
+ */
+
+#ifdef DICTIONARY_SSE2
+
+static inline uint32_t group_match(const uint8_t* control, uint8_t h2) {
+    __m128i group = _mm_loadu_si128((const __m128i*)control);
+    __m128i equal = _mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2));
+    return (uint32_t)_mm_movemask_epi8(equal);
+}
+
+// Only EMPTY has the high bit set
+static inline uint32_t group_empty(const uint8_t* control) {
+    __m128i group = _mm_loadu_si128((const __m128i*)control);
+    return (uint32_t)_mm_movemask_epi8(group);
+}
+
+#else
+
+static inline uint32_t group_match(const uint8_t* control, uint8_t h2) {
+    uint32_t mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(control[i] == h2) << i;
+    }
+    return mask;
+}
+
+static inline uint32_t group_empty(const uint8_t* control) {
+    uint32_t mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(control[i] >> 7) << i;
+    }
+    return mask;
+}
+
+#endif
+
+/*
+ * Slots hold the full hash, then the key (inline bytes, or a T owning a copy
+ * of a byte string), then the value, each 8 byte aligned.
+ */
+
+static inline size_t round_up_8(size_t bytes) {
+    return (bytes + 7) & ~(size_t)7;
+}
+
+static inline size_t key_offset(void) { return sizeof(uint64_t); }
+
+static inline size_t value_offset(const Dictionary* dict) {
+    size_t key_bytes = dict->key_size > 0 ? dict->key_size : sizeof(T);
+    return round_up_8(key_offset() + key_bytes);
+}
+
+static inline char* slot_at(const Dictionary* dict, size_t index) {
+    return (char*)dict->slots + index * dict->slot_size;
+}
+
+static inline uint64_t slot_hash(const Dictionary* dict, size_t index) {
+    uint64_t hash;
+    memcpy(&hash, slot_at(dict, index), sizeof(uint64_t));
+    return hash;
+}
+
+static inline T slot_key(const Dictionary* dict, size_t index) {
+    T key;
+    if (dict->key_size > 0) {
+        key.size = dict->key_size;
+        key.data = slot_at(dict, index) + key_offset();
+    } else {
+        memcpy(&key, slot_at(dict, index) + key_offset(), sizeof(T));
+    }
+    return key;
+}
+
+static inline void* slot_value(const Dictionary* dict, size_t index) {
+    return slot_at(dict, index) + value_offset(dict);
+}
+
+static inline uint8_t hash_h2(uint64_t hash) {
+    return (uint8_t)(hash & 0x7F);
+}
+
+static inline size_t hash_home(const Dictionary* dict, uint64_t hash) {
+    return (size_t)(hash >> 7) & (dict->capacity - 1);
+}
+
+// The first GROUP_WIDTH - 1 control bytes are mirrored past the end so a
+// group starting near the end wraps around without a second load
+static inline void set_control(Dictionary* dict, size_t index, uint8_t value) {
+    dict->control[index] = value;
+    if (index < GROUP_WIDTH - 1) {
+        dict->control[dict->capacity + index] = value;
+    }
+}
+
+static inline size_t max_entries(size_t capacity) {
+    return capacity - capacity / 8;
+}
+
+static uint64_t hash_key(const Dictionary* dict, const T* key) {
+    return dict->hash(key->data, key->size, dict->seed);
+}
+
+static bool key_equal(const Dictionary* dict, size_t index, const T* key) {
+    T stored = slot_key(dict, index);
+    if (stored.size != key->size) {
+        return false;
+    }
+    return stored.size == 0 || memcmp(stored.data, key->data, key->size) == 0;
+}
+
+// Slot holding key, SIZE_MAX if there is none
+static size_t find_slot(const Dictionary* dict, uint64_t hash, const T* key) {
+    if (dict->capacity == 0) {
+        return SIZE_MAX;
+    }
+
+    size_t mask = dict->capacity - 1;
+    size_t pos = hash_home(dict, hash);
+    uint8_t h2 = hash_h2(hash);
+
+    for (;;) {
+        const uint8_t* group = dict->control + pos;
+        uint32_t matches = group_match(group, h2);
+        while (matches != 0) {
+            size_t index = (pos + (size_t)__builtin_ctz(matches)) & mask;
+            if (slot_hash(dict, index) == hash &&
+                key_equal(dict, index, key)) {
+                return index;
+            }
+            matches &= matches - 1;
+        }
+
+        // Entries never sit past an empty slot on their probe sequence
+        if (group_empty(group) != 0) {
+            return SIZE_MAX;
+        }
+        pos = (pos + GROUP_WIDTH) & mask;
+    }
+}
+
+// First empty slot on the probe sequence of hash, the table is never full
+static size_t find_empty(const Dictionary* dict, uint64_t hash) {
+    size_t mask = dict->capacity - 1;
+    size_t pos = hash_home(dict, hash);
+
+    for (;;) {
+        uint32_t empty = group_empty(dict->control + pos);
+        if (empty != 0) {
+            return (pos + (size_t)__builtin_ctz(empty)) & mask;
+        }
+        pos = (pos + GROUP_WIDTH) & mask;
+    }
+}
+
+static void free_keys(Dictionary* dict) {
+    if (dict->key_size > 0) {
+        return;
+    }
+    for (size_t i = 0; i < dict->capacity; i++) {
+        if (dict->control[i] != CTRL_EMPTY) {
+            free(slot_key(dict, i).data);
+        }
+    }
+}
+
+// Moves every entry into a table of new_capacity slots. Stored hashes are
+// reused, so no key is hashed or compared.
+static ErrorCode rehash(Dictionary* dict, size_t new_capacity) {
+    if (new_capacity > SIZE_MAX / dict->slot_size ||
+        new_capacity > SIZE_MAX - GROUP_WIDTH) {
+        return ERROR_ALLOCATION;
+    }
+
+    uint8_t* control = (uint8_t*)malloc(new_capacity + GROUP_WIDTH);
+    void* slots = malloc(new_capacity * dict->slot_size);
+    if (control == NULL || slots == NULL) {
+        free(control);
+        free(slots);
+        return ERROR_ALLOCATION;
+    }
+    memset(control, CTRL_EMPTY, new_capacity + GROUP_WIDTH);
+
+    Dictionary old = *dict;
+    dict->control = control;
+    dict->slots = slots;
+    dict->capacity = new_capacity;
+
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.control[i] == CTRL_EMPTY) {
+            continue;
+        }
+        uint64_t hash = slot_hash(&old, i);
+        size_t index = find_empty(dict, hash);
+        memcpy(slot_at(dict, index), slot_at(&old, i), dict->slot_size);
+        set_control(dict, index, hash_h2(hash));
+    }
+
+    free(old.control);
+    free(old.slots);
+    dict->growth_left = max_entries(new_capacity) - dict->size;
+    return NO_ERROR;
+}
+
+static ErrorCode check_key(const Dictionary* dict, const T* key) {
+    if (key == NULL || (key->data == NULL && key->size > 0)) {
+        return ERROR_NULL;
+    }
+    if (dict->key_size > 0 && key->size != dict->key_size) {
+        return ERROR;
+    }
+    return NO_ERROR;
+}
+
+ReturnDictionary Dictionary_create(size_t key_size, size_t value_size) {
+    return Dictionary_create_with_hash(key_size, value_size, NULL, 0);
+}
+
+ReturnDictionary Dictionary_create_with_hash(size_t key_size,
+                                             size_t value_size,
+                                             HashFunction hash,
+                                             uint64_t seed) {
+    ReturnDictionary result = {.error = NO_ERROR, .dict = NULL};
+
+    if (key_size > SIZE_MAX / 4 || value_size > SIZE_MAX / 4) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    Dictionary* dict = (Dictionary*)malloc(sizeof(Dictionary));
+    if (dict == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    dict->size = 0;
+    dict->capacity = 0;
+    dict->growth_left = 0;
+    dict->key_size = key_size;
+    dict->value_size = value_size;
+    dict->slot_size = round_up_8(value_offset(dict) + value_size);
+    dict->control = NULL;
+    dict->slots = NULL;
+    dict->hash = hash != NULL ? hash : Dictionary_hash_bytes;
+    dict->seed = seed;
+
+    result.dict = dict;
+    return result;
+}
+
+ReturnError Dictionary_destroy(Dictionary** dict) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || *dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    free_keys(*dict);
+    free((*dict)->control);
+    free((*dict)->slots);
+    free(*dict);
+    *dict = NULL;
+
+    return result;
+}
+
+ReturnError Dictionary_clear(Dictionary* dict) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (dict->capacity > 0) {
+        free_keys(dict);
+        memset(dict->control, CTRL_EMPTY, dict->capacity + GROUP_WIDTH);
+        dict->growth_left = max_entries(dict->capacity);
+    }
+    dict->size = 0;
+
+    return result;
+}
+
+size_t Dictionary_size(const Dictionary* dict) {
+    if (dict == NULL) {
+        return SIZE_MAX;
+    }
+    return dict->size;
+}
+
+ReturnError Dictionary_reserve(Dictionary* dict, size_t count) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    size_t capacity = MIN_CAPACITY;
+    while (max_entries(capacity) < count) {
+        if (capacity > SIZE_MAX / 2) {
+            result.error = ERROR_ALLOCATION;
+            return result;
+        }
+        capacity *= 2;
+    }
+
+    if (capacity > dict->capacity) {
+        result.error = rehash(dict, capacity);
+    }
+    return result;
+}
+
+ReturnError Dictionary_insert(Dictionary* dict, const T* key, const T* value) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || value == NULL ||
+        (value->data == NULL && dict->value_size > 0)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_key(dict, key);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    if (value->size != dict->value_size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    uint64_t hash = hash_key(dict, key);
+
+    // Existing key, only the value changes
+    size_t index = find_slot(dict, hash, key);
+    if (index != SIZE_MAX) {
+        memcpy(slot_value(dict, index), value->data, dict->value_size);
+        return result;
+    }
+
+    if (dict->growth_left == 0) {
+        if (dict->capacity > SIZE_MAX / 2) {
+            result.error = ERROR_ALLOCATION;
+            return result;
+        }
+        size_t capacity =
+            dict->capacity == 0 ? MIN_CAPACITY : dict->capacity * 2;
+        result.error = rehash(dict, capacity);
+        if (result.error != NO_ERROR) {
+            return result;
+        }
+    }
+
+    // Byte string keys get their own copy
+    T stored = *key;
+    if (dict->key_size == 0) {
+        stored.data = NULL;
+        if (key->size > 0) {
+            stored.data = malloc(key->size);
+            if (stored.data == NULL) {
+                result.error = ERROR_ALLOCATION;
+                return result;
+            }
+            memcpy(stored.data, key->data, key->size);
+        }
+    }
+
+    index = find_empty(dict, hash);
+    char* slot = slot_at(dict, index);
+    memcpy(slot, &hash, sizeof(uint64_t));
+    if (dict->key_size > 0) {
+        memcpy(slot + key_offset(), key->data, dict->key_size);
+    } else {
+        memcpy(slot + key_offset(), &stored, sizeof(T));
+    }
+    if (dict->value_size > 0) {
+        memcpy(slot_value(dict, index), value->data, dict->value_size);
+    }
+    set_control(dict, index, hash_h2(hash));
+
+    dict->size++;
+    dict->growth_left--;
+    return result;
+}
+
+ReturnView Dictionary_get(const Dictionary* dict, const T* key) {
+    ReturnView result = {.error = NO_ERROR, .value = {0, NULL}};
+
+    if (dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_key(dict, key);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    size_t index = find_slot(dict, hash_key(dict, key), key);
+    if (index == SIZE_MAX) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    result.value.size = dict->value_size;
+    result.value.data = slot_value(dict, index);
+
+    return result;
+}
+
+ReturnError Dictionary_get_copy(const Dictionary* dict, const T* key, T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || out == NULL ||
+        (out->data == NULL && dict->value_size > 0)) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_key(dict, key);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    if (out->size != dict->value_size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    size_t index = find_slot(dict, hash_key(dict, key), key);
+    if (index == SIZE_MAX) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    if (dict->value_size > 0) {
+        memcpy(out->data, slot_value(dict, index), dict->value_size);
+    }
+    return result;
+}
+
+ReturnBool Dictionary_contains(const Dictionary* dict, const T* key) {
+    ReturnBool result = {.error = NO_ERROR, .value = false};
+
+    if (dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_key(dict, key);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    result.value = find_slot(dict, hash_key(dict, key), key) != SIZE_MAX;
+    return result;
+}
+
+ReturnError Dictionary_remove(Dictionary* dict, const T* key) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_key(dict, key);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    size_t hole = find_slot(dict, hash_key(dict, key), key);
+    if (hole == SIZE_MAX) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    if (dict->key_size == 0) {
+        free(slot_key(dict, hole).data);
+    }
+
+    // Shift later entries of the probe run back into the hole whenever the
+    // hole lies between their home slot and where they sit, so lookups keep
+    // stopping at the first empty slot without tombstones
+    size_t mask = dict->capacity - 1;
+    size_t index = hole;
+    for (;;) {
+        index = (index + 1) & mask;
+        if (dict->control[index] == CTRL_EMPTY) {
+            break;
+        }
+
+        size_t home = hash_home(dict, slot_hash(dict, index));
+        if (((index - home) & mask) >= ((index - hole) & mask)) {
+            memcpy(slot_at(dict, hole), slot_at(dict, index),
+                   dict->slot_size);
+            set_control(dict, hole, dict->control[index]);
+            hole = index;
+        }
+    }
+    set_control(dict, hole, CTRL_EMPTY);
+
+    dict->size--;
+    dict->growth_left++;
+    return result;
+}
+
+ReturnError Dictionary_iterate(Dictionary* dict,
+                               void (*callback)(const T* key, T* value)) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (dict == NULL || callback == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    for (size_t i = 0; i < dict->capacity; i++) {
+        if (dict->control[i] == CTRL_EMPTY) {
+            continue;
+        }
+        T key = slot_key(dict, i);
+        T value = {dict->value_size, slot_value(dict, i)};
+        callback(&key, &value);
+    }
+
+    return result;
+}
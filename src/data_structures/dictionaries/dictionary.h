@@ -0,0 +1,201 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../arrays/array.h"
+
+/**
+ * @brief Hash function a Dictionary hashes its keys with.
+ *
+ * @param data Pointer to the key bytes.
+ * @param size Number of key bytes.
+ * @param seed Seed the Dictionary was created with.
+ *
+ * @return A 64 bit hash. All of its bits are used, so it should be well mixed.
+ */
+typedef uint64_t (*HashFunction)(const void* data, size_t size, uint64_t seed);
+
+/**
+ * @brief Hash map from keys to fixed size values using open addressing.
+ *
+ * Every slot has a control byte holding 7 bits of its key's hash, or EMPTY.
+ * A lookup compares 16 control bytes at once (with SSE2 where available) and
+ * only looks at the keys whose bits match, so most misses never touch a key.
+ * Probing is linear one slot at a time and removal shifts the following
+ * entries back, so there are no tombstones and lookups never slow down after
+ * many removals.
+ *
+ * Keys are either key_size bytes each, or byte strings of any length when
+ * key_size is 0. Keys and values are copied into the Dictionary.
+ */
+typedef struct Dictionary {
+    size_t size;         ///< Number of entries
+    size_t capacity;     ///< Number of slots, a power of two or 0
+    size_t growth_left;  ///< Entries that fit before the table must grow
+    size_t key_size;     ///< Size of each key in bytes, 0 for byte strings
+    size_t value_size;   ///< Size of each value in bytes
+    size_t slot_size;    ///< Bytes per slot: hash, key and value
+    uint8_t* control;    ///< capacity + 16 control bytes
+    void* slots;         ///< capacity slots
+    HashFunction hash;   ///< Hash function used for every key
+    uint64_t seed;       ///< Seed handed to the hash function
+} Dictionary;
+
+typedef struct ReturnDictionaryType {
+    ErrorCode error;
+    Dictionary* dict;
+} ReturnDictionary;
+
+/**
+ * @brief Default hash function, a fast 64 bit multiply and rotate hash.
+ *
+ * @param data Pointer to the bytes to hash.
+ * @param size Number of bytes.
+ * @param seed Seed mixed into the hash.
+ *
+ * @return The 64 bit hash of the bytes.
+ */
+uint64_t Dictionary_hash_bytes(const void* data, size_t size, uint64_t seed);
+
+/**
+ * @brief Creates a new Dictionary that hashes with Dictionary_hash_bytes.
+ *
+ * @param key_size Size of each key in bytes, or 0 for byte string keys.
+ * @param value_size Size of each value in bytes.
+ *
+ * @return ReturnDictionary will either return an ErrorCode or a Dictionary*
+ */
+ReturnDictionary Dictionary_create(size_t key_size, size_t value_size);
+
+/**
+ * @brief Creates a new Dictionary with a custom hash function.
+ *
+ * @param key_size Size of each key in bytes, or 0 for byte string keys.
+ * @param value_size Size of each value in bytes.
+ * @param hash Hash function for the keys, NULL uses Dictionary_hash_bytes.
+ * @param seed Seed handed to every call of the hash function.
+ *
+ * @return ReturnDictionary will either return an ErrorCode or a Dictionary*
+ */
+ReturnDictionary Dictionary_create_with_hash(size_t key_size,
+                                             size_t value_size,
+                                             HashFunction hash,
+                                             uint64_t seed);
+
+/**
+ * @brief Destroys a Dictionary and frees associated memory.
+ *
+ * @param dict Pointer to the Dictionary to be destroyed.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Dictionary_destroy(Dictionary** dict);
+
+/**
+ * @brief Removes every entry, keeping the table for reuse.
+ *
+ * @param dict Pointer to the Dictionary.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Dictionary_clear(Dictionary* dict);
+
+/**
+ * @brief Returns the number of entries in the Dictionary.
+ *
+ * @param dict Pointer to the Dictionary.
+ *
+ * @return size_t number of entries, SIZE_MAX if dict is NULL
+ */
+size_t Dictionary_size(const Dictionary* dict);
+
+/**
+ * @brief Grows the table so that count entries fit without rehashing.
+ *
+ * @param dict Pointer to the Dictionary.
+ * @param count Number of entries to make room for.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Dictionary_reserve(Dictionary* dict, size_t count);
+
+/**
+ * @brief Inserts a key with its value, replacing the value if the key is
+ * already present.
+ *
+ * @param dict Pointer to the Dictionary.
+ * @param key Key to insert. Its size must be key_size unless the Dictionary
+ * has byte string keys.
+ * @param value Value to store, its size must be value_size.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Dictionary_insert(Dictionary* dict, const T* key, const T* value);
+
+/**
+ * @brief Looks up the value stored for a key.
+ *
+ * @param dict Pointer to the Dictionary.
+ * @param key Key to look up.
+ *
+ * @return ReturnView with a view of the value inside the Dictionary, or
+ * ERROR_NOT_FOUND. The view is valid until the next call that changes the
+ * Dictionary. Lookups only read the Dictionary, so several threads may look
+ * up keys at once as long as none of them changes it.
+ */
+ReturnView Dictionary_get(const Dictionary* dict, const T* key);
+
+/**
+ * @brief Copies the value stored for a key out of the Dictionary.
+ *
+ * Unlike the view from Dictionary_get the copy stays valid after the
+ * Dictionary changes.
+ *
+ * @param dict Pointer to the Dictionary.
+ * @param key Key to look up.
+ * @param out GenericDataType of value_size bytes the value is copied to.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_NOT_FOUND if the key is not present.
+ */
+ReturnError Dictionary_get_copy(const Dictionary* dict, const T* key, T* out);
+
+/**
+ * @brief Checks whether a key is present.
+ *
+ * @param dict Pointer to the Dictionary.
+ * @param key Key to look up.
+ *
+ * @return ReturnBool will either return an ErrorCode or a bool
+ */
+ReturnBool Dictionary_contains(const Dictionary* dict, const T* key);
+
+/**
+ * @brief Removes a key and its value.
+ *
+ * @param dict Pointer to the Dictionary.
+ * @param key Key to remove.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_NOT_FOUND if the key was not present.
+ */
+ReturnError Dictionary_remove(Dictionary* dict, const T* key);
+
+/**
+ * @brief Calls callback on every entry, in no particular order.
+ *
+ * @param dict Pointer to the Dictionary.
+ * @param callback Function called with a view of each key and value. It may
+ * change the value but must not change the Dictionary.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError Dictionary_iterate(Dictionary* dict,
+                               void (*callback)(const T* key, T* value));
+
+#endif
@@ -1,54 +1,244 @@
 #include "dlist.h"
 
+#define DLIST_NODE_ALIGNMENT _Alignof(max_align_t)
+
+// Bytes in front of the data in every node allocation
+#define DLIST_NODE_HEADER                                          \
+    ((sizeof(DListNode) + DLIST_NODE_ALIGNMENT - 1) /              \
+     DLIST_NODE_ALIGNMENT * DLIST_NODE_ALIGNMENT)
+
 /**
  * @brief Creates a new list.
  * @param data_size: The data size of the elements to be included in this list.
  * @return List*: Pointer to the newly created list, NULL if memory
  * allocation fails.
  */
-DList* DList_create(size_t data_size);
+DList* DList_create(size_t data_size) {
+    return DList_create_with_allocator(data_size, NULL);
+}
+
+/**
+ * @brief Creates a new list whose memory comes from a custom allocator.
+ * @param data_size: The data size of the elements to be included in this list.
+ * @param allocator: Allocator for the list, its nodes and their data. It is
+ * copied into the list; NULL uses the standard library.
+ * @return DList*: Pointer to the newly created list, NULL if memory
+ * allocation fails.
+ */
+DList* DList_create_with_allocator(size_t data_size,
+                                   const Allocator* allocator) {
+    DList* new_list = (DList*)Allocator_alloc(allocator, sizeof(DList));
+    if (new_list == NULL) {
+        return (DList*)NULL;
+    }
+
+    new_list->head =
+        (DListNode**)Allocator_alloc(allocator, sizeof(DListNode*));
+    if (new_list->head == NULL) {
+        Allocator_free(allocator, new_list, sizeof(DList));
+        return (DList*)NULL;
+    }
+
+    // Keep a copy of the allocator, a zeroed one means the standard library
+    if (allocator != NULL) {
+        new_list->allocator = *allocator;
+    } else {
+        memset(&new_list->allocator, 0, sizeof(Allocator));
+    }
+
+    *(new_list->head) = NULL;
+    new_list->tail = NULL;
+    new_list->data_size = data_size;
+    new_list->size = 0;
+
+    return new_list;
+}
+
+static DListNode* create_node(DList* list, void* element) {
+    DListNode* new_node = (DListNode*)Allocator_alloc(
+        &list->allocator, DLIST_NODE_HEADER + list->data_size);
+    if (new_node == NULL) {
+        return (DListNode*)NULL;
+    }
+
+    new_node->data = (char*)new_node + DLIST_NODE_HEADER;
+    memcpy(new_node->data, element, list->data_size);
+    new_node->next = NULL;
+    new_node->prev = NULL;
+    return new_node;
+}
+
+static void free_node(DList* list, DListNode* node) {
+    Allocator_free(&list->allocator, node, DLIST_NODE_HEADER + list->data_size);
+}
+
+// Links node in front of next, or at the end of the list if next is NULL
+static void link_before(DList* list, DListNode* next, DListNode* node) {
+    DListNode* prev = next != NULL ? next->prev : list->tail;
+
+    node->next = next;
+    node->prev = prev;
+    if (prev != NULL) {
+        prev->next = node;
+    } else {
+        *(list->head) = node;
+    }
+    if (next != NULL) {
+        next->prev = node;
+    } else {
+        list->tail = node;
+    }
+    list->size++;
+}
+
+// Takes node out of the list without freeing it
+static void unlink_node(DList* list, DListNode* node) {
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        *(list->head) = node->next;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    } else {
+        list->tail = node->prev;
+    }
+    node->next = NULL;
+    node->prev = NULL;
+    list->size--;
+}
 
 /**
  * @brief clears the contents of the list
  * @param list: Pointer to the linked list.
  */
-void DList_clear(DList* list);
+void DList_clear(DList* list) {
+    if (list == NULL || list->head == NULL) {
+        return;
+    }
+
+    DListNode* current = *(list->head);
+    while (current != NULL) {
+        DListNode* next = current->next;
+        free_node(list, current);
+        current = next;
+    }
+
+    *(list->head) = NULL;
+    list->tail = NULL;
+    list->size = 0;
+}
 
 /**
  * @brief Destroys the entire linked list.
  * @param list: Pointer to a pointer to the linked list.
  */
-void DList_destroy(DList** list);
+void DList_destroy(DList** list) {
+    if (list == NULL || *list == NULL) {
+        return;
+    }
+
+    DList_clear(*list);
+
+    // Copy the allocator out, it lives inside the block being freed
+    Allocator allocator = (*list)->allocator;
+    Allocator_free(&allocator, (*list)->head, sizeof(DListNode*));
+    Allocator_free(&allocator, *list, sizeof(DList));
+    *list = NULL;
+}
 
 /**
  * @brief Returns the size of the linked list.
  * @param list: Pointer to the linked list.
  * @return size_t: Number of nodes in the list. SIZE_MAX if list is NULL
  */
-size_t DList_size(DList* list);
+size_t DList_size(DList* list) {
+    if (list == NULL) {
+        return SIZE_MAX;
+    }
+
+    return list->size;
+}
 
 /**
  * @brief Inserts a new node with the provided element at the specified index in
  * the linked list.
  * @param list: Pointer to the linked list.
  * @param element: Element to be inserted.
- * @param index: Index at which the element needs to be inserted.
+ * @param index: Index at which the element needs to be inserted, nothing is
+ * inserted past the end of the list.
  */
-void DList_insert(DList* list, void* element, size_t index);
+void DList_insert(DList* list, void* element, size_t index) {
+    if (list == NULL || list->head == NULL || element == NULL ||
+        index > list->size) {
+        return;
+    }
+
+    DListNode* new_node = create_node(list, element);
+    if (new_node == NULL) {
+        return;
+    }
+
+    // The node currently at index ends up after the new one, NULL appends
+    DListNode* next = index < list->size ? DList_get(list, index) : NULL;
+    link_before(list, next, new_node);
+}
 
 /**
  * @brief Inserts an element at the beginning of the linked list.
  * @param list: Pointer to the linked list.
  * @param element: Element to be inserted.
  */
-void DList_prepend(DList* list, void* element);
+void DList_prepend(DList* list, void* element) {
+    DList_insert(list, element, 0);
+}
 
 /**
  * @brief Inserts an element at the end of the linked list.
  * @param list: Pointer to the linked list.
  * @param element: Element to be inserted.
  */
-void DList_append(DList* list, void* element);
+void DList_append(DList* list, void* element) {
+    DList_insert(list, element, DList_size(list));
+}
+
+static bool pop_node(DList* list, DListNode* node, void* out) {
+    if (node == NULL) {
+        return false;
+    }
+
+    if (out != NULL) {
+        memcpy(out, node->data, list->data_size);
+    }
+    DList_remove_node(list, node);
+    return true;
+}
+
+/**
+ * @brief Removes the first element of the linked list.
+ * @param list: Pointer to the linked list.
+ * @param out: Where the removed element is copied to, may be NULL.
+ * @return bool: true if an element was removed, false if the list is empty.
+ */
+bool DList_pop_front(DList* list, void* out) {
+    if (list == NULL || list->head == NULL) {
+        return false;
+    }
+    return pop_node(list, *(list->head), out);
+}
+
+/**
+ * @brief Removes the last element of the linked list.
+ * @param list: Pointer to the linked list.
+ * @param out: Where the removed element is copied to, may be NULL.
+ * @return bool: true if an element was removed, false if the list is empty.
+ */
+bool DList_pop_back(DList* list, void* out) {
+    if (list == NULL || list->head == NULL) {
+        return false;
+    }
+    return pop_node(list, list->tail, out);
+}
 
 /**
  * @brief Finds the index of the specified element in the linked list.
@@ -56,7 +246,25 @@ void DList_append(DList* list, void* element);
  * @param element: Element to be found.
  * @return size_t: Index of the element in the list, SIZE_MAX if not found.
  */
-size_t DList_find(DList* list, void* element);
+size_t DList_find(DList* list, void* element) {
+    if (list == NULL || list->head == NULL || element == NULL) {
+        return SIZE_MAX;
+    }
+
+    size_t index = 0;
+    DListNode* current = *(list->head);
+
+    while (current != NULL) {
+        if (memcmp(current->data, element, list->data_size) == 0) {
+            return index;
+        }
+
+        index++;
+        current = current->next;
+    }
+
+    return SIZE_MAX;
+}
 
 /**
  * @brief Retrieves the node at the specified index in the linked list.
@@ -65,14 +273,50 @@ size_t DList_find(DList* list, void* element);
  * @return DListNode*: Pointer to the node at the given index, NULL if index is
  * out of bounds.
  */
-DListNode* DList_get(DList* list, size_t index);
+DListNode* DList_get(DList* list, size_t index) {
+    if (list == NULL || list->head == NULL || index >= list->size) {
+        return (DListNode*)NULL;
+    }
+
+    // Walk from whichever end is closer, at most size / 2 steps
+    DListNode* current;
+    if (index < list->size / 2) {
+        current = *(list->head);
+        for (size_t i = 0; i < index; i++) {
+            current = current->next;
+        }
+    } else {
+        current = list->tail;
+        for (size_t i = list->size - 1; i > index; i--) {
+            current = current->prev;
+        }
+    }
+
+    return current;
+}
 
 /**
  * @brief Removes the node at the specified index from the linked list.
  * @param list: Pointer to the linked list.
  * @param index: Index of the node to be removed.
  */
-void DList_remove(DList* list, size_t index);
+void DList_remove(DList* list, size_t index) {
+    DList_remove_node(list, DList_get(list, index));
+}
+
+/**
+ * @brief Removes a node from the linked list in constant time.
+ * @param list: Pointer to the linked list.
+ * @param node: Node of this list to be removed, it is freed.
+ */
+void DList_remove_node(DList* list, DListNode* node) {
+    if (list == NULL || list->head == NULL || node == NULL) {
+        return;
+    }
+
+    unlink_node(list, node);
+    free_node(list, node);
+}
 
 /**
  * @brief Iterates through the linked list and performs the callback function on
@@ -80,7 +324,17 @@ void DList_remove(DList* list, size_t index);
  * @param list: Pointer to the linked list.
  * @param callback: Function to be called on each element in the list.
  */
-void DList_iterate(DList* list, void (*callback)(const void* element));
+void DList_iterate(DList* list, void (*callback)(const void* element)) {
+    if (list == NULL || list->head == NULL || callback == NULL) {
+        return;
+    }
+
+    DListNode* current = *(list->head);
+    while (current != NULL) {
+        callback(current->data);
+        current = current->next;
+    }
+}
 
 /**
  * @brief Swaps the positions of two elements in the linked list.
@@ -88,28 +342,81 @@ void DList_iterate(DList* list, void (*callback)(const void* element));
  * @param index_a: Index of the first element to swap.
  * @param index_b: Index of the second element to swap.
  */
-void DList_swap(DList* list, size_t index_a, size_t index_b);
+void DList_swap(DList* list, size_t index_a, size_t index_b) {
+    DListNode* node_a = DList_get(list, index_a);
+    DListNode* node_b = DList_get(list, index_b);
 
-/**
- * @brief Represents a function pointer type used for comparing nodes in a
- * doubly linked list.
- *
- * This function pointer type is used to compare nodes in a linked list. It
- * takes two `DListNode` pointers as arguments and returns an integer indicating
- * the comparison result. The function should follow the convention of returning
- * a negative value if the first node should precede the second node, zero if
- * they are equivalent, and a positive value if the second node should precede
- * the first node.
- *
- * @param a Pointer to the first `DListNode` to compare.
- * @param b Pointer to the second `DListNode` to compare.
- * @return An integer representing the comparison result.
- */
-typedef int (*DListNodeCompareFunction)(const DListNode* a, const DListNode* b);
+    if (node_a == NULL || node_b == NULL || node_a == node_b) {
+        return;
+    }
+
+    // Relink the nodes rather than copying their data
+    if (node_a->next == node_b) {
+        unlink_node(list, node_b);
+        link_before(list, node_a, node_b);
+    } else if (node_b->next == node_a) {
+        unlink_node(list, node_a);
+        link_before(list, node_b, node_a);
+    } else {
+        DListNode* after_a = node_a->next;
+        unlink_node(list, node_a);
+        link_before(list, node_b, node_a);
+        unlink_node(list, node_b);
+        link_before(list, after_a, node_b);
+    }
+}
 
 /**
- * @brief Sorts the linked list using QuickSort algorithm.
+ * @brief Sorts the linked list with a stable bottom-up merge sort.
  * @param list: Pointer to the linked list.
  * @param compare: Function pointer to a comparison function for sorting.
  */
-void DList_sort(DList* list, DListNodeCompareFunction compare);
\ No newline at end of file
+void DList_sort(DList* list, DListNodeCompareFunction compare) {
+    if (list == NULL || list->head == NULL || compare == NULL ||
+        list->size < 2) {
+        return;
+    }
+
+    // Merge runs of width 1, 2, 4, ... pairwise, fixing prev links as the
+    // merged nodes are laid down
+    for (size_t width = 1; width < list->size; width *= 2) {
+        DListNode* left = *(list->head);
+        DListNode** link = list->head;
+        DListNode* last = NULL;
+
+        while (left != NULL) {
+            DListNode* right = left;
+            size_t left_size = 0;
+            while (right != NULL && left_size < width) {
+                right = right->next;
+                left_size++;
+            }
+            size_t right_size = width;
+
+            while (left_size > 0 || (right_size > 0 && right != NULL)) {
+                DListNode* next;
+                // Ties go left to keep the sort stable
+                if (left_size > 0 &&
+                    (right_size == 0 || right == NULL ||
+                     compare(left, right) <= 0)) {
+                    next = left;
+                    left = left->next;
+                    left_size--;
+                } else {
+                    next = right;
+                    right = right->next;
+                    right_size--;
+                }
+                *link = next;
+                next->prev = last;
+                link = &next->next;
+                last = next;
+            }
+
+            left = right;
+        }
+
+        *link = NULL;
+        list->tail = last;
+    }
+}
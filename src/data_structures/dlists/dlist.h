@@ -2,13 +2,19 @@
 #define DLIST_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../common/data_types.h"
+
 /**
  * @brief Represents a node in a doubly linked list containing generic data.
+ *
+ * The data lives in the same allocation as the node, right after it, so
+ * creating or removing a node is a single allocator call.
  */
 typedef struct DListNode {
     void* data;             /**< Pointer to the stored data in the node. */
@@ -23,6 +29,8 @@ typedef struct DList {
     size_t data_size; /**< Size of the data stored in each node. */
     size_t size;      /**< Current size of the linked list. */
     DListNode** head; /**< Pointer to the pointer to the list's head node. */
+    DListNode* tail;  /**< Pointer to the list's last node, NULL if empty. */
+    Allocator allocator; /**< Where the list, its nodes and data come from. */
 } DList;
 
 /**
@@ -33,6 +41,17 @@ typedef struct DList {
  */
 DList* DList_create(size_t data_size);
 
+/**
+ * @brief Creates a new list whose memory comes from a custom allocator.
+ * @param data_size: The data size of the elements to be included in this list.
+ * @param allocator: Allocator for the list, its nodes and their data. It is
+ * copied into the list; NULL uses the standard library.
+ * @return DList*: Pointer to the newly created list, NULL if memory
+ * allocation fails.
+ */
+DList* DList_create_with_allocator(size_t data_size,
+                                   const Allocator* allocator);
+
 /**
  * @brief clears the contents of the list
  * @param list: Pointer to the linked list.
@@ -55,9 +74,12 @@ size_t DList_size(DList* list);
 /**
  * @brief Inserts a new node with the provided element at the specified index in
  * the linked list.
+ *
+ * Walks from whichever end of the list is closer to the index.
  * @param list: Pointer to the linked list.
  * @param element: Element to be inserted.
- * @param index: Index at which the element needs to be inserted.
+ * @param index: Index at which the element needs to be inserted, nothing is
+ * inserted past the end of the list.
  */
 void DList_insert(DList* list, void* element, size_t index);
 
@@ -75,6 +97,22 @@ void DList_prepend(DList* list, void* element);
  */
 void DList_append(DList* list, void* element);
 
+/**
+ * @brief Removes the first element of the linked list.
+ * @param list: Pointer to the linked list.
+ * @param out: Where the removed element is copied to, may be NULL.
+ * @return bool: true if an element was removed, false if the list is empty.
+ */
+bool DList_pop_front(DList* list, void* out);
+
+/**
+ * @brief Removes the last element of the linked list.
+ * @param list: Pointer to the linked list.
+ * @param out: Where the removed element is copied to, may be NULL.
+ * @return bool: true if an element was removed, false if the list is empty.
+ */
+bool DList_pop_back(DList* list, void* out);
+
 /**
  * @brief Finds the index of the specified element in the linked list.
  * @param list: Pointer to the linked list.
@@ -85,6 +123,8 @@ size_t DList_find(DList* list, void* element);
 
 /**
  * @brief Retrieves the node at the specified index in the linked list.
+ *
+ * Walks from whichever end of the list is closer to the index.
  * @param list: Pointer to the linked list.
  * @param index: Index of the node to be retrieved.
  * @return DListNode*: Pointer to the node at the given index, NULL if index is
@@ -99,6 +139,13 @@ DListNode* DList_get(DList* list, size_t index);
  */
 void DList_remove(DList* list, size_t index);
 
+/**
+ * @brief Removes a node from the linked list in constant time.
+ * @param list: Pointer to the linked list.
+ * @param node: Node of this list to be removed, it is freed.
+ */
+void DList_remove_node(DList* list, DListNode* node);
+
 /**
  * @brief Iterates through the linked list and performs the callback function on
  * each element.
@@ -133,10 +180,13 @@ void DList_swap(DList* list, size_t index_a, size_t index_b);
 typedef int (*DListNodeCompareFunction)(const DListNode* a, const DListNode* b);
 
 /**
- * @brief Sorts the linked list using QuickSort algorithm.
+ * @brief Sorts the linked list with a stable bottom-up merge sort.
+ *
+ * Takes O(n log n) comparisons and no extra memory. Nodes are relinked rather
+ * than payloads copied, so pointers to nodes and their data stay valid.
  * @param list: Pointer to the linked list.
  * @param compare: Function pointer to a comparison function for sorting.
  */
 void DList_sort(DList* list, DListNodeCompareFunction compare);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,529 @@
+#include "priority_queue.h"
+
+#define PRIORITY_QUEUE_INITIAL_CAPACITY 16
+
+// An indexed queue keeps every handle it has ever handed out in handles:
+// slots [0, size) hold the handles of the elements in heap order and the
+// slots after them hold the free handles, ready for reuse. positions is the
+// inverse, so a handle is live exactly when its position is below size.
+
+static inline void* slot_at(const PriorityQueue* queue, size_t slot) {
+    return (char*)queue->heap->data + slot * queue->heap->data_size;
+}
+
+static inline size_t* handle_at(const PriorityQueue* queue, size_t slot) {
+    return (size_t*)queue->handles->data + slot;
+}
+
+static inline size_t* position_of(const PriorityQueue* queue, size_t handle) {
+    return (size_t*)queue->positions->data + handle;
+}
+
+// Whether the element at a comes strictly before the element at b
+static inline bool before(const PriorityQueue* queue, const void* a,
+                          const void* b) {
+    T x = {queue->heap->data_size, (void*)a};
+    T y = {queue->heap->data_size, (void*)b};
+    return queue->compare(&x, &y) < 0;
+}
+
+// Moves the element in slot from, with its handle, into slot to
+static inline void move_slot(PriorityQueue* queue, size_t to, size_t from) {
+    memcpy(slot_at(queue, to), slot_at(queue, from), queue->heap->data_size);
+    if (queue->handles != NULL) {
+        size_t handle = *handle_at(queue, from);
+        *handle_at(queue, to) = handle;
+        *position_of(queue, handle) = to;
+    }
+}
+
+// Writes the element held in scratch, with its handle, into slot
+static inline void place(PriorityQueue* queue, size_t slot, size_t handle) {
+    memcpy(slot_at(queue, slot), queue->scratch, queue->heap->data_size);
+    if (queue->handles != NULL) {
+        *handle_at(queue, slot) = handle;
+        *position_of(queue, handle) = slot;
+    }
+}
+
+// Moves the element in scratch up from slot, shifting parents down into the
+// hole instead of swapping, and stores it where it stops
+static void sift_up(PriorityQueue* queue, size_t slot, size_t handle) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / queue->arity;
+        if (!before(queue, queue->scratch, slot_at(queue, parent))) {
+            break;
+        }
+        move_slot(queue, slot, parent);
+        slot = parent;
+    }
+    place(queue, slot, handle);
+}
+
+// Moves the element in scratch down from slot, pulling the first child of
+// each level up into the hole
+static void sift_down(PriorityQueue* queue, size_t slot, size_t handle) {
+    size_t size = queue->heap->size;
+    while (size >= 2 && slot <= (size - 2) / queue->arity) {
+        size_t child = slot * queue->arity + 1;
+        size_t end = size - child < queue->arity ? size : child + queue->arity;
+        size_t best = child;
+        for (child++; child < end; child++) {
+            if (before(queue, slot_at(queue, child), slot_at(queue, best))) {
+                best = child;
+            }
+        }
+        if (!before(queue, slot_at(queue, best), queue->scratch)) {
+            break;
+        }
+        move_slot(queue, slot, best);
+        slot = best;
+    }
+    place(queue, slot, handle);
+}
+
+// Checks out can receive an element, NULL is allowed where optional
+static bool valid_out(const PriorityQueue* queue, const T* out) {
+    return out == NULL ||
+           (out->size == queue->heap->data_size && out->data != NULL);
+}
+
+static ReturnPriorityQueue create(size_t data_size, CompareFunction compare,
+                                  size_t arity, size_t capacity,
+                                  bool indexed) {
+    ReturnPriorityQueue result = {.error = NO_ERROR, .queue = NULL};
+
+    if (compare == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (data_size == 0 || (arity != 2 && arity != 4)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    PriorityQueue* queue = (PriorityQueue*)malloc(sizeof(PriorityQueue));
+    if (queue == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    queue->compare = compare;
+    queue->arity = arity;
+    queue->handles = NULL;
+    queue->positions = NULL;
+    queue->scratch = malloc(data_size);
+
+    ReturnArray heap = Array_create(data_size, capacity);
+    queue->heap = heap.arr;
+    result.error = heap.error;
+
+    if (indexed && result.error == NO_ERROR) {
+        ReturnArray handles = Array_create(sizeof(size_t), capacity);
+        ReturnArray positions = Array_create(sizeof(size_t), capacity);
+        queue->handles = handles.arr;
+        queue->positions = positions.arr;
+        result.error =
+            handles.error != NO_ERROR ? handles.error : positions.error;
+    }
+
+    if (result.error == NO_ERROR && queue->scratch == NULL) {
+        result.error = ERROR_ALLOCATION;
+    }
+
+    if (result.error != NO_ERROR) {
+        PriorityQueue_destroy(&queue);
+        return result;
+    }
+
+    result.queue = queue;
+    return result;
+}
+
+ReturnPriorityQueue PriorityQueue_create(size_t data_size,
+                                         CompareFunction compare,
+                                         size_t arity) {
+    return create(data_size, compare, arity, PRIORITY_QUEUE_INITIAL_CAPACITY,
+                  false);
+}
+
+ReturnPriorityQueue PriorityQueue_create_indexed(size_t data_size,
+                                                 CompareFunction compare,
+                                                 size_t arity) {
+    return create(data_size, compare, arity, PRIORITY_QUEUE_INITIAL_CAPACITY,
+                  true);
+}
+
+ReturnPriorityQueue PriorityQueue_heapify(const Array* arr,
+                                          CompareFunction compare,
+                                          size_t arity) {
+    ReturnPriorityQueue result = {.error = NO_ERROR, .queue = NULL};
+
+    if (arr == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result = create(arr->data_size, compare, arity,
+                    arr->size > 0 ? arr->size : 1, false);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    PriorityQueue* queue = result.queue;
+    size_t size = arr->size;
+    if (size < 2) {
+        if (size == 1) {
+            memcpy(queue->heap->data, arr->data, arr->data_size);
+            queue->heap->size = 1;
+        }
+        return result;
+    }
+    memcpy(queue->heap->data, arr->data, size * arr->data_size);
+    queue->heap->size = size;
+
+    // Every subtree below a parent is a heap by the time the parent is
+    // sifted, and most nodes are leaves that need no work at all
+    for (size_t slot = (size - 2) / arity + 1; slot-- > 0;) {
+        memcpy(queue->scratch, slot_at(queue, slot), arr->data_size);
+        sift_down(queue, slot, SIZE_MAX);
+    }
+
+    return result;
+}
+
+ReturnError PriorityQueue_destroy(PriorityQueue** queue) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (queue == NULL || *queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if ((*queue)->heap != NULL) {
+        Array_destroy(&(*queue)->heap);
+    }
+    if ((*queue)->handles != NULL) {
+        Array_destroy(&(*queue)->handles);
+    }
+    if ((*queue)->positions != NULL) {
+        Array_destroy(&(*queue)->positions);
+    }
+    free((*queue)->scratch);
+    free(*queue);
+    *queue = NULL;
+
+    return result;
+}
+
+ReturnSizeT PriorityQueue_size(const PriorityQueue* queue) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = 0};
+
+    if (queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.value = queue->heap->size;
+    return result;
+}
+
+ReturnBool PriorityQueue_is_empty(const PriorityQueue* queue) {
+    ReturnBool result = {.error = NO_ERROR, .value = false};
+
+    if (queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.value = queue->heap->size == 0;
+    return result;
+}
+
+ReturnError PriorityQueue_clear(PriorityQueue* queue) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    queue->heap->size = 0;
+    if (queue->handles != NULL) {
+        queue->handles->size = 0;
+        queue->positions->size = 0;
+    }
+    return result;
+}
+
+ReturnView PriorityQueue_peek(const PriorityQueue* queue) {
+    ReturnView result = {.error = NO_ERROR, .value = {0, NULL}};
+
+    if (queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (queue->heap->size == 0) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    result.value.size = queue->heap->data_size;
+    result.value.data = slot_at(queue, 0);
+
+    return result;
+}
+
+ReturnSizeT PriorityQueue_push(PriorityQueue* queue, T* element) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = SIZE_MAX};
+
+    if (queue == NULL || element == NULL || element->data == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (element->size != queue->heap->data_size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    // Append a copy, element may be a view into the heap the append moves
+    memmove(queue->scratch, element->data, queue->heap->data_size);
+
+    size_t slot = queue->heap->size;
+    ReturnError appended = Array_append(
+        queue->heap, &(T){queue->heap->data_size, queue->scratch});
+    if (appended.error != NO_ERROR) {
+        result.error = appended.error;
+        return result;
+    }
+
+    if (queue->handles != NULL) {
+        if (slot < queue->handles->size) {
+            // Reuse the free handle parked just past the heap
+            result.value = *handle_at(queue, slot);
+        } else {
+            result.value = queue->handles->size;
+            appended = Array_append(queue->handles,
+                                    &(T){sizeof(size_t), &result.value});
+            if (appended.error == NO_ERROR) {
+                appended = Array_append(queue->positions,
+                                        &(T){sizeof(size_t), &slot});
+                if (appended.error != NO_ERROR) {
+                    queue->handles->size--;
+                }
+            }
+            if (appended.error != NO_ERROR) {
+                queue->heap->size--;
+                result.error = appended.error;
+                result.value = SIZE_MAX;
+                return result;
+            }
+        }
+    }
+
+    sift_up(queue, slot, result.value);
+    return result;
+}
+
+ReturnError PriorityQueue_pop(PriorityQueue* queue, T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (!valid_out(queue, out)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    if (queue->heap->size == 0) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    if (out != NULL) {
+        memmove(out->data, slot_at(queue, 0), queue->heap->data_size);
+    }
+
+    // The last element fills the hole at the top and sinks from there
+    size_t last = --queue->heap->size;
+    memcpy(queue->scratch, slot_at(queue, last), queue->heap->data_size);
+
+    size_t handle = SIZE_MAX;
+    if (queue->handles != NULL) {
+        size_t top = *handle_at(queue, 0);
+        handle = *handle_at(queue, last);
+        *handle_at(queue, last) = top;
+        *position_of(queue, top) = last;
+    }
+
+    if (last > 0) {
+        sift_down(queue, 0, handle);
+    }
+    return result;
+}
+
+ReturnError PriorityQueue_push_pop(PriorityQueue* queue, T* element,
+                                   T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (queue == NULL || element == NULL || element->data == NULL ||
+        out == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (queue->handles != NULL || element->size != queue->heap->data_size ||
+        !valid_out(queue, out)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    memmove(queue->scratch, element->data, queue->heap->data_size);
+
+    // An element that would come out first skips the heap entirely
+    if (queue->heap->size == 0 ||
+        !before(queue, slot_at(queue, 0), queue->scratch)) {
+        memmove(out->data, queue->scratch, queue->heap->data_size);
+        return result;
+    }
+
+    memmove(out->data, slot_at(queue, 0), queue->heap->data_size);
+    sift_down(queue, 0, SIZE_MAX);
+    return result;
+}
+
+ReturnError PriorityQueue_replace(PriorityQueue* queue, T* element, T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (queue == NULL || element == NULL || element->data == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (queue->handles != NULL || element->size != queue->heap->data_size ||
+        !valid_out(queue, out)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    if (queue->heap->size == 0) {
+        result.error = ERROR_INDEX;
+        return result;
+    }
+
+    memmove(queue->scratch, element->data, queue->heap->data_size);
+    if (out != NULL) {
+        memmove(out->data, slot_at(queue, 0), queue->heap->data_size);
+    }
+    sift_down(queue, 0, SIZE_MAX);
+    return result;
+}
+
+// Slot of a live handle, or SIZE_MAX
+static size_t find_handle(const PriorityQueue* queue, size_t handle) {
+    if (queue->handles == NULL || handle >= queue->positions->size) {
+        return SIZE_MAX;
+    }
+    size_t slot = *position_of(queue, handle);
+    return slot < queue->heap->size ? slot : SIZE_MAX;
+}
+
+ReturnView PriorityQueue_get(const PriorityQueue* queue, size_t handle) {
+    ReturnView result = {.error = NO_ERROR, .value = {0, NULL}};
+
+    if (queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    size_t slot = find_handle(queue, handle);
+    if (slot == SIZE_MAX) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    result.value.size = queue->heap->data_size;
+    result.value.data = slot_at(queue, slot);
+
+    return result;
+}
+
+ReturnError PriorityQueue_decrease_key(PriorityQueue* queue, size_t handle,
+                                       T* element) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (queue == NULL || element == NULL || element->data == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (element->size != queue->heap->data_size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    size_t slot = find_handle(queue, handle);
+    if (slot == SIZE_MAX) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    if (before(queue, slot_at(queue, slot), element->data)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    memmove(queue->scratch, element->data, queue->heap->data_size);
+    sift_up(queue, slot, handle);
+    return result;
+}
+
+ReturnError PriorityQueue_remove(PriorityQueue* queue, size_t handle,
+                                 T* out) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (queue == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (!valid_out(queue, out)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    size_t slot = find_handle(queue, handle);
+    if (slot == SIZE_MAX) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    if (out != NULL) {
+        memmove(out->data, slot_at(queue, slot), queue->heap->data_size);
+    }
+
+    // Park the handle past the heap and fill its slot with the last element
+    size_t last = --queue->heap->size;
+    if (slot == last) {
+        return result;
+    }
+    size_t moved = *handle_at(queue, last);
+    memcpy(queue->scratch, slot_at(queue, last), queue->heap->data_size);
+    *handle_at(queue, last) = handle;
+    *position_of(queue, handle) = last;
+
+    // The last element may belong above or below the hole
+    if (slot > 0 && before(queue, queue->scratch,
+                           slot_at(queue, (slot - 1) / queue->arity))) {
+        sift_up(queue, slot, moved);
+    } else {
+        sift_down(queue, slot, moved);
+    }
+    return result;
+}
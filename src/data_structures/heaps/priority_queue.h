@@ -0,0 +1,225 @@
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../arrays/array.h"
+
+/**
+ * @brief Priority queue of fixed size elements kept as an implicit heap in an
+ * Array.
+ *
+ * The element that compare orders first is always at the top, so this is a
+ * min heap; pass a reversed CompareFunction for a max heap. Each node has 2
+ * or 4 children. With 4 the heap is half as deep and the children of a node
+ * usually share a cache line, which makes pops cheaper on large queues.
+ *
+ * An indexed queue also hands out a handle for every element it holds, which
+ * stays valid until the element leaves the queue and lets decrease_key and
+ * remove find the element without searching.
+ */
+typedef struct PriorityQueue {
+    Array* heap;              ///< Elements in heap order
+    CompareFunction compare;  ///< Order, the first element is popped first
+    size_t arity;             ///< Children per node, 2 or 4
+    void* scratch;            ///< data_size bytes for the element being moved
+    Array* handles;           ///< Handle of each slot, NULL unless indexed
+    Array* positions;         ///< Slot of each handle, NULL unless indexed
+} PriorityQueue;
+
+typedef struct ReturnPriorityQueueType {
+    ErrorCode error;
+    PriorityQueue* queue;
+} ReturnPriorityQueue;
+
+/**
+ * @brief Creates a new, empty PriorityQueue.
+ *
+ * @param data_size Size of each element in bytes.
+ * @param compare Order of the elements, the first one is popped first.
+ * @param arity Children per node, 2 or 4.
+ *
+ * @return ReturnPriorityQueue will either return an ErrorCode or a
+ * PriorityQueue*
+ */
+ReturnPriorityQueue PriorityQueue_create(size_t data_size,
+                                         CompareFunction compare,
+                                         size_t arity);
+
+/**
+ * @brief Creates a new, empty PriorityQueue that hands out a handle for every
+ * element pushed.
+ *
+ * @param data_size Size of each element in bytes.
+ * @param compare Order of the elements, the first one is popped first.
+ * @param arity Children per node, 2 or 4.
+ *
+ * @return ReturnPriorityQueue will either return an ErrorCode or a
+ * PriorityQueue*
+ */
+ReturnPriorityQueue PriorityQueue_create_indexed(size_t data_size,
+                                                 CompareFunction compare,
+                                                 size_t arity);
+
+/**
+ * @brief Builds a PriorityQueue from the elements of an Array in O(n).
+ *
+ * The elements are copied and arranged bottom up, which is cheaper than
+ * pushing them one at a time. The Array is left untouched.
+ *
+ * @param arr Pointer to the Array.
+ * @param compare Order of the elements, the first one is popped first.
+ * @param arity Children per node, 2 or 4.
+ *
+ * @return ReturnPriorityQueue will either return an ErrorCode or a
+ * PriorityQueue*
+ */
+ReturnPriorityQueue PriorityQueue_heapify(const Array* arr,
+                                          CompareFunction compare,
+                                          size_t arity);
+
+/**
+ * @brief Destroys a PriorityQueue and frees associated memory.
+ *
+ * @param queue Pointer to the PriorityQueue to be destroyed.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError PriorityQueue_destroy(PriorityQueue** queue);
+
+/**
+ * @brief Returns the number of elements in the PriorityQueue.
+ *
+ * @param queue Pointer to the PriorityQueue.
+ *
+ * @return ReturnSizeT will either return an ErrorCode or a size_t
+ */
+ReturnSizeT PriorityQueue_size(const PriorityQueue* queue);
+
+/**
+ * @brief Checks if the PriorityQueue is empty.
+ *
+ * @param queue Pointer to the PriorityQueue.
+ *
+ * @return ReturnBool will either return an ErrorCode or a bool
+ */
+ReturnBool PriorityQueue_is_empty(const PriorityQueue* queue);
+
+/**
+ * @brief Removes every element. Every handle becomes invalid.
+ *
+ * @param queue Pointer to the PriorityQueue.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError PriorityQueue_clear(PriorityQueue* queue);
+
+/**
+ * @brief Gets the element that would be popped next.
+ *
+ * @param queue Pointer to the PriorityQueue.
+ *
+ * @return ReturnView with a view of the element inside the PriorityQueue,
+ * ERROR_INDEX if it is empty. The view is valid until the next call that
+ * changes the PriorityQueue and must not be changed.
+ */
+ReturnView PriorityQueue_peek(const PriorityQueue* queue);
+
+/**
+ * @brief Adds an element in O(log n).
+ *
+ * @param queue Pointer to the PriorityQueue.
+ * @param element Pointer to the element, its size must be data_size.
+ *
+ * @return ReturnSizeT with the handle of the element in an indexed queue, or
+ * SIZE_MAX otherwise.
+ */
+ReturnSizeT PriorityQueue_push(PriorityQueue* queue, T* element);
+
+/**
+ * @brief Removes the top element in O(log n).
+ *
+ * @param queue Pointer to the PriorityQueue.
+ * @param out GenericDataType of data_size bytes the element is copied to, may
+ * be NULL.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_INDEX if the PriorityQueue is empty.
+ */
+ReturnError PriorityQueue_pop(PriorityQueue* queue, T* out);
+
+/**
+ * @brief Pushes an element and then pops the top, in a single sift.
+ *
+ * If element would be popped first it never enters the heap at all. Not
+ * available on indexed queues.
+ *
+ * @param queue Pointer to the PriorityQueue.
+ * @param element Pointer to the element, its size must be data_size.
+ * @param out GenericDataType of data_size bytes the popped element is copied
+ * to.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError PriorityQueue_push_pop(PriorityQueue* queue, T* element, T* out);
+
+/**
+ * @brief Pops the top and then pushes an element, in a single sift.
+ *
+ * Unlike push_pop the popped element is always the old top, even if element
+ * would come before it. Not available on indexed queues.
+ *
+ * @param queue Pointer to the PriorityQueue.
+ * @param element Pointer to the element, its size must be data_size.
+ * @param out GenericDataType of data_size bytes the popped element is copied
+ * to, may be NULL.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_INDEX if the PriorityQueue is empty.
+ */
+ReturnError PriorityQueue_replace(PriorityQueue* queue, T* element, T* out);
+
+/**
+ * @brief Gets the element of a handle in an indexed queue.
+ *
+ * @param queue Pointer to the PriorityQueue.
+ * @param handle Handle returned by PriorityQueue_push.
+ *
+ * @return ReturnView with a view of the element, which must not be changed,
+ * or ERROR_NOT_FOUND if the handle is not in the queue.
+ */
+ReturnView PriorityQueue_get(const PriorityQueue* queue, size_t handle);
+
+/**
+ * @brief Replaces the element of a handle with one that is ordered no later,
+ * moving it towards the top in O(log n).
+ *
+ * @param queue Pointer to the indexed PriorityQueue.
+ * @param handle Handle returned by PriorityQueue_push.
+ * @param element The new element, its size must be data_size.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_NOT_FOUND if the handle is not in the queue and ERROR if element is
+ * ordered after the current one.
+ */
+ReturnError PriorityQueue_decrease_key(PriorityQueue* queue, size_t handle,
+                                       T* element);
+
+/**
+ * @brief Removes the element of a handle from an indexed queue in O(log n).
+ *
+ * @param queue Pointer to the indexed PriorityQueue.
+ * @param handle Handle returned by PriorityQueue_push.
+ * @param out GenericDataType of data_size bytes the element is copied to, may
+ * be NULL.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_NOT_FOUND if the handle is not in the queue.
+ */
+ReturnError PriorityQueue_remove(PriorityQueue* queue, size_t handle, T* out);
+
+#endif
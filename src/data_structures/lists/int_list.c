@@ -1,5 +1,7 @@
 #include "int_list.h"
 
+#include "list_sort.h"
+
 /**
  * @brief Creates a new list.
  * @return List*: Pointer to the newly created list, NULL if memory
@@ -69,9 +71,9 @@ size_t IntList_find(List* list, int element) {
  * out of bounds.
  */
 int IntList_get(List* list, size_t index) {
-    ListNode* temp = List_get(list, index);
+    int* temp = (int*)List_get_data(list, index);
     if (temp != NULL) {
-        return *((int*)(temp->data));
+        return *temp;
     }
 
     /**
@@ -107,24 +109,20 @@ void IntList_swap(List* list, size_t index_a, size_t index_b) {
     List_swap(list, index_a, index_b);
 }
 
-static int __compare(const ListNode* a, const ListNode* b) {
-    int value_a = *((int*)(a->data));
-    int value_b = *((int*)(b->data));
+#define INT_IN_ORDER(a, b, compare)          \
+    (*((const int*)ListNode_const_data(a)) <= \
+     *((const int*)ListNode_const_data(b)))
 
-    if (value_a < value_b) {
-        return -1;
-    } else if (value_a > value_b) {
-        return 1;
-    } else {
-        return 0;
-    }
-}
+LIST_DEFINE_MERGE_SORT(int_merge_sort, INT_IN_ORDER)
+
+#undef INT_IN_ORDER
 
 /**
- * @brief Sorts the linked list using QuickSort algorithm.
+ * @brief Sorts the linked list in ascending order with a stable bottom-up
+ * merge sort that only relinks nodes.
  * @param list: Pointer to the linked list.
  */
-void IntList_sort(List* list) { List_sort(list, __compare); }
+void IntList_sort(List* list) { int_merge_sort(list, NULL); }
 
 static void __print(const void* element) { printf("%d ", *((int*)element)); }
 
@@ -110,9 +110,9 @@ void IntList_swap(List* list, size_t index_a, size_t index_b);
 typedef int (*ListNodeCompareFunction)(const ListNode* a, const ListNode* b);
 
 /**
- * @brief Sorts the linked list using QuickSort algorithm.
+ * @brief Sorts the linked list in ascending order with a stable bottom-up
+ * merge sort that only relinks nodes.
  * @param list: Pointer to the linked list.
- * @param compare: Function pointer to a comparison function for sorting.
  */
 void IntList_sort(List* list);
 
@@ -1,5 +1,101 @@
 #include "list.h"
 
+#include "list_sort.h"
+
+#define LIST_POOL_ALIGNMENT _Alignof(max_align_t)
+#define LIST_POOL_FIRST_CHUNK_SLOTS 32
+#define LIST_POOL_MAX_CHUNK_SLOTS 4096
+
+#define LIST_POOL_ROUND_UP(bytes)                                \
+    (((bytes) + LIST_POOL_ALIGNMENT - 1) / LIST_POOL_ALIGNMENT * \
+     LIST_POOL_ALIGNMENT)
+
+// Bytes in front of the slots of a chunk
+#define LIST_POOL_CHUNK_HEADER LIST_POOL_ROUND_UP(sizeof(ListPoolChunk))
+
+// Header at the start of every chunk
+typedef struct ListPoolChunk {
+    struct ListPoolChunk* next; /**< Previously allocated chunk. */
+    size_t bytes;               /**< Size of the whole chunk. */
+} ListPoolChunk;
+
+static void pool_init(ListNodePool* pool, size_t data_size) {
+    pool->slot_size = LIST_POOL_ROUND_UP(offsetof(ListNode, data) + data_size);
+    pool->chunk_slots = LIST_POOL_FIRST_CHUNK_SLOTS;
+    pool->chunks = NULL;
+    pool->oldest_chunk = NULL;
+    pool->free_list = NULL;
+    pool->free_tail = NULL;
+    pool->unused = NULL;
+    pool->unused_slots = 0;
+}
+
+// Frees every chunk at once, nodes inside them are not visited
+static void pool_release(List* list) {
+    ListNodePool* pool = &list->pool;
+    ListPoolChunk* chunk = (ListPoolChunk*)pool->chunks;
+
+    while (chunk != NULL) {
+        ListPoolChunk* next = chunk->next;
+        Allocator_free(&list->allocator, chunk, chunk->bytes);
+        chunk = next;
+    }
+
+    pool_init(pool, list->data_size);
+}
+
+static ListNode* pool_take(List* list) {
+    ListNodePool* pool = &list->pool;
+
+    // Reuse a removed node first
+    if (pool->free_list != NULL) {
+        ListNode* node = pool->free_list;
+        pool->free_list = node->next;
+        if (pool->free_list == NULL) {
+            pool->free_tail = NULL;
+        }
+        return node;
+    }
+
+    // Start a new chunk once the newest one is used up, each one twice as
+    // large as the last up to a cap
+    if (pool->unused_slots == 0) {
+        size_t bytes =
+            LIST_POOL_CHUNK_HEADER + pool->chunk_slots * pool->slot_size;
+        ListPoolChunk* chunk =
+            (ListPoolChunk*)Allocator_alloc(&list->allocator, bytes);
+        if (chunk == NULL) {
+            return (ListNode*)NULL;
+        }
+
+        chunk->next = (ListPoolChunk*)pool->chunks;
+        chunk->bytes = bytes;
+        if (pool->chunks == NULL) {
+            pool->oldest_chunk = chunk;
+        }
+        pool->chunks = chunk;
+        pool->unused = (char*)chunk + LIST_POOL_CHUNK_HEADER;
+        pool->unused_slots = pool->chunk_slots;
+
+        if (pool->chunk_slots < LIST_POOL_MAX_CHUNK_SLOTS) {
+            pool->chunk_slots *= 2;
+        }
+    }
+
+    ListNode* node = (ListNode*)pool->unused;
+    pool->unused += pool->slot_size;
+    pool->unused_slots--;
+    return node;
+}
+
+static void pool_give_back(List* list, ListNode* node) {
+    node->next = list->pool.free_list;
+    if (list->pool.free_list == NULL) {
+        list->pool.free_tail = node;
+    }
+    list->pool.free_list = node;
+}
+
 /**
  * @brief Creates a new list.
  * @param data_size: The data size of the elements to be included in this list.
@@ -7,60 +103,95 @@
  * allocation fails.
  */
 List* List_create(size_t data_size) {
-    List* new_list = (List*)malloc(sizeof(List));
+    return List_create_with_allocator(data_size, NULL);
+}
+
+/**
+ * @brief Creates a new list whose memory comes from a custom allocator.
+ * @param data_size: The data size of the elements to be included in this list.
+ * @param allocator: Allocator for the list and its node chunks. It is copied
+ * into the list; NULL uses the standard library.
+ * @return List*: Pointer to the newly created list, NULL if memory
+ * allocation fails.
+ */
+List* List_create_with_allocator(size_t data_size, const Allocator* allocator) {
+    List* new_list = (List*)Allocator_alloc(allocator, sizeof(List));
     if (new_list == NULL) {
         return (List*)NULL;
     }
 
-    new_list->head = (ListNode**)malloc(sizeof(List*));
+    new_list->head = (ListNode**)Allocator_alloc(allocator, sizeof(ListNode*));
     if (new_list->head == NULL) {
-        free(new_list);
+        Allocator_free(allocator, new_list, sizeof(List));
         return (List*)NULL;
     }
 
+    // Keep a copy of the allocator, a zeroed one means the standard library
+    if (allocator != NULL) {
+        new_list->allocator = *allocator;
+    } else {
+        memset(&new_list->allocator, 0, sizeof(Allocator));
+    }
+
+    *(new_list->head) = NULL;
+    new_list->tail = NULL;
     new_list->data_size = data_size;
     new_list->size = 0;
+    pool_init(&new_list->pool, data_size);
 
     return new_list;
 }
 
-static ListNode* create_node(void* element, size_t data_size) {
-    ListNode* new_node = (ListNode*)malloc(sizeof(ListNode));
+static ListNode* create_node(List* list, void* element) {
+    ListNode* new_node = pool_take(list);
     if (new_node == NULL) {
         return (ListNode*)NULL;
     }
 
-    new_node->data = malloc(data_size);
-    if (new_node->data == NULL) {
-        free(new_node);
-        return (ListNode*)NULL;
-    }
-
-    memcpy(new_node->data, element, data_size);
+    memcpy(new_node->data, element, list->data_size);
     new_node->next = NULL;
     return new_node;
 }
 
+// Links node right after previous, or in front of the head if previous is NULL
+static void link_after(List* list, ListNode* previous, ListNode* node) {
+    ListNode** link = previous != NULL ? &previous->next : list->head;
+    node->next = *link;
+    *link = node;
+    if (node->next == NULL) {
+        list->tail = node;
+    }
+    list->size++;
+}
+
+// Unlinks the node right after previous, or the head if previous is NULL, and
+// returns the node that took its place
+static ListNode* unlink_after(List* list, ListNode* previous) {
+    ListNode** link = previous != NULL ? &previous->next : list->head;
+    ListNode* node = *link;
+    *link = node->next;
+    if (list->tail == node) {
+        list->tail = previous;
+    }
+    pool_give_back(list, node);
+    list->size--;
+    return *link;
+}
+
 /**
  * @brief clears the contents of the list
  * @param list: Pointer to the linked list.
  */
 void List_clear(List* list) {
-    if (list == NULL || list->head == NULL || *(list->head) == NULL) {
+    if (list == NULL || list->head == NULL) {
         return;
     }
 
-    ListNode* current = *(list->head);
-    ListNode* next;
-
-    while (current != NULL) {
-        next = current->next;
-        free(current->data);
-        free(current);
-        current = next;
-    }
+    // Every node lives in a pool chunk, so dropping the chunks frees them all
+    pool_release(list);
 
     *(list->head) = NULL;
+    list->tail = NULL;
     list->size = 0;
 }
 
@@ -75,7 +206,10 @@ void List_destroy(List** list) {
 
     List_clear(*list);
 
-    free(*list);
+    // Copy the allocator out, it lives inside the block being freed
+    Allocator allocator = (*list)->allocator;
+    Allocator_free(&allocator, (*list)->head, sizeof(ListNode*));
+    Allocator_free(&allocator, *list, sizeof(List));
     *list = NULL;
 }
 
@@ -100,29 +234,24 @@ size_t List_size(List* list) {
  * @param index: Index at which the element needs to be inserted.
  */
 void List_insert(List* list, void* element, size_t index) {
-    if (list == NULL) {
+    if (list == NULL || index > list->size) {
         return;
     }
 
-    ListNode* new_node = create_node(element, list->data_size);
+    ListNode* new_node = create_node(list, element);
 
     if (new_node == NULL) {
         return;
     }
 
-    if (List_size(list) == 0) {
-        *(list->head) = new_node;
-    } else {
-        if (index == 0) {
-            new_node->next = *(list->head);
-            *(list->head) = new_node;
-        } else {
-            ListNode* prev = List_get(list, index - 1);
-            new_node->next = prev->next;
-            prev->next = new_node;
-        }
+    // Appending links after the tail without a walk
+    ListNode* previous = NULL;
+    if (index == list->size) {
+        previous = list->tail;
+    } else if (index > 0) {
+        previous = List_get(list, index - 1);
     }
-    list->size++;
+    link_after(list, previous, new_node);
 }
 
 /**
@@ -141,6 +270,141 @@ void List_append(List* list, void* element) {
     List_insert(list, element, List_size(list));
 }
 
+static bool same_allocator(const Allocator* a, const Allocator* b) {
+    return a->alloc == b->alloc && a->realloc == b->realloc &&
+           a->free == b->free && a->context == b->context;
+}
+
+// Hands every chunk of src to dst so the nodes of src can be linked into dst.
+// The removed nodes of src join the freelist of dst. Of the two runs of never
+// used slots the longer one is kept and the other one is put on the freelist
+// too, which is bounded by LIST_POOL_MAX_CHUNK_SLOTS, so this takes constant
+// time and no slot is left stranded.
+static void pool_transfer(List* dst, List* src) {
+    ListNodePool* to = &dst->pool;
+    ListNodePool* from = &src->pool;
+
+    if (from->chunks != NULL) {
+        // Keep the newest chunk of dst at the front for pool_take
+        if (to->chunks == NULL) {
+            to->chunks = from->chunks;
+        } else {
+            ((ListPoolChunk*)to->oldest_chunk)->next =
+                (ListPoolChunk*)from->chunks;
+        }
+        to->oldest_chunk = from->oldest_chunk;
+    }
+
+    if (from->free_list != NULL) {
+        from->free_tail->next = to->free_list;
+        if (to->free_list == NULL) {
+            to->free_tail = from->free_tail;
+        }
+        to->free_list = from->free_list;
+    }
+
+    char* spare = from->unused;
+    size_t spare_slots = from->unused_slots;
+    if (spare_slots > to->unused_slots) {
+        spare = to->unused;
+        spare_slots = to->unused_slots;
+        to->unused = from->unused;
+        to->unused_slots = from->unused_slots;
+    }
+    for (size_t i = 0; i < spare_slots; i++) {
+        pool_give_back(dst, (ListNode*)(spare + i * to->slot_size));
+    }
+
+    pool_init(from, src->data_size);
+}
+
+// Links the chain first..last of count nodes into dst so first ends up at
+// index, which must not be past the end of dst
+static void link_chain(List* dst, size_t index, ListNode* first,
+                       ListNode* last, size_t count) {
+    if (index == dst->size) {
+        if (dst->tail != NULL) {
+            dst->tail->next = first;
+        } else {
+            *(dst->head) = first;
+        }
+        last->next = NULL;
+        dst->tail = last;
+    } else if (index == 0) {
+        last->next = *(dst->head);
+        *(dst->head) = first;
+    } else {
+        ListNode* prev = List_get(dst, index - 1);
+        last->next = prev->next;
+        prev->next = first;
+    }
+
+    dst->size += count;
+}
+
+/**
+ * @brief Moves every node of src into dst at the specified index without
+ * copying data.
+ * @param dst: Pointer to the list receiving the nodes.
+ * @param index: Index in dst the first node of src will end up at.
+ * @param src: Pointer to the list giving up its nodes.
+ */
+void List_splice(List* dst, size_t index, List* src) {
+    if (dst == NULL || src == NULL || dst == src || dst->head == NULL ||
+        src->head == NULL || dst->data_size != src->data_size ||
+        index > dst->size) {
+        return;
+    }
+
+    if (src->size == 0) {
+        return;
+    }
+
+    // Nodes can only change lists if their chunks can go with them, so copy
+    // src into a chain of nodes of dst first. If dst runs out of memory both
+    // lists are left as they were.
+    if (!same_allocator(&dst->allocator, &src->allocator)) {
+        ListNode* first = NULL;
+        ListNode* last = NULL;
+        ListNode** link = &first;
+        for (ListNode* current = *(src->head); current != NULL;
+             current = current->next) {
+            ListNode* node = create_node(dst, ListNode_data(current));
+            if (node == NULL) {
+                while (first != NULL) {
+                    ListNode* next = first->next;
+                    pool_give_back(dst, first);
+                    first = next;
+                }
+                return;
+            }
+            *link = node;
+            link = &node->next;
+            last = node;
+        }
+
+        link_chain(dst, index, first, last, src->size);
+        List_clear(src);
+        return;
+    }
+
+    link_chain(dst, index, *(src->head), src->tail, src->size);
+    pool_transfer(dst, src);
+
+    *(src->head) = NULL;
+    src->tail = NULL;
+    src->size = 0;
+}
+
+/**
+ * @brief Moves every node of src to the end of dst without copying data.
+ * @param dst: Pointer to the list receiving the nodes.
+ * @param src: Pointer to the list giving up its nodes.
+ */
+void List_concat(List* dst, List* src) {
+    List_splice(dst, List_size(dst), src);
+}
+
 /**
  * @brief Finds the index of the specified element in the linked list.
  * @param list: Pointer to the linked list.
@@ -180,6 +444,11 @@ ListNode* List_get(List* list, size_t index) {
         return (ListNode*)NULL;
     }
 
+    // The last node is always one step away
+    if (index + 1 == list->size) {
+        return list->tail;
+    }
+
     ListNode* current = *(list->head);
     size_t i = 0;
     while (current != NULL && i < index) {
@@ -195,32 +464,33 @@ ListNode* List_get(List* list, size_t index) {
 }
 
 /**
- * @brief Removes the node at the specified index from the linked list.
+ * @brief Retrieves the data stored at the specified index in the linked list.
  * @param list: Pointer to the linked list.
- * @param index: Index of the node to be removed.
+ * @param index: Index of the data to be retrieved.
+ * @return void*: Pointer to the data at the given index, NULL if index is out
+ * of bounds.
  */
-void List_remove(List* list, size_t index) {
-    if (list == NULL || list->head == NULL || *(list->head) == NULL) {
-        return;
+void* List_get_data(List* list, size_t index) {
+    ListNode* node = List_get(list, index);
+    if (node == NULL) {
+        return NULL;
     }
 
-    if (index == 0) {
-        ListNode* temp = *(list->head);
-        *(list->head) = (*(list->head))->next;
-        free(temp);
-        list->size--;
-        return;
-    }
+    return ListNode_data(node);
+}
 
-    ListNode* previous = List_get(list, index - 1);
-    if (previous == NULL) {
+/**
+ * @brief Removes the node at the specified index from the linked list.
+ * @param list: Pointer to the linked list.
+ * @param index: Index of the node to be removed.
+ */
+void List_remove(List* list, size_t index) {
+    if (list == NULL || list->head == NULL || index >= list->size) {
         return;
     }
 
-    ListNode* current = previous->next;
-    previous->next = current->next;
-    free(current);
-    list->size--;
+    ListNode* previous = index > 0 ? List_get(list, index - 1) : NULL;
+    unlink_after(list, previous);
 }
 
 /**
@@ -235,11 +505,136 @@ void List_iterate(List* list, void (*callback)(const void* element)) {
     }
     ListNode* current = *(list->head);
     while (current != NULL) {
-        callback(current->data);
+        callback(ListNode_data(current));
         current = current->next;
     }
 }
 
+/**
+ * @brief Iterates through the linked list, passing a context pointer to the
+ * callback and stopping as soon as it returns false.
+ * @param list: Pointer to the linked list.
+ * @param callback: Function to be called on each element in the list.
+ * @param context: Pointer passed through to every callback call.
+ * @return size_t: Number of elements the callback was called on.
+ */
+size_t List_iterate_ctx(List* list,
+                        bool (*callback)(void* element, void* context),
+                        void* context) {
+    size_t visited = 0;
+    if (list == NULL || list->head == NULL || callback == NULL) {
+        return visited;
+    }
+
+    ListNode* current = *(list->head);
+    while (current != NULL) {
+        visited++;
+        if (!callback(ListNode_data(current), context)) {
+            break;
+        }
+        current = current->next;
+    }
+    return visited;
+}
+
+/**
+ * @brief Creates a cursor positioned on the first node of the list.
+ * @param list: Pointer to the linked list.
+ * @return ListCursor: The cursor, at the end already if the list is empty.
+ */
+ListCursor List_cursor(List* list) {
+    ListCursor cursor = {list, NULL, NULL};
+    if (list != NULL && list->head != NULL) {
+        cursor.current = *(list->head);
+    }
+    return cursor;
+}
+
+/**
+ * @brief Checks whether the cursor has moved past the last node.
+ * @param cursor: Pointer to the cursor.
+ * @return bool: true if there is no current node.
+ */
+bool ListCursor_at_end(const ListCursor* cursor) {
+    return cursor == NULL || cursor->current == NULL;
+}
+
+/**
+ * @brief Returns the data of the node under the cursor.
+ * @param cursor: Pointer to the cursor.
+ * @return void*: Pointer to the node's data, NULL at the end of the list.
+ */
+void* ListCursor_get(const ListCursor* cursor) {
+    if (ListCursor_at_end(cursor)) {
+        return NULL;
+    }
+    return ListNode_data(cursor->current);
+}
+
+/**
+ * @brief Moves the cursor to the next node.
+ * @param cursor: Pointer to the cursor.
+ * @return bool: true if the cursor is on a node afterwards.
+ */
+bool ListCursor_next(ListCursor* cursor) {
+    if (ListCursor_at_end(cursor)) {
+        return false;
+    }
+    cursor->previous = cursor->current;
+    cursor->current = cursor->current->next;
+    return cursor->current != NULL;
+}
+
+/**
+ * @brief Inserts an element right after the node under the cursor. The cursor
+ * stays where it is.
+ * @param cursor: Pointer to the cursor.
+ * @param element: Element to be inserted.
+ */
+void ListCursor_insert_after(ListCursor* cursor, void* element) {
+    if (ListCursor_at_end(cursor) || element == NULL) {
+        return;
+    }
+
+    ListNode* new_node = create_node(cursor->list, element);
+    if (new_node == NULL) {
+        return;
+    }
+    link_after(cursor->list, cursor->current, new_node);
+}
+
+/**
+ * @brief Inserts an element right before the node under the cursor, or at the
+ * end of the list if the cursor is past the end. The cursor stays on the same
+ * node.
+ * @param cursor: Pointer to the cursor.
+ * @param element: Element to be inserted.
+ */
+void ListCursor_insert_before(ListCursor* cursor, void* element) {
+    if (cursor == NULL || cursor->list == NULL || element == NULL) {
+        return;
+    }
+
+    ListNode* new_node = create_node(cursor->list, element);
+    if (new_node == NULL) {
+        return;
+    }
+    link_after(cursor->list, cursor->previous, new_node);
+    cursor->previous = new_node;
+}
+
+/**
+ * @brief Removes the node under the cursor and moves the cursor to the node
+ * that followed it.
+ * @param cursor: Pointer to the cursor.
+ */
+void ListCursor_remove(ListCursor* cursor) {
+    if (ListCursor_at_end(cursor)) {
+        return;
+    }
+    cursor->current = unlink_after(cursor->list, cursor->previous);
+}
+
 /**
  * @brief Swaps the positions of two elements in the linked list.
  * @param list: Pointer to the linked list.
@@ -287,45 +682,30 @@ void List_swap(List* list, size_t index_a, size_t index_b) {
         ListNode* temp = curr_b->next;
         curr_b->next = curr_a->next;
         curr_a->next = temp;
-    }
-}
 
-static size_t partition(List* list, size_t low, size_t high,
-                        ListNodeCompareFunction compare) {
-    ListNode* pivot = List_get(list, high);
-    size_t i = low - 1;
-
-    for (size_t j = low; j < high; j++) {
-        if (compare(List_get(list, j), pivot) < 0) {
-            i++;
-            List_swap(list, i, j);
+        if (list->tail == curr_a) {
+            list->tail = curr_b;
+        } else if (list->tail == curr_b) {
+            list->tail = curr_a;
         }
     }
-    List_swap(list, i + 1, high);
-    return i + 1;
 }
 
-static void quick_sort(List* list, size_t low, size_t high,
-                       ListNodeCompareFunction compare) {
-    if (low < high) {
-        size_t pi = partition(list, low, high, compare);
+#define NODE_IN_ORDER(a, b, compare) ((compare)((a), (b)) <= 0)
 
-        if (pi > 0) {
-            quick_sort(list, low, pi - 1, compare);
-        }
+LIST_DEFINE_MERGE_SORT(merge_sort, NODE_IN_ORDER)
 
-        quick_sort(list, pi + 1, high, compare);
-    }
-}
+#undef NODE_IN_ORDER
 
 /**
- * @brief Sorts the linked list using QuickSort algorithm.
+ * @brief Sorts the linked list with a stable bottom-up merge sort that only
+ * relinks nodes.
  * @param list: Pointer to the linked list.
  * @param compare: Function pointer to a comparison function for sorting.
  */
 void List_sort(List* list, ListNodeCompareFunction compare) {
-    if (list == NULL || list->head == NULL || *(list->head) == NULL) {
+    if (list == NULL || compare == NULL) {
         return;
     }
-    quick_sort(list, 0, List_size(list) - 1, compare);
+    merge_sort(list, compare);
 }
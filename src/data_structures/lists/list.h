@@ -2,19 +2,61 @@
 #define LIST_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../common/data_types.h"
+
 /**
  * @brief Represents a node in a linked list containing generic data.
+ *
+ * The data is stored inline right after the link, data_size bytes of it as
+ * set on the owning list, so a node and its data share one allocation and
+ * small payloads share a cache line with the link. Use ListNode_data rather
+ * than touching the member directly.
  */
 typedef struct ListNode {
-    void* data;            /**< Pointer to the stored data in the node. */
     struct ListNode* next; /**< Pointer to the next node in the list. */
+    _Alignas(max_align_t) unsigned char data[]; /**< The stored data. */
 } ListNode;
 
+/**
+ * @brief Returns a pointer to the data stored in a node.
+ * @param node: Pointer to the node.
+ * @return void*: Pointer to the node's data.
+ */
+static inline void* ListNode_data(ListNode* node) { return node->data; }
+
+/**
+ * @brief Returns a read only pointer to the data stored in a node.
+ * @param node: Pointer to the node.
+ * @return const void*: Pointer to the node's data.
+ */
+static inline const void* ListNode_const_data(const ListNode* node) {
+    return node->data;
+}
+
+/**
+ * @brief Slab allocator the nodes of a list are carved out of.
+ *
+ * Each slot holds a node together with its inline data. Slots are handed out
+ * from large chunks and removed nodes go on a freelist for reuse, so only the
+ * chunks ever touch the list's allocator.
+ */
+typedef struct ListNodePool {
+    size_t slot_size;    /**< Bytes per slot, node plus data, aligned. */
+    size_t chunk_slots;  /**< Number of slots in the next chunk. */
+    void* chunks;        /**< Singly linked list of every chunk. */
+    void* oldest_chunk;  /**< Last chunk of that list, NULL if none. */
+    ListNode* free_list; /**< Removed nodes, linked through next. */
+    ListNode* free_tail; /**< Last node of free_list, NULL if empty. */
+    char* unused;        /**< First never used slot in the newest chunk. */
+    size_t unused_slots; /**< Never used slots left in the newest chunk. */
+} ListNodePool;
+
 /**
  * @brief Represents a linked list along with metadata.
  */
@@ -22,8 +64,25 @@ typedef struct List {
     size_t data_size; /**< Size of the data stored in each node. */
     size_t size;      /**< Current size of the linked list. */
     ListNode** head;  /**< Pointer to the pointer to the list's head node. */
+    ListNode* tail;   /**< Pointer to the list's last node, NULL if empty. */
+    Allocator allocator; /**< Where the list and its node chunks come from. */
+    ListNodePool pool;   /**< Slab the nodes are allocated from. */
 } List;
 
+/**
+ * @brief Position in a linked list that can be stepped, inserted at and removed
+ * from in constant time.
+ *
+ * The cursor remembers the node before the current one so that removing the
+ * current node or inserting before it needs no walk from the head. Changing
+ * the list other than through the cursor invalidates it.
+ */
+typedef struct ListCursor {
+    List* list;         /**< The list being walked. */
+    ListNode* previous; /**< Node before current, NULL at the head. */
+    ListNode* current;  /**< Node under the cursor, NULL past the end. */
+} ListCursor;
+
 /**
  * @brief Creates a new list.
  * @param data_size: The data size of the elements to be included in this list.
@@ -32,6 +91,16 @@ typedef struct List {
  */
 List* List_create(size_t data_size);
 
+/**
+ * @brief Creates a new list whose memory comes from a custom allocator.
+ * @param data_size: The data size of the elements to be included in this list.
+ * @param allocator: Allocator for the list and its node chunks. It is copied
+ * into the list; NULL uses the standard library.
+ * @return List*: Pointer to the newly created list, NULL if memory
+ * allocation fails.
+ */
+List* List_create_with_allocator(size_t data_size, const Allocator* allocator);
+
 /**
  * @brief clears the contents of the list
  * @param list: Pointer to the linked list.
@@ -56,7 +125,8 @@ size_t List_size(List* list);
  * the linked list.
  * @param list: Pointer to the linked list.
  * @param element: Element to be inserted.
- * @param index: Index at which the element needs to be inserted.
+ * @param index: Index at which the element needs to be inserted, nothing is
+ * inserted past the end of the list.
  */
 void List_insert(List* list, void* element, size_t index);
 
@@ -68,12 +138,37 @@ void List_insert(List* list, void* element, size_t index);
 void List_prepend(List* list, void* element);
 
 /**
- * @brief Inserts an element at the end of the linked list.
+ * @brief Inserts an element at the end of the linked list in constant time.
  * @param list: Pointer to the linked list.
  * @param element: Element to be inserted.
  */
 void List_append(List* list, void* element);
 
+/**
+ * @brief Moves every node of src to the end of dst without copying data.
+ *
+ * When both lists use the same allocator the node chunks of src are handed
+ * over to dst as well, with their free slots kept for reuse by dst, and the
+ * move takes constant time. Otherwise the elements are copied into new nodes
+ * of dst in O(size of src); if that runs out of memory both lists are left
+ * unchanged. On success src is left empty.
+ * @param dst: Pointer to the list receiving the nodes.
+ * @param src: Pointer to the list giving up its nodes.
+ */
+void List_concat(List* dst, List* src);
+
+/**
+ * @brief Moves every node of src into dst at the specified index without
+ * copying data.
+ *
+ * Costs O(index) to reach the insertion point plus the cost of List_concat.
+ * src is left empty.
+ * @param dst: Pointer to the list receiving the nodes.
+ * @param index: Index in dst the first node of src will end up at.
+ * @param src: Pointer to the list giving up its nodes.
+ */
+void List_splice(List* dst, size_t index, List* src);
+
 /**
  * @brief Finds the index of the specified element in the linked list.
  * @param list: Pointer to the linked list.
@@ -91,6 +186,15 @@ size_t List_find(List* list, void* element);
  */
 ListNode* List_get(List* list, size_t index);
 
+/**
+ * @brief Retrieves the data stored at the specified index in the linked list.
+ * @param list: Pointer to the linked list.
+ * @param index: Index of the data to be retrieved.
+ * @return void*: Pointer to the data at the given index, NULL if index is out
+ * of bounds.
+ */
+void* List_get_data(List* list, size_t index);
+
 /**
  * @brief Removes the node at the specified index from the linked list.
  * @param list: Pointer to the linked list.
@@ -106,6 +210,70 @@ void List_remove(List* list, size_t index);
  */
 void List_iterate(List* list, void (*callback)(const void* element));
 
+/**
+ * @brief Iterates through the linked list, passing a context pointer to the
+ * callback and stopping as soon as it returns false.
+ * @param list: Pointer to the linked list.
+ * @param callback: Function to be called on each element in the list.
+ * @param context: Pointer passed through to every callback call.
+ * @return size_t: Number of elements the callback was called on.
+ */
+size_t List_iterate_ctx(List* list,
+                        bool (*callback)(void* element, void* context),
+                        void* context);
+
+/**
+ * @brief Creates a cursor positioned on the first node of the list.
+ * @param list: Pointer to the linked list.
+ * @return ListCursor: The cursor, at the end already if the list is empty.
+ */
+ListCursor List_cursor(List* list);
+
+/**
+ * @brief Checks whether the cursor has moved past the last node.
+ * @param cursor: Pointer to the cursor.
+ * @return bool: true if there is no current node.
+ */
+bool ListCursor_at_end(const ListCursor* cursor);
+
+/**
+ * @brief Returns the data of the node under the cursor.
+ * @param cursor: Pointer to the cursor.
+ * @return void*: Pointer to the node's data, NULL at the end of the list.
+ */
+void* ListCursor_get(const ListCursor* cursor);
+
+/**
+ * @brief Moves the cursor to the next node.
+ * @param cursor: Pointer to the cursor.
+ * @return bool: true if the cursor is on a node afterwards.
+ */
+bool ListCursor_next(ListCursor* cursor);
+
+/**
+ * @brief Inserts an element right after the node under the cursor. The cursor
+ * stays where it is.
+ * @param cursor: Pointer to the cursor.
+ * @param element: Element to be inserted.
+ */
+void ListCursor_insert_after(ListCursor* cursor, void* element);
+
+/**
+ * @brief Inserts an element right before the node under the cursor, or at the
+ * end of the list if the cursor is past the end. The cursor stays on the same
+ * node.
+ * @param cursor: Pointer to the cursor.
+ * @param element: Element to be inserted.
+ */
+void ListCursor_insert_before(ListCursor* cursor, void* element);
+
+/**
+ * @brief Removes the node under the cursor and moves the cursor to the node
+ * that followed it.
+ * @param cursor: Pointer to the cursor.
+ */
+void ListCursor_remove(ListCursor* cursor);
+
 /**
  * @brief Swaps the positions of two elements in the linked list.
  * @param list: Pointer to the linked list.
@@ -132,7 +300,10 @@ void List_swap(List* list, size_t index_a, size_t index_b);
 typedef int (*ListNodeCompareFunction)(const ListNode* a, const ListNode* b);
 
 /**
- * @brief Sorts the linked list using QuickSort algorithm.
+ * @brief Sorts the linked list with a stable bottom-up merge sort.
+ *
+ * Takes O(n log n) comparisons and no extra memory. Nodes are relinked rather
+ * than payloads copied, so pointers to nodes and their data stay valid.
  * @param list: Pointer to the linked list.
  * @param compare: Function pointer to a comparison function for sorting.
  */
@@ -0,0 +1,72 @@
+#ifndef LIST_SORT_H
+#define LIST_SORT_H
+
+#include "list.h"
+
+/*
+ * Bottom-up merge sort over the nodes of a List, shared by List_sort and the
+ * typed lists. Runs of width 1, 2, 4, ... are merged pairwise in a single
+ * pass each by relinking next pointers, so the sort is stable, takes
+ * O(n log n) comparisons, needs no recursion or extra memory and never moves
+ * a payload.
+ *
+ * LIST_DEFINE_MERGE_SORT(name, in_order) defines
+ *     static void name(List* list, ListNodeCompareFunction compare);
+ * where in_order(a, b, compare) is an expression that is true when node a may
+ * stay in front of node b. Typed lists pass an expression that compares the
+ * payloads directly and ignores compare, so the comparison is inlined.
+ */
+
+#define LIST_DEFINE_MERGE_SORT(name, in_order)                               \
+    static void name(List* list, ListNodeCompareFunction compare) {         \
+        (void)compare;                                                       \
+        if (list == NULL || list->head == NULL || list->size < 2) {          \
+            return;                                                          \
+        }                                                                    \
+                                                                             \
+        for (size_t width = 1; width < list->size; width *= 2) {            \
+            ListNode* left = *(list->head);                                  \
+            ListNode** link = list->head;                                    \
+            ListNode* last = NULL;                                           \
+                                                                             \
+            while (left != NULL) {                                           \
+                /* The right run starts width nodes after the left one */    \
+                ListNode* right = left;                                      \
+                size_t left_size = 0;                                        \
+                while (right != NULL && left_size < width) {                 \
+                    right = right->next;                                     \
+                    left_size++;                                             \
+                }                                                            \
+                size_t right_size = width;                                   \
+                                                                             \
+                while (left_size > 0 || (right_size > 0 && right != NULL)) { \
+                    ListNode* next;                                          \
+                    if (left_size == 0) {                                    \
+                        next = right;                                        \
+                        right = right->next;                                 \
+                        right_size--;                                        \
+                    } else if (right_size == 0 || right == NULL ||           \
+                               (in_order(left, right, compare))) {           \
+                        /* Ties go left to keep the sort stable */           \
+                        next = left;                                         \
+                        left = left->next;                                   \
+                        left_size--;                                         \
+                    } else {                                                 \
+                        next = right;                                        \
+                        right = right->next;                                 \
+                        right_size--;                                        \
+                    }                                                        \
+                    *link = next;                                            \
+                    link = &next->next;                                      \
+                    last = next;                                             \
+                }                                                            \
+                                                                             \
+                left = right;                                                \
+            }                                                                \
+                                                                             \
+            *link = NULL;                                                    \
+            list->tail = last;                                               \
+        }                                                                    \
+    }
+
+#endif
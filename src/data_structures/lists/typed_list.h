@@ -0,0 +1,180 @@
+#ifndef TYPED_LIST_H
+#define TYPED_LIST_H
+
+#include <assert.h>
+
+#include "list.h"
+#include "list_sort.h"
+
+/*
+ * Typed linked lists generated by macro.
+ *
+ * DEFINE_LIST(name, type) defines a list type called name that holds
+ * elements of type. A name* is a List of sizeof(type) bytes per node under a
+ * distinct pointer type, so nodes still come from the List's slab and
+ * name_list hands it to any List function, e.g. List_concat or List_cursor.
+ * Every function is static inline and reads elements as type straight out of
+ * the nodes, with the element size a compile time constant.
+ *
+ *     name_create()                name*, NULL if allocation fails
+ *     name_destroy(&list)          void
+ *     name_list(list)              List* sharing the nodes
+ *     name_size(list)              size_t
+ *     name_append(list, elem)      void, constant time
+ *     name_prepend(list, elem)     void
+ *     name_insert(list, elem, i)   void
+ *     name_front(list)             type* to the first element
+ *     name_back(list)              type* to the last element
+ *     name_at(list, index)         type*, NULL past the end
+ *     name_get(list, index)        type
+ *     name_remove(list, index)     void
+ *     name_clear(list)             void
+ *     name_iterate(list, fn, ctx)  size_t, stops once fn returns false
+ *
+ * DEFINE_LIST_ORDER(name, type, compare) adds searching and sorting to a list
+ * defined before. compare is a function or macro taking two const type* and
+ * returning an int like a CompareFunction. It is called by name, so it is
+ * inlined into the merge sort of list_sort.h.
+ *
+ *     name_sort(list)              void, stable merge sort
+ *     name_find(list, elem)        size_t, first equal index or SIZE_MAX
+ *
+ * The TypedList_ macros at the end pick the function of the right list type
+ * with _Generic, over LIST_TYPES(op) or LIST_ORDERED_TYPES(op) for the
+ * searching and sorting macros. Both are defined by the user before a
+ * TypedList_ macro is used, as a comma separated list of LIST_ENTRY(name, op).
+ */
+
+#define DEFINE_LIST(name, type)                                              \
+    typedef struct name name;                                                \
+                                                                             \
+    static inline List* name##_list(name* list) { return (List*)list; }      \
+                                                                             \
+    static inline name* name##_create(void) {                                \
+        return (name*)List_create(sizeof(type));                             \
+    }                                                                        \
+                                                                             \
+    static inline void name##_destroy(name** list) {                         \
+        if (list == NULL) {                                                  \
+            return;                                                          \
+        }                                                                    \
+        List* base = (List*)*list;                                           \
+        List_destroy(&base);                                                 \
+        *list = (name*)base;                                                 \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_size(const name* list) {                     \
+        assert(list != NULL);                                                \
+        return ((const List*)list)->size;                                    \
+    }                                                                        \
+                                                                             \
+    static inline void name##_append(name* list, type element) {             \
+        List_append((List*)list, &element);                                  \
+    }                                                                        \
+                                                                             \
+    static inline void name##_prepend(name* list, type element) {            \
+        List_prepend((List*)list, &element);                                 \
+    }                                                                        \
+                                                                             \
+    static inline void name##_insert(name* list, type element,               \
+                                     size_t index) {                         \
+        List_insert((List*)list, &element, index);                           \
+    }                                                                        \
+                                                                             \
+    static inline type* name##_front(name* list) {                           \
+        assert(name##_size(list) > 0);                                       \
+        return (type*)ListNode_data(*((List*)list)->head);                   \
+    }                                                                        \
+                                                                             \
+    static inline type* name##_back(name* list) {                            \
+        assert(name##_size(list) > 0);                                       \
+        return (type*)ListNode_data(((List*)list)->tail);                    \
+    }                                                                        \
+                                                                             \
+    static inline type* name##_at(name* list, size_t index) {                \
+        return (type*)List_get_data((List*)list, index);                     \
+    }                                                                        \
+                                                                             \
+    static inline type name##_get(name* list, size_t index) {                \
+        type* element = name##_at(list, index);                              \
+        assert(element != NULL);                                             \
+        return *element;                                                     \
+    }                                                                        \
+                                                                             \
+    static inline void name##_remove(name* list, size_t index) {             \
+        List_remove((List*)list, index);                                     \
+    }                                                                        \
+                                                                             \
+    static inline void name##_clear(name* list) { List_clear((List*)list); } \
+                                                                             \
+    static inline size_t name##_iterate(                                     \
+        name* list, bool (*callback)(type* element, void* context),          \
+        void* context) {                                                     \
+        assert(list != NULL && callback != NULL);                            \
+        size_t count = 0;                                                    \
+        ListNode* node = *((List*)list)->head;                               \
+        while (node != NULL) {                                               \
+            count++;                                                         \
+            if (!callback((type*)ListNode_data(node), context)) {            \
+                break;                                                       \
+            }                                                                \
+            node = node->next;                                               \
+        }                                                                    \
+        return count;                                                        \
+    }
+
+#define DEFINE_LIST_ORDER(name, type, compare)                               \
+    static inline bool name##_in_order(const ListNode* a, const ListNode* b, \
+                                       ListNodeCompareFunction unused) {     \
+        (void)unused;                                                        \
+        return compare((const type*)ListNode_const_data(a),                  \
+                       (const type*)ListNode_const_data(b)) <= 0;            \
+    }                                                                        \
+                                                                             \
+    LIST_DEFINE_MERGE_SORT(name##_merge_sort, name##_in_order)               \
+                                                                             \
+    static inline void name##_sort(name* list) {                             \
+        name##_merge_sort((List*)list, NULL);                                \
+    }                                                                        \
+                                                                             \
+    static inline size_t name##_find(name* list, type element) {             \
+        assert(list != NULL);                                                \
+        size_t index = 0;                                                    \
+        ListNode* node = *((List*)list)->head;                               \
+        while (node != NULL) {                                               \
+            if (compare((const type*)ListNode_const_data(node), &element) == \
+                0) {                                                         \
+                return index;                                                \
+            }                                                                \
+            index++;                                                         \
+            node = node->next;                                               \
+        }                                                                    \
+        return SIZE_MAX;                                                     \
+    }
+
+// One _Generic association per pointer type of a list, for LIST_TYPES
+#define LIST_ENTRY(name, op) \
+    name* : name##_##op, const name* : name##_##op
+
+#define TypedList_size(list) _Generic((list), LIST_TYPES(size))(list)
+#define TypedList_append(list, element) \
+    _Generic((list), LIST_TYPES(append))((list), (element))
+#define TypedList_prepend(list, element) \
+    _Generic((list), LIST_TYPES(prepend))((list), (element))
+#define TypedList_insert(list, element, index) \
+    _Generic((list), LIST_TYPES(insert))((list), (element), (index))
+#define TypedList_front(list) _Generic((list), LIST_TYPES(front))(list)
+#define TypedList_back(list) _Generic((list), LIST_TYPES(back))(list)
+#define TypedList_at(list, index) \
+    _Generic((list), LIST_TYPES(at))((list), (index))
+#define TypedList_get(list, index) \
+    _Generic((list), LIST_TYPES(get))((list), (index))
+#define TypedList_remove(list, index) \
+    _Generic((list), LIST_TYPES(remove))((list), (index))
+#define TypedList_clear(list) _Generic((list), LIST_TYPES(clear))(list)
+
+#define TypedList_sort(list) _Generic((list), LIST_ORDERED_TYPES(sort))(list)
+#define TypedList_find(list, element) \
+    _Generic((list), LIST_ORDERED_TYPES(find))((list), (element))
+
+#endif
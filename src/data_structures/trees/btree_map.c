@@ -0,0 +1,972 @@
+#include "btree_map.h"
+
+// Target size of a node, one page
+#define BTREE_NODE_BYTES 4096
+#define BTREE_MIN_CAPACITY 4
+
+// Internal nodes have at least two children, so no tree is deeper than this
+#define BTREE_MAX_DEPTH 64
+
+#define BTREE_ALIGNMENT _Alignof(max_align_t)
+#define BTREE_ROUND_UP(bytes, align) \
+    (((bytes) + (align) - 1) / (align) * (align))
+
+/*
+ * Every node is one allocation: this header, then room for capacity + 1 keys
+ * (one spare so a full node can take an entry before it is split), then
+ * either capacity + 1 values for a leaf or capacity + 2 children for an
+ * internal node. Internal key i separates child i from child i + 1 and is the
+ * smallest key in the subtree of child i + 1.
+ */
+typedef struct BTreeNode {
+    size_t count;            ///< Number of keys
+    bool leaf;               ///< Whether the node holds entries
+    struct BTreeNode* prev;  ///< Leaf to the left, NULL for internal nodes
+    struct BTreeNode* next;  ///< Leaf to the right, NULL for internal nodes
+} BTreeNode;
+
+#define NODE_HEADER BTREE_ROUND_UP(sizeof(BTreeNode), BTREE_ALIGNMENT)
+
+typedef struct BTreePathStep {
+    BTreeNode* node;
+    size_t child;  ///< Index of the child the search went down
+} BTreePathStep;
+
+/*
+ * Node layout
+ */
+
+static inline size_t node_capacity(const BTreeMap* map, const BTreeNode* n) {
+    return n->leaf ? map->leaf_capacity : map->internal_capacity;
+}
+
+static inline size_t keys_bytes(const BTreeMap* map, size_t capacity) {
+    return BTREE_ROUND_UP((capacity + 1) * map->key_size, BTREE_ALIGNMENT);
+}
+
+static inline char* node_key(const BTreeMap* map, const BTreeNode* node,
+                             size_t index) {
+    return (char*)node + NODE_HEADER + index * map->key_size;
+}
+
+static inline char* leaf_value(const BTreeMap* map, const BTreeNode* leaf,
+                               size_t index) {
+    return (char*)leaf + NODE_HEADER + keys_bytes(map, map->leaf_capacity) +
+           index * map->value_size;
+}
+
+static inline BTreeNode** node_children(const BTreeMap* map,
+                                        const BTreeNode* node) {
+    return (BTreeNode**)((char*)node + NODE_HEADER +
+                         keys_bytes(map, map->internal_capacity));
+}
+
+static BTreeNode* node_create(const BTreeMap* map, bool leaf) {
+    size_t bytes = NODE_HEADER;
+    if (leaf) {
+        bytes += keys_bytes(map, map->leaf_capacity) +
+                 (map->leaf_capacity + 1) * map->value_size;
+    } else {
+        bytes += keys_bytes(map, map->internal_capacity) +
+                 (map->internal_capacity + 2) * sizeof(BTreeNode*);
+    }
+
+    BTreeNode* node = (BTreeNode*)malloc(bytes);
+    if (node == NULL) {
+        return (BTreeNode*)NULL;
+    }
+    node->count = 0;
+    node->leaf = leaf;
+    node->prev = NULL;
+    node->next = NULL;
+    return node;
+}
+
+static void node_destroy(const BTreeMap* map, BTreeNode* node) {
+    if (!node->leaf) {
+        BTreeNode** children = node_children(map, node);
+        for (size_t i = 0; i <= node->count; i++) {
+            node_destroy(map, children[i]);
+        }
+    }
+    free(node);
+}
+
+// Fewest keys a node other than the root may hold
+static inline size_t node_min(const BTreeMap* map, const BTreeNode* node) {
+    if (node->leaf) {
+        return map->leaf_capacity / 2;
+    }
+    // At least half the children, one fewer keys than children
+    return (map->internal_capacity + 1) / 2 - 1;
+}
+
+/*
+ * Key order
+ */
+
+#define INT_COMPARE(type)                                \
+    do {                                                 \
+        type x, y;                                       \
+        memcpy(&x, a, sizeof(type));                     \
+        memcpy(&y, b, sizeof(type));                     \
+        return (x > y) - (x < y);                        \
+    } while (0)
+
+static inline int compare_keys(const BTreeMap* map, const void* a,
+                               const void* b) {
+    if (map->compare != NULL) {
+        T key_a = {map->key_size, (void*)a};
+        T key_b = {map->key_size, (void*)b};
+        return map->compare(&key_a, &key_b);
+    }
+
+    switch (map->key_size) {
+        case 1:
+            INT_COMPARE(int8_t);
+        case 2:
+            INT_COMPARE(int16_t);
+        case 4:
+            INT_COMPARE(int32_t);
+        default:
+            INT_COMPARE(int64_t);
+    }
+}
+
+#undef INT_COMPARE
+
+// Index of the first key in node that is not less than key, or with upper set
+// the first key greater than key
+static size_t node_search(const BTreeMap* map, const BTreeNode* node,
+                          const void* key, bool upper) {
+    size_t low = 0;
+    size_t high = node->count;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int order = compare_keys(map, node_key(map, node, mid), key);
+        if (order < 0 || (upper && order == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Follows separators down to the leaf that holds or would hold key
+static BTreeNode* find_leaf(const BTreeMap* map, const void* key,
+                            BTreePathStep* path, size_t* depth) {
+    BTreeNode* node = map->root;
+    size_t level = 0;
+
+    while (!node->leaf) {
+        size_t child = node_search(map, node, key, true);
+        if (path != NULL) {
+            path[level].node = node;
+            path[level].child = child;
+        }
+        level++;
+        node = node_children(map, node)[child];
+    }
+
+    if (depth != NULL) {
+        *depth = level;
+    }
+    return node;
+}
+
+/*
+ * Moving entries within and between nodes
+ */
+
+static void leaf_move(const BTreeMap* map, BTreeNode* dst, size_t to,
+                      const BTreeNode* src, size_t from, size_t count) {
+    memmove(node_key(map, dst, to), node_key(map, src, from),
+            count * map->key_size);
+    memmove(leaf_value(map, dst, to), leaf_value(map, src, from),
+            count * map->value_size);
+}
+
+static void internal_move_keys(const BTreeMap* map, BTreeNode* dst, size_t to,
+                               const BTreeNode* src, size_t from,
+                               size_t count) {
+    memmove(node_key(map, dst, to), node_key(map, src, from),
+            count * map->key_size);
+}
+
+static void internal_move_children(const BTreeMap* map, BTreeNode* dst,
+                                   size_t to, const BTreeNode* src,
+                                   size_t from, size_t count) {
+    memmove(node_children(map, dst) + to, node_children(map, src) + from,
+            count * sizeof(BTreeNode*));
+}
+
+// Puts key and the child to its right into an internal node at index
+static void internal_insert(const BTreeMap* map, BTreeNode* node, size_t index,
+                            const void* key, BTreeNode* right) {
+    internal_move_keys(map, node, index + 1, node, index, node->count - index);
+    internal_move_children(map, node, index + 2, node, index + 1,
+                           node->count - index);
+    memcpy(node_key(map, node, index), key, map->key_size);
+    node_children(map, node)[index + 1] = right;
+    node->count++;
+}
+
+// Drops key index and the child to its right from an internal node
+static void internal_erase(const BTreeMap* map, BTreeNode* node,
+                           size_t index) {
+    internal_move_keys(map, node, index, node, index + 1,
+                       node->count - index - 1);
+    internal_move_children(map, node, index + 1, node, index + 2,
+                           node->count - index - 1);
+    node->count--;
+}
+
+/*
+ * Splitting, done once a node holds one entry more than its capacity
+ */
+
+// Moves the upper half of a leaf to right, a new leaf linked in after it, and
+// leaves the first key of right in the scratch key
+static void split_leaf(BTreeMap* map, BTreeNode* leaf, BTreeNode* right) {
+    size_t keep = (leaf->count + 1) / 2;
+    leaf_move(map, right, 0, leaf, keep, leaf->count - keep);
+    right->count = leaf->count - keep;
+    leaf->count = keep;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next != NULL) {
+        leaf->next->prev = right;
+    } else {
+        map->last = right;
+    }
+    leaf->next = right;
+
+    memcpy(map->scratch, node_key(map, right, 0), map->key_size);
+}
+
+// Moves the upper half of an internal node to right, a new node, and leaves
+// the middle key, which moves up, in the scratch key
+static void split_internal(BTreeMap* map, BTreeNode* node, BTreeNode* right) {
+    size_t middle = node->count / 2;
+    size_t moved = node->count - middle - 1;
+    memcpy(map->scratch, node_key(map, node, middle), map->key_size);
+    internal_move_keys(map, right, 0, node, middle + 1, moved);
+    internal_move_children(map, right, 0, node, middle + 1, moved + 1);
+    right->count = moved;
+    node->count = middle;
+}
+
+// Allocates every node an insert into a full leaf will need up front, so a
+// failed allocation leaves the tree untouched. spares[0] is the new leaf,
+// the rest are internal nodes, the last one the new root if the root splits.
+static size_t reserve_splits(BTreeMap* map, const BTreePathStep* path,
+                             size_t depth, const BTreeNode* leaf,
+                             BTreeNode** spares) {
+    if (leaf->count < map->leaf_capacity) {
+        return 0;
+    }
+
+    size_t needed = 1;
+    size_t level = depth;
+    while (level > 0 &&
+           path[level - 1].node->count == map->internal_capacity) {
+        needed++;
+        level--;
+    }
+    if (level == 0) {
+        needed++;
+    }
+
+    for (size_t i = 0; i < needed; i++) {
+        spares[i] = node_create(map, i == 0);
+        if (spares[i] == NULL) {
+            for (size_t j = 0; j < i; j++) {
+                free(spares[j]);
+            }
+            return SIZE_MAX;
+        }
+    }
+    return needed;
+}
+
+/*
+ * Rebalancing after a removal
+ */
+
+static void borrow_from_left(BTreeMap* map, BTreeNode* parent, size_t index,
+                             BTreeNode* left, BTreeNode* node) {
+    if (node->leaf) {
+        leaf_move(map, node, 1, node, 0, node->count);
+        leaf_move(map, node, 0, left, left->count - 1, 1);
+        memcpy(node_key(map, parent, index - 1), node_key(map, node, 0),
+               map->key_size);
+    } else {
+        internal_move_keys(map, node, 1, node, 0, node->count);
+        internal_move_children(map, node, 1, node, 0, node->count + 1);
+        memcpy(node_key(map, node, 0), node_key(map, parent, index - 1),
+               map->key_size);
+        node_children(map, node)[0] = node_children(map, left)[left->count];
+        memcpy(node_key(map, parent, index - 1),
+               node_key(map, left, left->count - 1), map->key_size);
+    }
+    left->count--;
+    node->count++;
+}
+
+static void borrow_from_right(BTreeMap* map, BTreeNode* parent, size_t index,
+                              BTreeNode* node, BTreeNode* right) {
+    if (node->leaf) {
+        leaf_move(map, node, node->count, right, 0, 1);
+        leaf_move(map, right, 0, right, 1, right->count - 1);
+        memcpy(node_key(map, parent, index), node_key(map, right, 0),
+               map->key_size);
+    } else {
+        memcpy(node_key(map, node, node->count), node_key(map, parent, index),
+               map->key_size);
+        node_children(map, node)[node->count + 1] =
+            node_children(map, right)[0];
+        memcpy(node_key(map, parent, index), node_key(map, right, 0),
+               map->key_size);
+        internal_move_keys(map, right, 0, right, 1, right->count - 1);
+        internal_move_children(map, right, 0, right, 1, right->count);
+    }
+    right->count--;
+    node->count++;
+}
+
+// Moves everything in right into left, right being child index + 1 of parent
+static void merge(BTreeMap* map, BTreeNode* parent, size_t index,
+                  BTreeNode* left, BTreeNode* right) {
+    if (left->leaf) {
+        leaf_move(map, left, left->count, right, 0, right->count);
+        left->count += right->count;
+        left->next = right->next;
+        if (right->next != NULL) {
+            right->next->prev = left;
+        } else {
+            map->last = left;
+        }
+    } else {
+        // The separator comes down between the two halves
+        memcpy(node_key(map, left, left->count), node_key(map, parent, index),
+               map->key_size);
+        internal_move_keys(map, left, left->count + 1, right, 0, right->count);
+        internal_move_children(map, left, left->count + 1, right, 0,
+                               right->count + 1);
+        left->count += right->count + 1;
+    }
+
+    internal_erase(map, parent, index);
+    free(right);
+}
+
+static void rebalance(BTreeMap* map, BTreePathStep* path, size_t depth,
+                      BTreeNode* node) {
+    while (depth > 0 && node->count < node_min(map, node)) {
+        BTreeNode* parent = path[depth - 1].node;
+        size_t index = path[depth - 1].child;
+        BTreeNode** children = node_children(map, parent);
+        BTreeNode* left = index > 0 ? children[index - 1] : NULL;
+        BTreeNode* right = index < parent->count ? children[index + 1] : NULL;
+
+        if (left != NULL && left->count > node_min(map, left)) {
+            borrow_from_left(map, parent, index, left, node);
+            return;
+        }
+        if (right != NULL && right->count > node_min(map, right)) {
+            borrow_from_right(map, parent, index, node, right);
+            return;
+        }
+
+        if (left != NULL) {
+            merge(map, parent, index - 1, left, node);
+        } else {
+            merge(map, parent, index, node, right);
+        }
+        node = parent;
+        depth--;
+    }
+
+    // An internal root left with one child hands the root to that child
+    if (depth == 0 && !node->leaf && node->count == 0) {
+        map->root = node_children(map, node)[0];
+        free(node);
+    }
+}
+
+static ErrorCode check_entry(const BTreeMap* map, const T* key,
+                             const T* value) {
+    if (key == NULL || key->data == NULL) {
+        return ERROR_NULL;
+    }
+    if (key->size != map->key_size) {
+        return ERROR;
+    }
+    if (value != NULL) {
+        if (value->data == NULL && map->value_size > 0) {
+            return ERROR_NULL;
+        }
+        if (value->size != map->value_size) {
+            return ERROR;
+        }
+    }
+    return NO_ERROR;
+}
+
+ReturnBTreeMap BTreeMap_create(size_t key_size, size_t value_size,
+                               CompareFunction compare) {
+    ReturnBTreeMap result = {.error = NO_ERROR, .map = NULL};
+
+    if (key_size == 0 || key_size > BTREE_NODE_BYTES ||
+        value_size > BTREE_NODE_BYTES) {
+        result.error = ERROR;
+        return result;
+    }
+
+    // Without a compare function keys are signed integers
+    if (compare == NULL && key_size != 1 && key_size != 2 && key_size != 4 &&
+        key_size != 8) {
+        result.error = ERROR;
+        return result;
+    }
+
+    BTreeMap* map = (BTreeMap*)malloc(sizeof(BTreeMap));
+    if (map == NULL) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    map->scratch = malloc(key_size);
+    if (map->scratch == NULL) {
+        free(map);
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    size_t room = BTREE_NODE_BYTES - NODE_HEADER;
+    map->size = 0;
+    map->key_size = key_size;
+    map->value_size = value_size;
+    map->compare = compare;
+    map->leaf_capacity = room / (key_size + value_size);
+    map->internal_capacity = room / (key_size + sizeof(BTreeNode*));
+    if (map->leaf_capacity < BTREE_MIN_CAPACITY) {
+        map->leaf_capacity = BTREE_MIN_CAPACITY;
+    }
+    if (map->internal_capacity < BTREE_MIN_CAPACITY) {
+        map->internal_capacity = BTREE_MIN_CAPACITY;
+    }
+    map->root = NULL;
+    map->first = NULL;
+    map->last = NULL;
+
+    result.map = map;
+    return result;
+}
+
+// Size of group index when count items are split into groups as evenly as
+// possible
+static size_t group_size(size_t count, size_t groups, size_t index) {
+    return count / groups + (index < count % groups);
+}
+
+ReturnBTreeMap BTreeMap_from_sorted(const Array* keys, const Array* values,
+                                    CompareFunction compare) {
+    ReturnBTreeMap result = {.error = NO_ERROR, .map = NULL};
+
+    if (keys == NULL || values == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+    if (keys->size != values->size) {
+        result.error = ERROR;
+        return result;
+    }
+
+    result = BTreeMap_create(keys->data_size, values->data_size, compare);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+    BTreeMap* map = result.map;
+    size_t count = keys->size;
+    if (count == 0) {
+        return result;
+    }
+
+    const char* key_data = (const char*)keys->data;
+    const char* value_data = (const char*)values->data;
+    for (size_t i = 1; i < count; i++) {
+        if (compare_keys(map, key_data + (i - 1) * map->key_size,
+                         key_data + i * map->key_size) >= 0) {
+            BTreeMap_destroy(&map);
+            result.error = ERROR;
+            result.map = NULL;
+            return result;
+        }
+    }
+
+    // Nodes of the level being built on, along with the smallest key under
+    // each of them
+    size_t level_count = (count + map->leaf_capacity - 1) / map->leaf_capacity;
+    BTreeNode** level = (BTreeNode**)malloc(level_count * sizeof(BTreeNode*));
+    const char** mins = (const char**)malloc(level_count * sizeof(char*));
+    if (level == NULL || mins == NULL) {
+        free(level);
+        free(mins);
+        BTreeMap_destroy(&map);
+        result.error = ERROR_ALLOCATION;
+        result.map = NULL;
+        return result;
+    }
+
+    for (size_t i = 0; i < level_count; i++) {
+        BTreeNode* leaf = node_create(map, true);
+        if (leaf == NULL) {
+            for (size_t j = 0; j < i; j++) {
+                free(level[j]);
+            }
+            free(level);
+            free(mins);
+            BTreeMap_destroy(&map);
+            result.error = ERROR_ALLOCATION;
+            result.map = NULL;
+            return result;
+        }
+
+        size_t first = i * (count / level_count) +
+                       (i < count % level_count ? i : count % level_count);
+        leaf->count = group_size(count, level_count, i);
+        memcpy(node_key(map, leaf, 0), key_data + first * map->key_size,
+               leaf->count * map->key_size);
+        memcpy(leaf_value(map, leaf, 0), value_data + first * map->value_size,
+               leaf->count * map->value_size);
+
+        if (i > 0) {
+            leaf->prev = level[i - 1];
+            level[i - 1]->next = leaf;
+        }
+        level[i] = leaf;
+        mins[i] = node_key(map, leaf, 0);
+    }
+    map->first = level[0];
+    map->last = level[level_count - 1];
+    map->size = count;
+
+    // Each pass groups the nodes of a level under new parents. Parents are
+    // written over the front of the level array, behind the read position.
+    while (level_count > 1) {
+        size_t fanout = map->internal_capacity + 1;
+        size_t parents = (level_count + fanout - 1) / fanout;
+        size_t child = 0;
+
+        for (size_t i = 0; i < parents; i++) {
+            BTreeNode* parent = node_create(map, false);
+            if (parent == NULL) {
+                // Parents made so far own their children, the rest of the
+                // level is still loose
+                for (size_t j = 0; j < i; j++) {
+                    node_destroy(map, level[j]);
+                }
+                for (size_t j = child; j < level_count; j++) {
+                    node_destroy(map, level[j]);
+                }
+                free(level);
+                free(mins);
+                map->root = NULL;
+                map->first = NULL;
+                map->last = NULL;
+                map->size = 0;
+                BTreeMap_destroy(&map);
+                result.error = ERROR_ALLOCATION;
+                result.map = NULL;
+                return result;
+            }
+
+            size_t taken = group_size(level_count, parents, i);
+            BTreeNode** children = node_children(map, parent);
+            const char* smallest = mins[child];
+            for (size_t j = 0; j < taken; j++) {
+                children[j] = level[child + j];
+                if (j > 0) {
+                    memcpy(node_key(map, parent, j - 1), mins[child + j],
+                           map->key_size);
+                }
+            }
+            parent->count = taken - 1;
+            child += taken;
+
+            level[i] = parent;
+            mins[i] = smallest;
+        }
+        level_count = parents;
+    }
+    map->root = level[0];
+
+    free(level);
+    free(mins);
+    return result;
+}
+
+ReturnError BTreeMap_destroy(BTreeMap** map) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (map == NULL || *map == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    BTreeMap_clear(*map);
+    free((*map)->scratch);
+    free(*map);
+    *map = NULL;
+
+    return result;
+}
+
+ReturnError BTreeMap_clear(BTreeMap* map) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (map == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    if (map->root != NULL) {
+        node_destroy(map, map->root);
+    }
+    map->root = NULL;
+    map->first = NULL;
+    map->last = NULL;
+    map->size = 0;
+
+    return result;
+}
+
+size_t BTreeMap_size(const BTreeMap* map) {
+    if (map == NULL) {
+        return SIZE_MAX;
+    }
+    return map->size;
+}
+
+ReturnError BTreeMap_insert(BTreeMap* map, const T* key, const T* value) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (map == NULL || value == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_entry(map, key, value);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    if (map->root == NULL) {
+        map->root = node_create(map, true);
+        if (map->root == NULL) {
+            result.error = ERROR_ALLOCATION;
+            return result;
+        }
+        map->first = map->root;
+        map->last = map->root;
+    }
+
+    BTreePathStep path[BTREE_MAX_DEPTH];
+    size_t depth;
+    BTreeNode* leaf = find_leaf(map, key->data, path, &depth);
+    size_t index = node_search(map, leaf, key->data, false);
+
+    if (index < leaf->count &&
+        compare_keys(map, node_key(map, leaf, index), key->data) == 0) {
+        memcpy(leaf_value(map, leaf, index), value->data, map->value_size);
+        return result;
+    }
+
+    BTreeNode* spares[BTREE_MAX_DEPTH + 1];
+    size_t spare_count = reserve_splits(map, path, depth, leaf, spares);
+    if (spare_count == SIZE_MAX) {
+        result.error = ERROR_ALLOCATION;
+        return result;
+    }
+
+    // Nodes have room for one entry past capacity, split afterwards
+    leaf_move(map, leaf, index + 1, leaf, index, leaf->count - index);
+    memcpy(node_key(map, leaf, index), key->data, map->key_size);
+    memcpy(leaf_value(map, leaf, index), value->data, map->value_size);
+    leaf->count++;
+    map->size++;
+
+    BTreeNode* node = leaf;
+    size_t spare = 0;
+    while (node->count > node_capacity(map, node)) {
+        BTreeNode* right = spares[spare++];
+        if (node->leaf) {
+            split_leaf(map, node, right);
+        } else {
+            split_internal(map, node, right);
+        }
+
+        if (depth == 0) {
+            BTreeNode* root = spares[spare++];
+            memcpy(node_key(map, root, 0), map->scratch, map->key_size);
+            node_children(map, root)[0] = node;
+            node_children(map, root)[1] = right;
+            root->count = 1;
+            map->root = root;
+            break;
+        }
+
+        depth--;
+        node = path[depth].node;
+        internal_insert(map, node, path[depth].child, map->scratch, right);
+    }
+
+    return result;
+}
+
+ReturnView BTreeMap_get(const BTreeMap* map, const T* key) {
+    ReturnView result = {.error = NO_ERROR, .value = {0, NULL}};
+
+    if (map == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_entry(map, key, NULL);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    BTreeMapIterator it = BTreeMap_lower_bound(map, key);
+    if (!BTreeMapIterator_valid(&it) ||
+        compare_keys(map, node_key(map, it.leaf, it.index), key->data) != 0) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    result.value = BTreeMapIterator_value(&it);
+
+    return result;
+}
+
+ReturnBool BTreeMap_contains(const BTreeMap* map, const T* key) {
+    ReturnBool result = {.error = NO_ERROR, .value = false};
+
+    if (map == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_entry(map, key, NULL);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    BTreeMapIterator it = BTreeMap_lower_bound(map, key);
+    result.value =
+        BTreeMapIterator_valid(&it) &&
+        compare_keys(map, node_key(map, it.leaf, it.index), key->data) == 0;
+    return result;
+}
+
+ReturnError BTreeMap_remove(BTreeMap* map, const T* key) {
+    ReturnError result = {.error = NO_ERROR};
+
+    if (map == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+
+    result.error = check_entry(map, key, NULL);
+    if (result.error != NO_ERROR) {
+        return result;
+    }
+
+    if (map->root == NULL) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    BTreePathStep path[BTREE_MAX_DEPTH];
+    size_t depth;
+    BTreeNode* leaf = find_leaf(map, key->data, path, &depth);
+    size_t index = node_search(map, leaf, key->data, false);
+
+    if (index == leaf->count ||
+        compare_keys(map, node_key(map, leaf, index), key->data) != 0) {
+        result.error = ERROR_NOT_FOUND;
+        return result;
+    }
+
+    leaf_move(map, leaf, index, leaf, index + 1, leaf->count - index - 1);
+    leaf->count--;
+    map->size--;
+
+    if (map->size == 0) {
+        free(map->root);
+        map->root = NULL;
+        map->first = NULL;
+        map->last = NULL;
+        return result;
+    }
+
+    rebalance(map, path, depth, leaf);
+    return result;
+}
+
+/*
+ * Iteration
+ */
+
+// Steps past the end of a leaf onto the next one
+static BTreeMapIterator normalize(BTreeMapIterator it) {
+    if (it.leaf != NULL && it.index >= it.leaf->count) {
+        it.leaf = it.leaf->next;
+        it.index = 0;
+    }
+    return it;
+}
+
+BTreeMapIterator BTreeMap_first(const BTreeMap* map) {
+    BTreeMapIterator it = {map, NULL, 0};
+    if (map != NULL) {
+        it.leaf = map->first;
+    }
+    return it;
+}
+
+BTreeMapIterator BTreeMap_last(const BTreeMap* map) {
+    BTreeMapIterator it = {map, NULL, 0};
+    if (map != NULL && map->last != NULL) {
+        it.leaf = map->last;
+        it.index = map->last->count - 1;
+    }
+    return it;
+}
+
+static BTreeMapIterator bound(const BTreeMap* map, const T* key, bool upper) {
+    BTreeMapIterator it = {map, NULL, 0};
+    if (map == NULL || map->root == NULL ||
+        check_entry(map, key, NULL) != NO_ERROR) {
+        return it;
+    }
+
+    it.leaf = find_leaf(map, key->data, NULL, NULL);
+    it.index = node_search(map, it.leaf, key->data, upper);
+    return normalize(it);
+}
+
+BTreeMapIterator BTreeMap_lower_bound(const BTreeMap* map, const T* key) {
+    return bound(map, key, false);
+}
+
+BTreeMapIterator BTreeMap_upper_bound(const BTreeMap* map, const T* key) {
+    return bound(map, key, true);
+}
+
+bool BTreeMapIterator_valid(const BTreeMapIterator* it) {
+    return it != NULL && it->leaf != NULL;
+}
+
+bool BTreeMapIterator_next(BTreeMapIterator* it) {
+    if (!BTreeMapIterator_valid(it)) {
+        return false;
+    }
+    it->index++;
+    *it = normalize(*it);
+    return it->leaf != NULL;
+}
+
+bool BTreeMapIterator_prev(BTreeMapIterator* it) {
+    if (!BTreeMapIterator_valid(it)) {
+        return false;
+    }
+    if (it->index > 0) {
+        it->index--;
+        return true;
+    }
+    it->leaf = it->leaf->prev;
+    it->index = it->leaf != NULL ? it->leaf->count - 1 : 0;
+    return it->leaf != NULL;
+}
+
+T BTreeMapIterator_key(const BTreeMapIterator* it) {
+    T key = {0, NULL};
+    if (BTreeMapIterator_valid(it)) {
+        key.size = it->map->key_size;
+        key.data = node_key(it->map, it->leaf, it->index);
+    }
+    return key;
+}
+
+T BTreeMapIterator_value(const BTreeMapIterator* it) {
+    T value = {0, NULL};
+    if (BTreeMapIterator_valid(it)) {
+        value.size = it->map->value_size;
+        value.data = leaf_value(it->map, it->leaf, it->index);
+    }
+    return value;
+}
+
+ReturnSizeT BTreeMap_scan(const BTreeMap* map, const T* low, const T* high,
+                          bool reverse,
+                          bool (*callback)(const T* key, T* value,
+                                           void* context),
+                          void* context) {
+    ReturnSizeT result = {.error = NO_ERROR, .value = 0};
+
+    if (map == NULL || callback == NULL) {
+        result.error = ERROR_NULL;
+        return result;
+    }
+    if ((low != NULL && check_entry(map, low, NULL) != NO_ERROR) ||
+        (high != NULL && check_entry(map, high, NULL) != NO_ERROR)) {
+        result.error = ERROR;
+        return result;
+    }
+
+    BTreeMapIterator it;
+    if (!reverse) {
+        it = low != NULL ? BTreeMap_lower_bound(map, low) : BTreeMap_first(map);
+    } else if (high != NULL) {
+        // The last key below high sits just before its lower bound
+        it = BTreeMap_lower_bound(map, high);
+        if (BTreeMapIterator_valid(&it)) {
+            BTreeMapIterator_prev(&it);
+        } else {
+            it = BTreeMap_last(map);
+        }
+    } else {
+        it = BTreeMap_last(map);
+    }
+
+    while (BTreeMapIterator_valid(&it)) {
+        T key = BTreeMapIterator_key(&it);
+        if (!reverse && high != NULL &&
+            compare_keys(map, key.data, high->data) >= 0) {
+            break;
+        }
+        if (reverse && low != NULL &&
+            compare_keys(map, key.data, low->data) < 0) {
+            break;
+        }
+
+        T value = BTreeMapIterator_value(&it);
+        result.value++;
+        if (!callback(&key, &value, context)) {
+            break;
+        }
+
+        if (reverse) {
+            BTreeMapIterator_prev(&it);
+        } else {
+            BTreeMapIterator_next(&it);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,259 @@
+#ifndef BTREE_MAP_H
+#define BTREE_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../arrays/array.h"
+
+/**
+ * @brief Ordered map from fixed size keys to fixed size values.
+ *
+ * A B+ tree whose nodes are sized to about a page, with the keys of a node
+ * packed together ahead of its values or children so a search within a node
+ * only touches keys. Every entry lives in a leaf and the leaves are linked
+ * both ways, so range scans in either direction walk memory in order and
+ * never climb back up the tree.
+ *
+ * Keys are ordered with a CompareFunction, or, when none is given, as signed
+ * integers of key_size bytes (1, 2, 4 or 8) compared inline.
+ */
+typedef struct BTreeMap {
+    size_t size;                ///< Number of entries
+    size_t key_size;            ///< Size of each key in bytes
+    size_t value_size;          ///< Size of each value in bytes
+    CompareFunction compare;    ///< Key order, NULL for signed integer keys
+    size_t leaf_capacity;       ///< Entries per leaf
+    size_t internal_capacity;   ///< Keys per internal node
+    struct BTreeNode* root;     ///< Root node, NULL when empty
+    struct BTreeNode* first;    ///< Leftmost leaf, NULL when empty
+    struct BTreeNode* last;     ///< Rightmost leaf, NULL when empty
+    void* scratch;              ///< key_size bytes used while splitting
+} BTreeMap;
+
+typedef struct ReturnBTreeMapType {
+    ErrorCode error;
+    BTreeMap* map;
+} ReturnBTreeMap;
+
+/**
+ * @brief Position of an entry in a BTreeMap.
+ *
+ * Any insert or remove invalidates every iterator of the map.
+ */
+typedef struct BTreeMapIterator {
+    const BTreeMap* map;     ///< Map being walked
+    struct BTreeNode* leaf;  ///< Leaf of the entry, NULL past either end
+    size_t index;            ///< Index of the entry in its leaf
+} BTreeMapIterator;
+
+/**
+ * @brief Creates a new, empty BTreeMap.
+ *
+ * @param key_size Size of each key in bytes.
+ * @param value_size Size of each value in bytes.
+ * @param compare Key order, or NULL to order keys as signed integers, in
+ * which case key_size must be 1, 2, 4 or 8.
+ *
+ * @return ReturnBTreeMap will either return an ErrorCode or a BTreeMap*
+ */
+ReturnBTreeMap BTreeMap_create(size_t key_size, size_t value_size,
+                               CompareFunction compare);
+
+/**
+ * @brief Builds a BTreeMap from sorted keys and their values in O(n).
+ *
+ * Leaves are filled in order and each level of the tree is built once on
+ * top of the last, without any searching or splitting.
+ *
+ * @param keys Array of keys in strictly ascending order.
+ * @param values Array with the value of each key, the same size as keys.
+ * @param compare Key order, or NULL for signed integer keys.
+ *
+ * @return ReturnBTreeMap will either return an ErrorCode or a BTreeMap*.
+ * ERROR if the keys are not strictly ascending or the sizes do not match.
+ */
+ReturnBTreeMap BTreeMap_from_sorted(const Array* keys, const Array* values,
+                                    CompareFunction compare);
+
+/**
+ * @brief Destroys a BTreeMap and frees associated memory.
+ *
+ * @param map Pointer to the BTreeMap to be destroyed.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError BTreeMap_destroy(BTreeMap** map);
+
+/**
+ * @brief Removes every entry.
+ *
+ * @param map Pointer to the BTreeMap.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError BTreeMap_clear(BTreeMap* map);
+
+/**
+ * @brief Returns the number of entries in the BTreeMap.
+ *
+ * @param map Pointer to the BTreeMap.
+ *
+ * @return size_t number of entries, SIZE_MAX if map is NULL
+ */
+size_t BTreeMap_size(const BTreeMap* map);
+
+/**
+ * @brief Inserts a key with its value, replacing the value if the key is
+ * already present.
+ *
+ * @param map Pointer to the BTreeMap.
+ * @param key Key to insert, its size must be key_size.
+ * @param value Value to store, its size must be value_size.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum
+ */
+ReturnError BTreeMap_insert(BTreeMap* map, const T* key, const T* value);
+
+/**
+ * @brief Looks up the value stored for a key.
+ *
+ * @param map Pointer to the BTreeMap.
+ * @param key Key to look up.
+ *
+ * @return ReturnView with a view of the value inside the BTreeMap, or
+ * ERROR_NOT_FOUND. The view is valid until the next call that changes the
+ * BTreeMap.
+ */
+ReturnView BTreeMap_get(const BTreeMap* map, const T* key);
+
+/**
+ * @brief Checks whether a key is present.
+ *
+ * @param map Pointer to the BTreeMap.
+ * @param key Key to look up.
+ *
+ * @return ReturnBool will either return an ErrorCode or a bool
+ */
+ReturnBool BTreeMap_contains(const BTreeMap* map, const T* key);
+
+/**
+ * @brief Removes a key and its value.
+ *
+ * @param map Pointer to the BTreeMap.
+ * @param key Key to remove.
+ *
+ * @return ReturnError will return an struct containing an ErrorCode enum,
+ * ERROR_NOT_FOUND if the key was not present.
+ */
+ReturnError BTreeMap_remove(BTreeMap* map, const T* key);
+
+/**
+ * @brief Returns an iterator at the smallest key.
+ *
+ * @param map Pointer to the BTreeMap.
+ *
+ * @return BTreeMapIterator, past the end if the map is empty.
+ */
+BTreeMapIterator BTreeMap_first(const BTreeMap* map);
+
+/**
+ * @brief Returns an iterator at the largest key.
+ *
+ * @param map Pointer to the BTreeMap.
+ *
+ * @return BTreeMapIterator, past the end if the map is empty.
+ */
+BTreeMapIterator BTreeMap_last(const BTreeMap* map);
+
+/**
+ * @brief Returns an iterator at the first key that is not less than key.
+ *
+ * @param map Pointer to the BTreeMap.
+ * @param key Key to search for.
+ *
+ * @return BTreeMapIterator, past the end if every key is less than key.
+ */
+BTreeMapIterator BTreeMap_lower_bound(const BTreeMap* map, const T* key);
+
+/**
+ * @brief Returns an iterator at the first key that is greater than key.
+ *
+ * @param map Pointer to the BTreeMap.
+ * @param key Key to search for.
+ *
+ * @return BTreeMapIterator, past the end if no key is greater than key.
+ */
+BTreeMapIterator BTreeMap_upper_bound(const BTreeMap* map, const T* key);
+
+/**
+ * @brief Checks whether an iterator is at an entry.
+ *
+ * @param it Pointer to the iterator.
+ *
+ * @return true if the iterator is at an entry, false past either end.
+ */
+bool BTreeMapIterator_valid(const BTreeMapIterator* it);
+
+/**
+ * @brief Moves an iterator to the next larger key.
+ *
+ * @param it Pointer to the iterator.
+ *
+ * @return true if the iterator is at an entry afterwards.
+ */
+bool BTreeMapIterator_next(BTreeMapIterator* it);
+
+/**
+ * @brief Moves an iterator to the next smaller key.
+ *
+ * @param it Pointer to the iterator.
+ *
+ * @return true if the iterator is at an entry afterwards.
+ */
+bool BTreeMapIterator_prev(BTreeMapIterator* it);
+
+/**
+ * @brief Returns a view of the key at an iterator.
+ *
+ * @param it Pointer to a valid iterator.
+ *
+ * @return GenericDataType pointing at the key inside the map, which must not
+ * be changed.
+ */
+T BTreeMapIterator_key(const BTreeMapIterator* it);
+
+/**
+ * @brief Returns a view of the value at an iterator.
+ *
+ * @param it Pointer to a valid iterator.
+ *
+ * @return GenericDataType pointing at the value inside the map.
+ */
+T BTreeMapIterator_value(const BTreeMapIterator* it);
+
+/**
+ * @brief Calls callback on every entry with low <= key < high, in ascending
+ * or descending key order, until it returns false.
+ *
+ * @param map Pointer to the BTreeMap.
+ * @param low Smallest key of the range, NULL for no lower limit.
+ * @param high Key just past the range, NULL for no upper limit.
+ * @param reverse Walks from the largest key down if true.
+ * @param callback Function called with a view of each key and value. It may
+ * change the value but must not change the map.
+ * @param context Pointer passed through to every callback call.
+ *
+ * @return ReturnSizeT with the number of entries the callback was called on.
+ */
+ReturnSizeT BTreeMap_scan(const BTreeMap* map, const T* low, const T* high,
+                          bool reverse,
+                          bool (*callback)(const T* key, T* value,
+                                           void* context),
+                          void* context);
+
+#endif
@@ -1,19 +1,48 @@
 #include <stdio.h>
 
 #include "test_array.h"
+#include "test_btree_map.h"
+#include "test_dictionary.h"
+#include "test_dlist.h"
 #include "test_list.h"
+#include "test_priority_queue.h"
+#include "test_thread_pool.h"
 
 int main() {
     printf("Testing Arrays...\n");
     test_array();
     test_int_array();
     test_struct_array();
+    test_ring_buffer();
+    test_typed_vector();
     printf("Array tests pass!\n");
 
     printf("Testing Linked Lists...\n");
-    // test_list();
-    // test_int_list();
+    test_list();
+    test_int_list();
+    test_typed_list();
     printf("Linked List tests pass!\n");
 
+    printf("Testing Doubly Linked Lists...\n");
+    test_dlist();
+    printf("Doubly Linked List tests pass!\n");
+
+    printf("Testing Dictionaries...\n");
+    test_dictionary();
+    test_concurrent_dictionary();
+    printf("Dictionary tests pass!\n");
+
+    printf("Testing B-Trees...\n");
+    test_btree_map();
+    printf("B-Tree tests pass!\n");
+
+    printf("Testing Priority Queues...\n");
+    test_priority_queue();
+    printf("Priority Queue tests pass!\n");
+
+    printf("Testing Thread Pools...\n");
+    test_thread_pool();
+    printf("Thread Pool tests pass!\n");
+
     return 0;
 }
\ No newline at end of file
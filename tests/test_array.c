@@ -1,5 +1,8 @@
 #include "test_array.h"
 
+#include <limits.h>
+#include <stdatomic.h>
+
 #include "string.h"
 
 typedef struct Person {
@@ -25,6 +28,49 @@ int compare_int(const T* a, const T* b) {
     }
 }
 
+// McIlroy's adversary: decides the order of the elements lazily so that
+// every pivot a quicksort picks ends up near the bottom, which drives pdqsort
+// into its heapsort fallback
+typedef struct Adversary {
+    int* values;    ///< Value decided for each item, gas until decided
+    int gas;        ///< Placeholder value larger than every decided one
+    int decided;    ///< Next value to hand out
+    int candidate;  ///< Item most recently compared while undecided
+} Adversary;
+
+Adversary adversary;
+
+int compare_adversary(const T* a, const T* b) {
+    int x = *((const int*)a->data);
+    int y = *((const int*)b->data);
+    int* values = adversary.values;
+
+    if (values[x] == adversary.gas && values[y] == adversary.gas) {
+        values[x == adversary.candidate ? x : y] = adversary.decided++;
+    }
+    if (values[x] == adversary.gas) {
+        adversary.candidate = x;
+    } else if (values[y] == adversary.gas) {
+        adversary.candidate = y;
+    }
+    return (values[x] > values[y]) - (values[x] < values[y]);
+}
+
+// Comparator that records how many threads were comparing at once
+atomic_int comparing = 0;
+atomic_int comparing_peak = 0;
+
+int compare_int_counted(const T* a, const T* b) {
+    int now = atomic_fetch_add(&comparing, 1) + 1;
+    int peak = atomic_load(&comparing_peak);
+    while (now > peak &&
+           !atomic_compare_exchange_weak(&comparing_peak, &peak, now)) {
+    }
+    int result = compare_int(a, b);
+    atomic_fetch_sub(&comparing, 1);
+    return result;
+}
+
 int compare_person(const T* a, const T* b) {
     int age_a = (*((const Person*)a->data)).age;
     int age_b = (*((const Person*)b->data)).age;
@@ -40,6 +86,59 @@ int compare_person(const T* a, const T* b) {
 
 void new_year(T* element) { (*((Person*)element->data)).age++; }
 
+void sum_int(T* element, void* context) {
+    *((long long*)context) += *((int*)element->data);
+}
+
+void scale_int(int* element, void* context) { *element *= *(int*)context; }
+
+void count_block(void* elements, size_t count, void* context) {
+    (void)elements;
+    size_t* blocks = (size_t*)context;
+    blocks[0]++;
+    blocks[1] += count;
+}
+
+void negate_ints(int* elements, size_t count, void* context) {
+    (void)context;
+    for (size_t i = 0; i < count; i++) {
+        elements[i] = -elements[i];
+    }
+}
+
+void age_by(T* element, void* context) {
+    (*((Person*)element->data)).age += *(int*)context;
+}
+
+static inline int compare_int_value(const int* a, const int* b) {
+    return (*a > *b) - (*a < *b);
+}
+
+static inline int compare_person_age(const Person* a, const Person* b) {
+    return (a->age > b->age) - (a->age < b->age);
+}
+
+DEFINE_VECTOR(IntVector, int)
+DEFINE_VECTOR_ORDER(IntVector, int, compare_int_value)
+DEFINE_VECTOR(PersonVector, Person)
+DEFINE_VECTOR_ORDER(PersonVector, Person, compare_person_age)
+
+#define VECTOR_TYPES(op) \
+    VECTOR_ENTRY(IntVector, op), VECTOR_ENTRY(PersonVector, op)
+#define VECTOR_ORDERED_TYPES(op) VECTOR_TYPES(op)
+
+// Allocator that counts live blocks in its context
+void* counting_alloc(void* context, size_t size) {
+    (*(size_t*)context)++;
+    return malloc(size);
+}
+
+void counting_free(void* context, void* ptr, size_t size) {
+    (void)size;
+    (*(size_t*)context)--;
+    free(ptr);
+}
+
 void test_array() {
     // Test creation
     ReturnArray create_result = Array_create(sizeof(int), 5);
@@ -50,11 +149,7 @@ void test_array() {
     assert(arr->size == 0);
     assert(arr->capacity == 5);
     assert(arr->data_size == sizeof(int));
-    assert(arr->values != NULL);
-    for (size_t i = 0; i < arr->capacity; i++) {
-        assert(arr->values[i].size == sizeof(int));
-        assert(arr->values[i].data != NULL);
-    }
+    assert(arr->data != NULL);
 
     // Test basics
     ReturnSizeT size_result = Array_size(arr);
@@ -77,9 +172,9 @@ void test_array() {
     size_result = Array_size(arr);
     assert(size_result.error == NO_ERROR);
     assert(size_result.value == 1);
-    ReturnData get_result = Array_get(arr, 0);
+    ReturnView get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(*(int*)get_result.value->data == 42);
+    assert(*(int*)get_result.value.data == 42);
 
     // Test inserting
     ReturnError insert_result = Array_insert(
@@ -106,19 +201,25 @@ void test_array() {
 
     get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(*(int*)get_result.value->data == 7);
+    assert(*(int*)get_result.value.data == 7);
 
     get_result = Array_get(arr, 1);
     assert(get_result.error == NO_ERROR);
-    assert(*(int*)get_result.value->data == 15);
+    assert(*(int*)get_result.value.data == 15);
 
     get_result = Array_get(arr, 2);
     assert(get_result.error == NO_ERROR);
-    assert(*(int*)get_result.value->data == 42);
+    assert(*(int*)get_result.value.data == 42);
 
     get_result = Array_get(arr, 3);
     assert(get_result.error == NO_ERROR);
-    assert(*(int*)get_result.value->data == 98);
+    assert(*(int*)get_result.value.data == 98);
+
+    // Test two views can be held at once without aliasing
+    T first = Array_get(arr, 0).value;
+    T last = Array_get(arr, 3).value;
+    assert(compare_int(&first, &last) < 0);
+    assert(compare_int(&last, &first) > 0);
 
     // Test removing
     ReturnError remove_result =
@@ -142,7 +243,7 @@ void test_array() {
 
     get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(*(int*)get_result.value->data == 42);
+    assert(*(int*)get_result.value.data == 42);
 
     // Test setting
     ReturnError set_result = Array_set(arr, 0, &(T){sizeof(int), &(int){99}});
@@ -150,7 +251,7 @@ void test_array() {
 
     get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(*(int*)get_result.value->data == 99);
+    assert(*(int*)get_result.value.data == 99);
 
     // Test clearing
     ReturnError clear_result = Array_clear(arr);
@@ -180,7 +281,7 @@ void test_array() {
 
         get_result = Array_get(arr, i);
         assert(get_result.error == NO_ERROR);
-        assert(*(int*)get_result.value->data == vals[i]);
+        assert(*(int*)get_result.value.data == vals[i]);
     }
 
     // Test find
@@ -188,6 +289,31 @@ void test_array() {
     assert(find_result.error == NO_ERROR);
     assert(find_result.value == 6);
 
+    // Test find all
+    append_result = Array_append(arr, &(T){sizeof(int), &(int){23}});
+    assert(append_result.error == NO_ERROR);
+
+    ReturnArray find_all_result =
+        Array_find_all(arr, &(T){sizeof(int), &(int){23}});
+    assert(find_all_result.error == NO_ERROR);
+    assert(find_all_result.arr->size == 2);
+    assert(((size_t*)find_all_result.arr->data)[0] == 6);
+    assert(((size_t*)find_all_result.arr->data)[1] == 10);
+    Array_destroy(&find_all_result.arr);
+
+    uint64_t mask[1];
+    ReturnSizeT mask_result =
+        Array_find_mask(arr, &(T){sizeof(int), &(int){23}}, mask);
+    assert(mask_result.error == NO_ERROR);
+    assert(mask_result.value == 2);
+    assert(mask[0] == (((uint64_t)1 << 6) | ((uint64_t)1 << 10)));
+
+    find_result = Array_find(arr, &(T){sizeof(int), &(int){1234}});
+    assert(find_result.error == ERROR_NOT_FOUND);
+
+    remove_result = Array_remove(arr, 10);
+    assert(remove_result.error == NO_ERROR);
+
     // Test sort
     ReturnError sort_result = Array_sort(arr, compare_int);
     assert(sort_result.error == NO_ERROR);
@@ -195,9 +321,58 @@ void test_array() {
     for (size_t i = 0; i < 10; i++) {
         get_result = Array_get(arr, i);
         assert(get_result.error == NO_ERROR);
-        assert(*(int*)get_result.value->data == sorted[i]);
+        assert(*(int*)get_result.value.data == sorted[i]);
     }
 
+    // Test sorted searches
+    ReturnSizeT bound_result =
+        Array_lower_bound(arr, &(T){sizeof(int), &(int){23}}, compare_int);
+    assert(bound_result.error == NO_ERROR);
+    assert(bound_result.value == 5);
+
+    bound_result =
+        Array_upper_bound(arr, &(T){sizeof(int), &(int){23}}, compare_int);
+    assert(bound_result.error == NO_ERROR);
+    assert(bound_result.value == 6);
+
+    bound_result =
+        Array_lower_bound(arr, &(T){sizeof(int), &(int){1000}}, compare_int);
+    assert(bound_result.error == NO_ERROR);
+    assert(bound_result.value == 10);
+
+    ReturnRange range_result =
+        Array_equal_range(arr, &(T){sizeof(int), &(int){1}}, compare_int);
+    assert(range_result.error == NO_ERROR);
+    assert(range_result.begin == 5 && range_result.end == 5);
+
+    find_result =
+        Array_bsearch(arr, &(T){sizeof(int), &(int){-56}}, compare_int);
+    assert(find_result.error == NO_ERROR);
+    assert(find_result.value == 2);
+
+    find_result = Array_bsearch(arr, &(T){sizeof(int), &(int){1}}, compare_int);
+    assert(find_result.error == ERROR_NOT_FOUND);
+
+    ReturnEytzingerArray eytzinger_result = EytzingerArray_create(arr);
+    assert(eytzinger_result.error == NO_ERROR);
+    EytzingerArray* eytzinger = eytzinger_result.arr;
+    for (size_t i = 0; i < 10; i++) {
+        find_result = EytzingerArray_bsearch(
+            eytzinger, &(T){sizeof(int), &sorted[i]}, compare_int);
+        assert(find_result.error == NO_ERROR);
+        assert(find_result.value == i);
+
+        bound_result = EytzingerArray_lower_bound(
+            eytzinger, &(T){sizeof(int), &(int){sorted[i] + 1}}, compare_int);
+        assert(bound_result.error == NO_ERROR);
+        assert(bound_result.value == i + 1);
+    }
+    find_result = EytzingerArray_bsearch(
+        eytzinger, &(T){sizeof(int), &(int){1}}, compare_int);
+    assert(find_result.error == ERROR_NOT_FOUND);
+    EytzingerArray_destroy(&eytzinger);
+    assert(eytzinger == NULL);
+
     // Test iterate
     ReturnError iterate_result = Array_iterate(arr, double_int);
     assert(iterate_result.error == NO_ERROR);
@@ -205,8 +380,151 @@ void test_array() {
     for (size_t i = 0; i < 10; i++) {
         get_result = Array_get(arr, i);
         assert(get_result.error == NO_ERROR);
-        assert(*(int*)get_result.value->data == doubled[i]);
+        assert(*(int*)get_result.value.data == doubled[i]);
+    }
+    long long sum = 0;
+    iterate_result = Array_iterate_ctx(arr, sum_int, &sum);
+    assert(iterate_result.error == NO_ERROR);
+    long long expected_sum = 0;
+    for (size_t i = 0; i < 10; i++) {
+        expected_sum += doubled[i];
+    }
+    assert(sum == expected_sum);
+
+    // Test block iteration
+    size_t blocks[2] = {0, 0};
+    iterate_result = Array_iterate_blocks(arr, count_block, blocks, 3);
+    assert(iterate_result.error == NO_ERROR);
+    assert(blocks[0] == 4 && blocks[1] == 10);
+    blocks[0] = blocks[1] = 0;
+    Array_iterate_blocks(arr, count_block, blocks, 0);
+    assert(blocks[0] == 1 && blocks[1] == 10);
+
+    // Test bulk inserting
+    int block[] = {1, 2, 3};
+    insert_result = Array_insert_n(arr, 1, &(T){sizeof(int), block}, 3);
+    assert(insert_result.error == NO_ERROR);
+
+    size_result = Array_size(arr);
+    assert(size_result.error == NO_ERROR);
+    assert(size_result.value == 13);
+
+    for (size_t i = 0; i < 3; i++) {
+        get_result = Array_get(arr, i + 1);
+        assert(get_result.error == NO_ERROR);
+        assert(*(int*)get_result.value.data == block[i]);
+    }
+
+    get_result = Array_get(arr, 4);
+    assert(get_result.error == NO_ERROR);
+    assert(*(int*)get_result.value.data == doubled[1]);
+
+    // Test bulk removing
+    remove_result = Array_remove_range(arr, 1, 3);
+    assert(remove_result.error == NO_ERROR);
+
+    remove_result = Array_remove_range(arr, 8, 5);
+    assert(remove_result.error == ERROR_INDEX);
+
+    size_result = Array_size(arr);
+    assert(size_result.error == NO_ERROR);
+    assert(size_result.value == 10);
+
+    for (size_t i = 0; i < 10; i++) {
+        get_result = Array_get(arr, i);
+        assert(get_result.error == NO_ERROR);
+        assert(*(int*)get_result.value.data == doubled[i]);
+    }
+
+    // Test shrink to fit, growth policies and reserve
+    ReturnError growth_result = Array_shrink_to_fit(arr);
+    assert(growth_result.error == NO_ERROR);
+    assert(arr->capacity == 10);
+
+    growth_result =
+        Array_set_growth_policy(arr, (GrowthPolicy){GROWTH_INCREMENT, 0, 4});
+    assert(growth_result.error == NO_ERROR);
+    append_result = Array_append(arr, &(T){sizeof(int), &(int){5}});
+    assert(append_result.error == NO_ERROR);
+    assert(arr->capacity == 14);
+
+    growth_result =
+        Array_set_growth_policy(arr, (GrowthPolicy){GROWTH_GEOMETRIC, 1.5, 0});
+    assert(growth_result.error == NO_ERROR);
+    Array_shrink_to_fit(arr);
+    append_result = Array_append(arr, &(T){sizeof(int), &(int){6}});
+    assert(append_result.error == NO_ERROR);
+    assert(arr->capacity == 16);
+
+    growth_result =
+        Array_set_growth_policy(arr, (GrowthPolicy){GROWTH_PAGE, 1.0, 0});
+    assert(growth_result.error == ERROR);
+    growth_result =
+        Array_set_growth_policy(arr, (GrowthPolicy){GROWTH_PAGE, 1.5, 0});
+    assert(growth_result.error == NO_ERROR);
+    Array_shrink_to_fit(arr);
+    append_result = Array_append(arr, &(T){sizeof(int), &(int){7}});
+    assert(append_result.error == NO_ERROR);
+    assert(arr->capacity == 4096 / sizeof(int));
+
+    growth_result = Array_reserve(arr, 2000);
+    assert(growth_result.error == NO_ERROR);
+    assert(arr->capacity == 2000);
+    growth_result = Array_reserve(arr, 50);
+    assert(growth_result.error == NO_ERROR);
+    assert(arr->capacity == 2000);
+
+    remove_result = Array_remove_range(arr, 10, 3);
+    assert(remove_result.error == NO_ERROR);
+    for (size_t i = 0; i < 10; i++) {
+        get_result = Array_get(arr, i);
+        assert(get_result.error == NO_ERROR);
+        assert(*(int*)get_result.value.data == doubled[i]);
+    }
+
+    // Test custom allocator
+    size_t live_blocks = 0;
+    Allocator counting = {counting_alloc, NULL, counting_free, &live_blocks};
+    ReturnArray counted_result =
+        Array_create_with_allocator(sizeof(int), 2, &counting);
+    assert(counted_result.error == NO_ERROR);
+    Array* counted = counted_result.arr;
+    assert(live_blocks == 2);
+    for (size_t i = 0; i < 10; i++) {
+        append_result = Array_append(counted, &(T){sizeof(int), &vals[i]});
+        assert(append_result.error == NO_ERROR);
+    }
+    assert(live_blocks == 2);
+    for (size_t i = 0; i < 10; i++) {
+        get_result = Array_get(counted, i);
+        assert(get_result.error == NO_ERROR);
+        assert(*(int*)get_result.value.data == vals[i]);
+    }
+    Array_destroy(&counted);
+    assert(live_blocks == 0);
+
+    // Test appending and inserting views into the same Array while it grows
+    Array* own = Array_create(sizeof(int), 1).arr;
+    int seven = 7;
+    Array_append(own, &(T){sizeof(int), &seven});
+    for (int i = 0; i < 6; i++) {
+        T front = Array_get(own, 0).value;
+        assert(Array_append(own, &front).error == NO_ERROR);
     }
+    assert(Array_size(own).value == 7);
+    assert(*(int*)Array_get(own, 6).value.data == 7);
+    for (int i = 0; i < 7; i++) {
+        Array_set(own, i, &(T){sizeof(int), &i});
+    }
+    Array_shrink_to_fit(own);
+    T middle = {sizeof(int), Array_get(own, 2).value.data};
+    assert(Array_insert_n(own, 3, &middle, 3).error == NO_ERROR);
+    int spliced[] = {0, 1, 2, 2, 3, 4, 3, 4, 5, 6};
+    assert(Array_size(own).value == 10);
+    for (size_t i = 0; i < 10; i++) {
+        assert(*(int*)Array_get(own, i).value.data == spliced[i]);
+    }
+    Array_destroy(&own);
 
     // Test Delete
     ReturnError destroy_result = Array_destroy(&arr);
@@ -219,13 +537,9 @@ void test_int_array() {
     Array* arr = IntArray_create(5);
     assert(arr != NULL);
     assert(arr->capacity == 5);
-    assert(arr->values != NULL);
+    assert(arr->data != NULL);
     assert(arr->size == 0);
     assert(arr->data_size == sizeof(int));
-    for (size_t i = 0; i < arr->capacity; i++) {
-        assert(arr->values[i].size == sizeof(int));
-        assert(arr->values[i].data != NULL);
-    }
 
     // Test basics
     assert(IntArray_size(arr) == 0);
@@ -288,12 +602,147 @@ void test_int_array() {
         assert(IntArray_get(arr, i) == sorted[i]);
     }
 
+    // Test sorted searches
+    assert(IntArray_lower_bound(arr, 23) == 5);
+    assert(IntArray_upper_bound(arr, 23) == 6);
+    assert(IntArray_lower_bound(arr, -1000) == 0);
+    assert(IntArray_upper_bound(arr, 789) == 10);
+    assert(IntArray_bsearch(arr, 456) == 8);
+    assert(IntArray_bsearch(arr, 1) == SIZE_MAX);
+
+    // Test sort on larger sorted, reversed, repetitive and signed inputs
+    Array* big = IntArray_create(1000);
+    for (int pattern = 0; pattern < 4; pattern++) {
+        for (int i = 0; i < 1000; i++) {
+            int value = pattern == 0   ? i
+                        : pattern == 1 ? 1000 - i
+                        : pattern == 2 ? i % 7
+                                       : (i * 7919) % 2001 - 1000;
+            IntArray_append(big, value);
+        }
+        IntArray_append(big, INT_MIN);
+        IntArray_append(big, INT_MAX);
+        IntArray_sort(big);
+        assert(IntArray_get(big, 0) == INT_MIN);
+        assert(IntArray_get(big, 1001) == INT_MAX);
+        for (size_t i = 1; i < 1002; i++) {
+            assert(IntArray_get(big, i - 1) <= IntArray_get(big, i));
+        }
+        Array_remove_range(big, 0, 1002);
+    }
+
+    // Same patterns through Array_sort, which IntArray_sort only uses below
+    // its radix cutoff, to keep pdqsort's pattern handling covered
+    for (int pattern = 0; pattern < 4; pattern++) {
+        for (int i = 0; i < 1000; i++) {
+            int value = pattern == 0   ? i
+                        : pattern == 1 ? 1000 - i
+                        : pattern == 2 ? i % 7
+                                       : (i * 7919) % 2001 - 1000;
+            IntArray_append(big, value);
+        }
+        IntArray_append(big, INT_MIN);
+        IntArray_append(big, INT_MAX);
+        assert(Array_sort(big, compare_int).error == NO_ERROR);
+        assert(IntArray_get(big, 0) == INT_MIN);
+        assert(IntArray_get(big, 1001) == INT_MAX);
+        for (size_t i = 1; i < 1002; i++) {
+            assert(IntArray_get(big, i - 1) <= IntArray_get(big, i));
+        }
+        Array_remove_range(big, 0, 1002);
+    }
+
+    // An adversarial order keeps picking bad pivots until heapsort takes over
+    int adversary_values[1000];
+    adversary = (Adversary){adversary_values, 1000, 0, 0};
+    for (int i = 0; i < 1000; i++) {
+        adversary_values[i] = adversary.gas;
+        IntArray_append(big, i);
+    }
+    assert(Array_sort(big, compare_adversary).error == NO_ERROR);
+    for (size_t i = 1; i < 1000; i++) {
+        assert(adversary_values[IntArray_get(big, i - 1)] <=
+               adversary_values[IntArray_get(big, i)]);
+    }
+    Array_remove_range(big, 0, 1000);
+    IntArray_destroy(&big);
+
+    // Test parallel sort matches the serial sort
+    Array* serial = IntArray_create(200000);
+    Array* parallel = IntArray_create(200000);
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < 200000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int value = (int)(seed >> 1) - (1 << 30);
+        IntArray_append(serial, value);
+        IntArray_append(parallel, value);
+    }
+    Array_sort(serial, compare_int);
+    ReturnError parallel_result = Array_sort_parallel(parallel, compare_int, 6);
+    assert(parallel_result.error == NO_ERROR);
+    assert(memcmp(serial->data, parallel->data, 200000 * sizeof(int)) == 0);
+
+    // Test threads caps how many threads sort at once, 0 at the pool's size
+    int pool_lanes = (int)ThreadPool_size(ThreadPool_shared()) + 1;
+    for (int threads = 0; threads <= 2; threads++) {
+        memcpy(parallel->data, serial->data, 200000 * sizeof(int));
+        for (size_t i = 0; i < 100000; i++) {
+            IntArray_swap(parallel, i, 199999 - i);
+        }
+        atomic_store(&comparing_peak, 0);
+        Array_sort_parallel(parallel, compare_int_counted, threads);
+        assert(atomic_load(&comparing_peak) <=
+               (threads == 0 ? pool_lanes : threads));
+        assert(memcmp(serial->data, parallel->data, 200000 * sizeof(int)) ==
+               0);
+    }
+    IntArray_destroy(&serial);
+    IntArray_destroy(&parallel);
+
     // Test iterate
     IntArray_iterate(arr, double_int);
     for (size_t i = 0; i < 10; i++) {
         assert(IntArray_get(arr, i) == doubled[i]);
     }
 
+    // Test parallel for each, with every thread and with one
+    Array* large = IntArray_create(1);
+    for (int i = 0; i < 100000; i++) {
+        IntArray_append(large, i);
+    }
+    IntArray_parallel_for_each(large, scale_int, &(int){3}, 0);
+    IntArray_parallel_for_each(large, scale_int, &(int){-1}, 1);
+    for (int i = 0; i < 100000; i++) {
+        assert(IntArray_get(large, i) == -3 * i);
+    }
+
+    // Test block transforms
+    IntArray_apply_add(large, 5);
+    IntArray_apply_scale(large, 2);
+    IntArray_apply(large, negate_ints, NULL);
+    for (int i = 0; i < 100000; i++) {
+        assert(IntArray_get(large, i) == -(-3 * i + 5) * 2);
+    }
+    IntArray_destroy(&large);
+
+    // Test the unchecked fast path
+    Array* fast = IntArray_create(1);
+    assert(Array_reserve(fast, 100).error == NO_ERROR);
+    for (int i = 0; i < 100; i++) {
+        IntArray_push_unchecked(fast, i);
+    }
+    assert(IntArray_size(fast) == 100);
+    IntArray_set_unchecked(fast, 7, -7);
+    assert(IntArray_get_unchecked(fast, 7) == -7);
+    assert(((int*)Array_data_ptr(fast))[99] == 99);
+    assert(*(int*)Array_back_unchecked(fast) == 99);
+    int popped = 0;
+    Array_pop_unchecked(fast, &popped);
+    assert(popped == 99 && IntArray_size(fast) == 99);
+    Array_get_unchecked(fast, 98, &popped);
+    assert(popped == 98);
+    IntArray_destroy(&fast);
+
     // Test Delete
     IntArray_destroy(&arr);
     assert(arr == NULL);
@@ -307,13 +756,9 @@ void test_struct_array() {
     Array* arr = create_result.arr;
     assert(arr != NULL);
     assert(arr->capacity == 5);
-    assert(arr->values != NULL);
+    assert(arr->data != NULL);
     assert(arr->size == 0);
     assert(arr->data_size == sizeof(Person));
-    for (size_t i = 0; i < arr->capacity; i++) {
-        assert(arr->values[i].size == sizeof(Person));
-        assert(arr->values[i].data != NULL);
-    }
 
     // Test basics
     ReturnSizeT size_result = Array_size(arr);
@@ -368,11 +813,11 @@ void test_struct_array() {
     assert(size_result.error == NO_ERROR);
     assert(size_result.value == 1);
 
-    ReturnData get_result = Array_get(arr, 0);
+    ReturnView get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(((Person*)get_result.value->data)->age == renee.age);
-    assert(((Person*)get_result.value->data)->height == renee.height);
-    assert(strcmp(((Person*)get_result.value->data)->name, renee.name) == 0);
+    assert(((Person*)get_result.value.data)->age == renee.age);
+    assert(((Person*)get_result.value.data)->height == renee.height);
+    assert(strcmp(((Person*)get_result.value.data)->name, renee.name) == 0);
 
     // Test inserting
     ReturnError insert_result = Array_insert(
@@ -400,27 +845,27 @@ void test_struct_array() {
 
     get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(((Person*)get_result.value->data)->age == tj.age);
-    assert(((Person*)get_result.value->data)->height == tj.height);
-    assert(strcmp(((Person*)get_result.value->data)->name, tj.name) == 0);
+    assert(((Person*)get_result.value.data)->age == tj.age);
+    assert(((Person*)get_result.value.data)->height == tj.height);
+    assert(strcmp(((Person*)get_result.value.data)->name, tj.name) == 0);
 
     get_result = Array_get(arr, 1);
     assert(get_result.error == NO_ERROR);
-    assert(((Person*)get_result.value->data)->age == anna.age);
-    assert(((Person*)get_result.value->data)->height == anna.height);
-    assert(strcmp(((Person*)get_result.value->data)->name, anna.name) == 0);
+    assert(((Person*)get_result.value.data)->age == anna.age);
+    assert(((Person*)get_result.value.data)->height == anna.height);
+    assert(strcmp(((Person*)get_result.value.data)->name, anna.name) == 0);
 
     get_result = Array_get(arr, 2);
     assert(get_result.error == NO_ERROR);
-    assert(((Person*)get_result.value->data)->age == renee.age);
-    assert(((Person*)get_result.value->data)->height == renee.height);
-    assert(strcmp(((Person*)get_result.value->data)->name, renee.name) == 0);
+    assert(((Person*)get_result.value.data)->age == renee.age);
+    assert(((Person*)get_result.value.data)->height == renee.height);
+    assert(strcmp(((Person*)get_result.value.data)->name, renee.name) == 0);
 
     get_result = Array_get(arr, 3);
     assert(get_result.error == NO_ERROR);
-    assert(((Person*)get_result.value->data)->age == hunter.age);
-    assert(((Person*)get_result.value->data)->height == hunter.height);
-    assert(strcmp(((Person*)get_result.value->data)->name, hunter.name) == 0);
+    assert(((Person*)get_result.value.data)->age == hunter.age);
+    assert(((Person*)get_result.value.data)->height == hunter.height);
+    assert(strcmp(((Person*)get_result.value.data)->name, hunter.name) == 0);
 
     // Test removing
     ReturnError remove_result =
@@ -437,9 +882,9 @@ void test_struct_array() {
 
     get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(((Person*)get_result.value->data)->age == renee.age);
-    assert(((Person*)get_result.value->data)->height == renee.height);
-    assert(strcmp(((Person*)get_result.value->data)->name, renee.name) == 0);
+    assert(((Person*)get_result.value.data)->age == renee.age);
+    assert(((Person*)get_result.value.data)->height == renee.height);
+    assert(strcmp(((Person*)get_result.value.data)->name, renee.name) == 0);
 
     // Test setting
     ReturnError set_result = Array_set(arr, 0, &(T){sizeof(Person), &brewski});
@@ -450,9 +895,9 @@ void test_struct_array() {
 
     get_result = Array_get(arr, 0);
     assert(get_result.error == NO_ERROR);
-    assert(((Person*)get_result.value->data)->age == brewski.age);
-    assert(((Person*)get_result.value->data)->height == brewski.height);
-    assert(strcmp(((Person*)get_result.value->data)->name, brewski.name) == 0);
+    assert(((Person*)get_result.value.data)->age == brewski.age);
+    assert(((Person*)get_result.value.data)->height == brewski.height);
+    assert(strcmp(((Person*)get_result.value.data)->name, brewski.name) == 0);
 
     // Test clearing
     ReturnError clear_result = Array_clear(arr);
@@ -481,9 +926,9 @@ void test_struct_array() {
 
         get_result = Array_get(arr, i);
         assert(get_result.error == NO_ERROR);
-        assert(((Person*)get_result.value->data)->age == people[i].age);
-        assert(((Person*)get_result.value->data)->height == people[i].height);
-        assert(strcmp(((Person*)get_result.value->data)->name,
+        assert(((Person*)get_result.value.data)->age == people[i].age);
+        assert(((Person*)get_result.value.data)->height == people[i].height);
+        assert(strcmp(((Person*)get_result.value.data)->name,
                       people[i].name) == 0);
     }
 
@@ -498,9 +943,9 @@ void test_struct_array() {
     for (size_t i = 0; i < 6; i++) {
         get_result = Array_get(arr, i);
         assert(get_result.error == NO_ERROR);
-        assert(((Person*)get_result.value->data)->age == sorted[i].age);
-        assert(((Person*)get_result.value->data)->height == sorted[i].height);
-        assert(strcmp(((Person*)get_result.value->data)->name,
+        assert(((Person*)get_result.value.data)->age == sorted[i].age);
+        assert(((Person*)get_result.value.data)->height == sorted[i].height);
+        assert(strcmp(((Person*)get_result.value.data)->name,
                       sorted[i].name) == 0);
     }
 
@@ -510,11 +955,249 @@ void test_struct_array() {
     for (size_t i = 0; i < 6; i++) {
         get_result = Array_get(arr, i);
         assert(get_result.error == NO_ERROR);
-        assert(((Person*)get_result.value->data)->age == (sorted[i].age + 1));
+        assert(((Person*)get_result.value.data)->age == (sorted[i].age + 1));
     }
 
+    // Test parallel for each over elements that straddle cache lines
+    Array* crowd = Array_create(sizeof(Person), 1).arr;
+    for (int i = 0; i < 30000; i++) {
+        Person person = {i, 1.5f, "crowd"};
+        Array_append(crowd, &(T){sizeof(Person), &person});
+    }
+    ReturnError parallel_result =
+        Array_parallel_for_each(crowd, age_by, &(int){10}, 0);
+    assert(parallel_result.error == NO_ERROR);
+    for (size_t i = 0; i < 30000; i++) {
+        assert(((Person*)Array_get(crowd, i).value.data)->age ==
+               (int)i + 10);
+    }
+    assert(Array_parallel_for_each(crowd, NULL, NULL, 0).error ==
+           ERROR_NULL);
+    Array_destroy(&crowd);
+
     // Test Delete
     ReturnError destroy_result = Array_destroy(&arr);
     assert(destroy_result.error == NO_ERROR);
     assert(arr == NULL);
 }
+
+void test_ring_buffer() {
+    // Test creation rounds the capacity up to a power of two
+    assert(RingBuffer_create(sizeof(int), 0).error == ERROR);
+    ReturnRingBuffer create_result = RingBuffer_create(sizeof(int), 3);
+    assert(create_result.error == NO_ERROR);
+    RingBuffer* ring = create_result.ring;
+    assert(RingBuffer_capacity(ring).value == 4);
+    assert(RingBuffer_is_empty(ring).value);
+
+    // Test popping from an empty RingBuffer
+    int out = 0;
+    assert(RingBuffer_pop_front(ring, &(T){sizeof(int), &out}).error ==
+           ERROR_INDEX);
+    assert(RingBuffer_front(ring).error == ERROR_INDEX);
+
+    // Test pushes at both ends wrap around the buffer: 0 1 2 3
+    RingBuffer_push_back(ring, &(T){sizeof(int), &(int){2}});
+    RingBuffer_push_back(ring, &(T){sizeof(int), &(int){3}});
+    RingBuffer_push_front(ring, &(T){sizeof(int), &(int){1}});
+    RingBuffer_push_front(ring, &(T){sizeof(int), &(int){0}});
+    assert(RingBuffer_capacity(ring).value == 4);
+    assert(ring->head == 2);
+    for (int i = 0; i < 4; i++) {
+        assert(*((int*)RingBuffer_get(ring, i).value.data) == i);
+    }
+    assert(RingBuffer_get(ring, 4).error == ERROR_INDEX);
+
+    // Test growing a wrapped buffer keeps the order
+    RingBuffer_push_back(ring, &(T){sizeof(int), &(int){4}});
+    assert(RingBuffer_capacity(ring).value == 8);
+    assert(*((int*)RingBuffer_front(ring).value.data) == 0);
+    assert(*((int*)RingBuffer_back(ring).value.data) == 4);
+
+    // Test pushing a view of an element of the same RingBuffer while it grows
+    for (int i = 5; i < 8; i++) {
+        RingBuffer_push_back(ring, &(T){sizeof(int), &i});
+    }
+    T front = RingBuffer_front(ring).value;
+    RingBuffer_push_back(ring, &front);
+    assert(RingBuffer_size(ring).value == 9);
+    assert(*((int*)RingBuffer_back(ring).value.data) == 0);
+
+    // Test popping at both ends
+    assert(RingBuffer_pop_back(ring, &(T){sizeof(int), &out}).error ==
+           NO_ERROR);
+    assert(out == 0);
+    assert(RingBuffer_pop_front(ring, &(T){sizeof(int), &out}).error ==
+           NO_ERROR);
+    assert(out == 0);
+    assert(RingBuffer_pop_front(ring, NULL).error == NO_ERROR);
+    assert(*((int*)RingBuffer_front(ring).value.data) == 2);
+
+    // Test set and iterate
+    RingBuffer_set(ring, 0, &(T){sizeof(int), &(int){20}});
+    RingBuffer_iterate(ring, double_int);
+    assert(*((int*)RingBuffer_get(ring, 0).value.data) == 40);
+    assert(*((int*)RingBuffer_get(ring, 5).value.data) == 14);
+
+    // Test bulk pushes and pops across the end of the buffer
+    RingBuffer_clear(ring);
+    int values[40];
+    for (int i = 0; i < 40; i++) {
+        values[i] = i;
+    }
+    int popped[40];
+    int next = 0;
+    for (int round = 0; round < 10; round++) {
+        assert(RingBuffer_push_back_n(ring, &(T){sizeof(int), values}, 5)
+                   .error == NO_ERROR);
+        ReturnSizeT pop_result =
+            RingBuffer_pop_front_n(ring, &(T){sizeof(int), popped}, 4);
+        assert(pop_result.value == 4);
+        for (int i = 0; i < 4; i++) {
+            assert(popped[i] == (next + i) % 5);
+        }
+        next = (next + 4) % 5;
+    }
+    assert(RingBuffer_size(ring).value == 10);
+    assert(RingBuffer_push_back_n(ring, &(T){sizeof(int), values}, 40)
+               .error == NO_ERROR);
+    assert(RingBuffer_capacity(ring).value == 64);
+    ReturnSizeT pop_result =
+        RingBuffer_pop_front_n(ring, &(T){sizeof(int), popped}, 40);
+    assert(pop_result.value == 40);
+    assert(popped[0] == 0 && popped[9] == 4 && popped[10] == 0);
+    pop_result = RingBuffer_pop_front_n(ring, NULL, 100);
+    assert(pop_result.value == 10);
+    assert(RingBuffer_is_empty(ring).value);
+
+    // Test Delete
+    assert(RingBuffer_destroy(&ring).error == NO_ERROR);
+    assert(ring == NULL);
+
+    // Test every block comes from and goes back to a custom allocator
+    size_t live_blocks = 0;
+    Allocator allocator = {counting_alloc, NULL, counting_free, &live_blocks};
+    ring = RingBuffer_create_with_allocator(sizeof(int), 1, &allocator).ring;
+    for (int i = 0; i < 100; i++) {
+        RingBuffer_push_front(ring, &(T){sizeof(int), &i});
+    }
+    assert(live_blocks == 2);
+    assert(*((int*)RingBuffer_back(ring).value.data) == 0);
+    RingBuffer_destroy(&ring);
+    assert(live_blocks == 0);
+}
+
+void test_typed_vector() {
+    // Test Create
+    ReturnIntVector created = IntVector_create(4);
+    assert(created.error == NO_ERROR);
+    IntVector* ints = created.vec;
+    assert(IntVector_size(ints) == 0);
+    assert(IntVector_capacity(ints) == 4);
+    assert(IntVector_array(ints)->data_size == sizeof(int));
+
+    // Test Push past the capacity and Get
+    for (int i = 0; i < 100; i++) {
+        assert(IntVector_push(ints, i * 3).error == NO_ERROR);
+    }
+    assert(IntVector_size(ints) == 100);
+    assert(IntVector_capacity(ints) >= 100);
+    for (size_t i = 0; i < 100; i++) {
+        assert(IntVector_get(ints, i) == (int)i * 3);
+    }
+
+    // Test the vector is still an Array underneath
+    assert(IntArray_get(IntVector_array(ints), 10) == 30);
+    IntArray_set(IntVector_array(ints), 10, -30);
+    assert(*IntVector_at(ints, 10) == -30);
+
+    // Test Set, Data and Pop
+    IntVector_set(ints, 10, 30);
+    assert(IntVector_data(ints)[10] == 30);
+    assert(IntVector_pop(ints) == 297);
+    assert(IntVector_size(ints) == 99);
+
+    // Test Find and searching a sorted vector
+    assert(IntVector_find(ints, 42) == 14);
+    assert(IntVector_find(ints, 43) == SIZE_MAX);
+    assert(IntVector_lower_bound(ints, 43) == 15);
+    assert(IntVector_upper_bound(ints, 42) == 15);
+    assert(IntVector_bsearch(ints, 294) == 98);
+    assert(IntVector_bsearch(ints, 1000) == SIZE_MAX);
+
+    // Test Sort on random values with many duplicates and extremes
+    IntVector_clear(ints);
+    assert(IntVector_size(ints) == 0);
+    unsigned int seed = 777;
+    for (size_t i = 0; i < 5000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        IntVector_push(ints, (int)(seed >> 8) % 100 - 50);
+    }
+    IntVector_push(ints, INT_MAX);
+    IntVector_push(ints, INT_MIN);
+    IntVector_sort(ints);
+    assert(IntVector_get(ints, 0) == INT_MIN);
+    assert(IntVector_get(ints, 5001) == INT_MAX);
+    for (size_t i = 1; i < IntVector_size(ints); i++) {
+        assert(IntVector_get(ints, i - 1) <= IntVector_get(ints, i));
+    }
+    size_t zeros = IntVector_upper_bound(ints, 0) -
+                   IntVector_lower_bound(ints, 0);
+    assert(IntVector_bsearch(ints, 0) == IntVector_lower_bound(ints, 0));
+    assert(zeros > 0);
+
+    // Test Sort on already sorted, reversed and constant vectors
+    for (int pattern = 0; pattern < 3; pattern++) {
+        IntVector_clear(ints);
+        for (int i = 0; i < 3000; i++) {
+            int value = pattern == 0 ? i : pattern == 1 ? 3000 - i : 7;
+            IntVector_push(ints, value);
+        }
+        IntVector_sort(ints);
+        for (size_t i = 1; i < IntVector_size(ints); i++) {
+            assert(IntVector_get(ints, i - 1) <= IntVector_get(ints, i));
+        }
+    }
+
+    // Test Destroy
+    assert(IntVector_destroy(&ints).error == NO_ERROR);
+    assert(ints == NULL);
+
+    // Test a vector of structs through the _Generic macros
+    PersonVector* people = PersonVector_create(2).vec;
+    assert(people != NULL);
+    const char* names[] = {"Ada", "Alan", "Grace", "Edsger", "Barbara"};
+    int ages[] = {36, 41, 85, 72, 41};
+    for (size_t i = 0; i < 5; i++) {
+        Person person = {.age = ages[i], .height = 1.5f + 0.1f * i};
+        strcpy(person.name, names[i]);
+        assert(Vector_push(people, person).error == NO_ERROR);
+    }
+    assert(Vector_size(people) == 5);
+    assert(strcmp(Vector_at(people, 2)->name, "Grace") == 0);
+    Vector_at(people, 0)->age++;
+    assert(Vector_get(people, 0).age == 37);
+
+    Vector_sort(people);
+    for (size_t i = 1; i < Vector_size(people); i++) {
+        assert(Vector_get(people, i - 1).age <= Vector_get(people, i).age);
+    }
+    assert(strcmp(Vector_get(people, 4).name, "Grace") == 0);
+    Person key = {.age = 41};
+    assert(Vector_lower_bound(people, key) == 1);
+    assert(Vector_upper_bound(people, key) == 3);
+    assert(Vector_bsearch(people, key) == 1);
+    key.age = 40;
+    assert(Vector_bsearch(people, key) == SIZE_MAX);
+    assert(Vector_find(people, (Person){.age = 72}) == 3);
+    assert(Vector_pop(people).age == 85);
+
+    // Test both vector types dispatch through the same macros
+    IntVector* more = IntVector_create(1).vec;
+    Vector_push(more, 5);
+    assert(Vector_get(more, 0) == 5);
+    assert(Vector_size(more) == 1);
+    IntVector_destroy(&more);
+    PersonVector_destroy(&people);
+    assert(people == NULL);
+}
@@ -4,10 +4,16 @@
 #include <assert.h>
 
 #include "../src/data_structures/arrays/array.h"
+#include "../src/data_structures/arrays/eytzinger_array.h"
 #include "../src/data_structures/arrays/int_array.h"
+#include "../src/data_structures/arrays/ring_buffer.h"
+#include "../src/data_structures/arrays/typed_vector.h"
+#include "../src/concurrency/thread_pool.h"
 
 void test_array();
 void test_int_array();
 void test_struct_array();
+void test_ring_buffer();
+void test_typed_vector();
 
 #endif
\ No newline at end of file
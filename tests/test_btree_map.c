@@ -0,0 +1,136 @@
+#include "test_btree_map.h"
+
+int compare_btree_keys(const T* a, const T* b) {
+    int x = *((int*)a->data);
+    int y = *((int*)b->data);
+    return (x > y) - (x < y);
+}
+
+bool collect_btree_keys(const T* key, T* value, void* context) {
+    (void)value;
+    int** next = (int**)context;
+    *((*next)++) = *((int*)key->data);
+    return true;
+}
+
+void test_btree_map() {
+    // Test Creation
+    assert(BTreeMap_create(3, sizeof(int), NULL).error == ERROR);
+    ReturnBTreeMap created =
+        BTreeMap_create(sizeof(int), sizeof(int), compare_btree_keys);
+    assert(created.error == NO_ERROR);
+    BTreeMap* map = created.map;
+    assert(BTreeMap_size(map) == 0);
+    BTreeMapIterator it = BTreeMap_first(map);
+    assert(!BTreeMapIterator_valid(&it));
+
+    // Test insert enough keys in scrambled order to split several levels
+    int count = 20000;
+    for (int i = 0; i < count; i++) {
+        int key = (int)(((long long)i * 7919) % count);
+        int value = -key;
+        assert(BTreeMap_insert(map, &(T){sizeof(int), &key},
+                               &(T){sizeof(int), &value})
+                   .error == NO_ERROR);
+    }
+    assert(BTreeMap_size(map) == (size_t)count);
+    BTreeMap_insert(map, &(T){sizeof(int), &(int){5}},
+                    &(T){sizeof(int), &(int){55}});
+    assert(BTreeMap_size(map) == (size_t)count);
+    assert(*((int*)BTreeMap_get(map, &(T){sizeof(int), &(int){5}})
+                .value.data) == 55);
+    assert(BTreeMap_get(map, &(T){sizeof(int), &(int){count}}).error ==
+           ERROR_NOT_FOUND);
+
+    // Test two lookups held at once keep their own values
+    T low = BTreeMap_get(map, &(T){sizeof(int), &(int){7}}).value;
+    T high = BTreeMap_get(map, &(T){sizeof(int), &(int){8}}).value;
+    assert(*((int*)low.data) == -7 && *((int*)high.data) == -8);
+
+    // Test iteration in both directions
+    it = BTreeMap_first(map);
+    for (int i = 0; i < count; i++) {
+        assert(*((int*)BTreeMapIterator_key(&it).data) == i);
+        BTreeMapIterator_next(&it);
+    }
+    assert(!BTreeMapIterator_valid(&it));
+    it = BTreeMap_last(map);
+    for (int i = count - 1; i >= 0; i--) {
+        assert(*((int*)BTreeMapIterator_key(&it).data) == i);
+        BTreeMapIterator_prev(&it);
+    }
+    assert(!BTreeMapIterator_valid(&it));
+
+    // Test removing every odd key rebalances without losing any
+    for (int i = 1; i < count; i += 2) {
+        assert(BTreeMap_remove(map, &(T){sizeof(int), &i}).error ==
+               NO_ERROR);
+    }
+    assert(BTreeMap_remove(map, &(T){sizeof(int), &(int){1}}).error ==
+           ERROR_NOT_FOUND);
+    assert(BTreeMap_size(map) == (size_t)count / 2);
+
+    // Test bounds
+    it = BTreeMap_lower_bound(map, &(T){sizeof(int), &(int){101}});
+    assert(*((int*)BTreeMapIterator_key(&it).data) == 102);
+    it = BTreeMap_upper_bound(map, &(T){sizeof(int), &(int){102}});
+    assert(*((int*)BTreeMapIterator_key(&it).data) == 104);
+    it = BTreeMap_lower_bound(map, &(T){sizeof(int), &count});
+    assert(!BTreeMapIterator_valid(&it));
+
+    // Test range scans, [95, 105) both ways
+    int keys[8];
+    int* next = keys;
+    ReturnSizeT scanned =
+        BTreeMap_scan(map, &(T){sizeof(int), &(int){95}},
+                      &(T){sizeof(int), &(int){105}}, false,
+                      collect_btree_keys, &next);
+    assert(scanned.value == 5);
+    assert(keys[0] == 96 && keys[4] == 104);
+    next = keys;
+    scanned = BTreeMap_scan(map, &(T){sizeof(int), &(int){95}},
+                            &(T){sizeof(int), &(int){105}}, true,
+                            collect_btree_keys, &next);
+    assert(scanned.value == 5);
+    assert(keys[0] == 104 && keys[4] == 96);
+
+    // Test removing everything leaves an empty map
+    for (int i = 0; i < count; i += 2) {
+        assert(BTreeMap_remove(map, &(T){sizeof(int), &i}).error ==
+               NO_ERROR);
+    }
+    assert(BTreeMap_size(map) == 0);
+    assert(map->root == NULL);
+    assert(BTreeMap_destroy(&map).error == NO_ERROR);
+    assert(map == NULL);
+
+    // Test bulk loading with integer keys
+    Array* sorted_keys = Array_create(sizeof(int64_t), 1).arr;
+    Array* values = Array_create(sizeof(int64_t), 1).arr;
+    for (int64_t i = 0; i < 5000; i++) {
+        int64_t key = i * 10;
+        Array_append(sorted_keys, &(T){sizeof(int64_t), &key});
+        Array_append(values, &(T){sizeof(int64_t), &i});
+    }
+    created = BTreeMap_from_sorted(sorted_keys, values, NULL);
+    assert(created.error == NO_ERROR);
+    map = created.map;
+    assert(BTreeMap_size(map) == 5000);
+    for (int64_t i = 0; i < 5000; i++) {
+        int64_t key = i * 10 - 5;
+        it = BTreeMap_lower_bound(map, &(T){sizeof(int64_t), &key});
+        assert(*((int64_t*)BTreeMapIterator_value(&it).data) == i);
+    }
+    int64_t key = 15;
+    BTreeMap_insert(map, &(T){sizeof(int64_t), &key},
+                    &(T){sizeof(int64_t), &key});
+    it = BTreeMap_upper_bound(map, &(T){sizeof(int64_t), &(int64_t){10}});
+    assert(*((int64_t*)BTreeMapIterator_key(&it).data) == 15);
+    BTreeMap_destroy(&map);
+
+    // Test bulk loading rejects unsorted keys
+    Array_swap(sorted_keys, 0, 1);
+    assert(BTreeMap_from_sorted(sorted_keys, values, NULL).error == ERROR);
+    Array_destroy(&sorted_keys);
+    Array_destroy(&values);
+}
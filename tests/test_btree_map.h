@@ -0,0 +1,10 @@
+#ifndef TEST_BTREE_MAP_H
+#define TEST_BTREE_MAP_H
+
+#include <assert.h>
+
+#include "../src/data_structures/trees/btree_map.h"
+
+void test_btree_map();
+
+#endif
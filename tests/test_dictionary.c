@@ -0,0 +1,225 @@
+#include "test_dictionary.h"
+
+// Sends every key to the same home slot so probing and removal shifts are
+// exercised
+uint64_t colliding_hash(const void* data, size_t size, uint64_t seed) {
+    (void)seed;
+    uint64_t low = 0;
+    memcpy(&low, data, size < 1 ? size : 1);
+    return low & 0x7F;
+}
+
+static size_t summed_values;
+
+void sum_dictionary_values(const T* key, T* value) {
+    (void)key;
+    summed_values += (size_t)*((int*)value->data);
+}
+
+void test_dictionary() {
+    // Test Creation
+    ReturnDictionary created = Dictionary_create(sizeof(int), sizeof(int));
+    assert(created.error == NO_ERROR);
+    Dictionary* dict = created.dict;
+    assert(Dictionary_size(dict) == 0);
+    assert(Dictionary_get(dict, &(T){sizeof(int), &(int){1}}).error ==
+           ERROR_NOT_FOUND);
+
+    // Test insert, get and overwrite
+    for (int i = 0; i < 1000; i++) {
+        int value = i * 3;
+        T key = {sizeof(int), &i};
+        assert(Dictionary_insert(dict, &key, &(T){sizeof(int), &value})
+                   .error == NO_ERROR);
+    }
+    assert(Dictionary_size(dict) == 1000);
+    for (int i = 0; i < 1000; i++) {
+        ReturnView found = Dictionary_get(dict, &(T){sizeof(int), &i});
+        assert(found.error == NO_ERROR);
+        assert(*((int*)found.value.data) == i * 3);
+    }
+    Dictionary_insert(dict, &(T){sizeof(int), &(int){7}},
+                      &(T){sizeof(int), &(int){-7}});
+    assert(Dictionary_size(dict) == 1000);
+    assert(*((int*)Dictionary_get(dict, &(T){sizeof(int), &(int){7}})
+                .value.data) == -7);
+
+    // Test two lookups can be held at once without aliasing
+    T seven = Dictionary_get(dict, &(T){sizeof(int), &(int){7}}).value;
+    T eight = Dictionary_get(dict, &(T){sizeof(int), &(int){8}}).value;
+    assert(*((int*)seven.data) == -7 && *((int*)eight.data) == 24);
+
+    // Test bad sizes
+    assert(Dictionary_insert(dict, &(T){sizeof(char), &(char){1}},
+                             &(T){sizeof(int), &(int){1}})
+               .error == ERROR);
+    assert(Dictionary_insert(dict, NULL, &(T){sizeof(int), &(int){1}})
+               .error == ERROR_NULL);
+
+    // Test remove every other key
+    for (int i = 0; i < 1000; i += 2) {
+        assert(Dictionary_remove(dict, &(T){sizeof(int), &i}).error ==
+               NO_ERROR);
+    }
+    assert(Dictionary_remove(dict, &(T){sizeof(int), &(int){0}}).error ==
+           ERROR_NOT_FOUND);
+    assert(Dictionary_size(dict) == 500);
+    for (int i = 0; i < 1000; i++) {
+        ReturnBool present = Dictionary_contains(dict, &(T){sizeof(int), &i});
+        assert(present.error == NO_ERROR);
+        assert(present.value == (i % 2 == 1));
+    }
+
+    // Test iterate
+    summed_values = 0;
+    Dictionary_iterate(dict, sum_dictionary_values);
+    assert(summed_values == 3 * 500 * 500 - 7 - 21);
+
+    // Test reserve keeps entries and clear empties the table
+    size_t capacity = dict->capacity;
+    assert(Dictionary_reserve(dict, 100000).error == NO_ERROR);
+    assert(dict->capacity > capacity);
+    assert(Dictionary_contains(dict, &(T){sizeof(int), &(int){999}}).value);
+    capacity = dict->capacity;
+    for (int i = 0; i < 100000; i++) {
+        Dictionary_insert(dict, &(T){sizeof(int), &i},
+                          &(T){sizeof(int), &i});
+    }
+    assert(dict->capacity == capacity);
+    Dictionary_clear(dict);
+    assert(Dictionary_size(dict) == 0);
+    assert(!Dictionary_contains(dict, &(T){sizeof(int), &(int){3}}).value);
+
+    assert(Dictionary_destroy(&dict).error == NO_ERROR);
+    assert(dict == NULL);
+
+    // Test byte string keys with a hash that puts everything in one run
+    created = Dictionary_create_with_hash(0, sizeof(int), colliding_hash, 0);
+    assert(created.error == NO_ERROR);
+    dict = created.dict;
+    const char* words[] = {"apple", "avocado", "banana", "", "apricot",
+                           "blueberry", "a", "almond", "berry", "acorn"};
+    for (int i = 0; i < 10; i++) {
+        T key = {strlen(words[i]), (void*)words[i]};
+        assert(Dictionary_insert(dict, &key, &(T){sizeof(int), &i}).error ==
+               NO_ERROR);
+    }
+    assert(Dictionary_size(dict) == 10);
+    assert(Dictionary_remove(dict, &(T){5, "apple"}).error == NO_ERROR);
+    assert(Dictionary_remove(dict, &(T){0, ""}).error == NO_ERROR);
+    assert(Dictionary_remove(dict, &(T){2, "ap"}).error == ERROR_NOT_FOUND);
+    for (int i = 0; i < 10; i++) {
+        ReturnView found =
+            Dictionary_get(dict, &(T){strlen(words[i]), (void*)words[i]});
+        if (i == 0 || i == 3) {
+            assert(found.error == ERROR_NOT_FOUND);
+        } else {
+            assert(found.error == NO_ERROR);
+            assert(*((int*)found.value.data) == i);
+        }
+    }
+    Dictionary_destroy(&dict);
+}
+
+#define CONCURRENT_THREADS 8
+#define CONCURRENT_KEYS 100
+#define CONCURRENT_ROUNDS 10000
+
+typedef struct ConcurrentTestTask {
+    ConcurrentDictionary* dict;
+    int id;
+    size_t inserted;
+} ConcurrentTestTask;
+
+// Adds one to the counter, removing it once it reaches the context's limit
+bool count_up(const T* key, T* value, bool present, void* context) {
+    (void)key;
+    int* counter = (int*)value->data;
+    assert(present == (*counter != 0));
+    *counter += 1;
+    return *counter != *((int*)context);
+}
+
+void* concurrent_worker(void* arg) {
+    ConcurrentTestTask* task = (ConcurrentTestTask*)arg;
+    int never = -1;
+
+    for (int i = 0; i < CONCURRENT_ROUNDS; i++) {
+        int key = (i * 31 + task->id) % CONCURRENT_KEYS;
+        ConcurrentDictionary_compute(task->dict, &(T){sizeof(int), &key},
+                                     count_up, &never);
+
+        // Every thread races to claim the same keys, only one may win each
+        int claim = CONCURRENT_KEYS + i % 64;
+        int owner = 0;
+        ReturnBool won = ConcurrentDictionary_get_or_insert(
+            task->dict, &(T){sizeof(int), &claim},
+            &(T){sizeof(int), &task->id}, &(T){sizeof(int), &owner});
+        assert(won.error == NO_ERROR);
+        assert(!won.value || owner == task->id);
+        task->inserted += won.value;
+    }
+    return NULL;
+}
+
+void test_concurrent_dictionary() {
+    // Test shard count must be a power of two
+    assert(ConcurrentDictionary_create(sizeof(int), sizeof(int), 3).error ==
+           ERROR);
+
+    ReturnConcurrentDictionary created =
+        ConcurrentDictionary_create(sizeof(int), sizeof(int), 16);
+    assert(created.error == NO_ERROR);
+    ConcurrentDictionary* dict = created.dict;
+
+    // Test single threaded basics
+    int value = 0;
+    T out = {sizeof(int), &value};
+    assert(ConcurrentDictionary_insert(dict, &(T){sizeof(int), &(int){1}},
+                                       &(T){sizeof(int), &(int){10}})
+               .error == NO_ERROR);
+    assert(ConcurrentDictionary_get(dict, &(T){sizeof(int), &(int){1}}, &out)
+               .error == NO_ERROR);
+    assert(value == 10);
+    assert(ConcurrentDictionary_contains(dict, &(T){sizeof(int), &(int){1}})
+               .value);
+    assert(ConcurrentDictionary_remove(dict, &(T){sizeof(int), &(int){1}})
+               .error == NO_ERROR);
+    assert(ConcurrentDictionary_get(dict, &(T){sizeof(int), &(int){1}}, &out)
+               .error == ERROR_NOT_FOUND);
+
+    // Test compute removes when told to
+    int limit = 2;
+    T key = {sizeof(int), &(int){5}};
+    assert(ConcurrentDictionary_compute(dict, &key, count_up, &limit).value);
+    assert(!ConcurrentDictionary_compute(dict, &key, count_up, &limit).value);
+    assert(ConcurrentDictionary_size(dict) == 0);
+
+    // Test many threads updating the same keys
+    assert(ConcurrentDictionary_reserve(dict, 1000).error == NO_ERROR);
+    pthread_t threads[CONCURRENT_THREADS];
+    ConcurrentTestTask tasks[CONCURRENT_THREADS];
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        tasks[i] = (ConcurrentTestTask){dict, i + 1, 0};
+        assert(pthread_create(&threads[i], NULL, concurrent_worker,
+                              &tasks[i]) == 0);
+    }
+    size_t inserted = 0;
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        inserted += tasks[i].inserted;
+    }
+    assert(inserted == 64);
+    assert(ConcurrentDictionary_size(dict) == CONCURRENT_KEYS + 64);
+
+    int total = 0;
+    for (int i = 0; i < CONCURRENT_KEYS; i++) {
+        assert(ConcurrentDictionary_get(dict, &(T){sizeof(int), &i}, &out)
+                   .error == NO_ERROR);
+        total += value;
+    }
+    assert(total == CONCURRENT_THREADS * CONCURRENT_ROUNDS);
+
+    assert(ConcurrentDictionary_destroy(&dict).error == NO_ERROR);
+    assert(dict == NULL);
+}
@@ -0,0 +1,13 @@
+#ifndef TEST_DICTIONARY_H
+#define TEST_DICTIONARY_H
+
+#include <assert.h>
+#include <pthread.h>
+
+#include "../src/data_structures/dictionaries/concurrent_dictionary.h"
+#include "../src/data_structures/dictionaries/dictionary.h"
+
+void test_dictionary();
+void test_concurrent_dictionary();
+
+#endif
@@ -0,0 +1,153 @@
+#include "test_dlist.h"
+
+int compare_dlist(const DListNode* a, const DListNode* b) {
+    int value_a = *((const int*)a->data);
+    int value_b = *((const int*)b->data);
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+int compare_dlist_key(const DListNode* a, const DListNode* b) {
+    int key_a = ((const int*)a->data)[0];
+    int key_b = ((const int*)b->data)[0];
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+void double_dlist_val(const void* element) { *((int*)element) *= 2; }
+
+void* counting_dlist_alloc(void* context, size_t size) {
+    (*(size_t*)context)++;
+    return malloc(size);
+}
+
+void counting_dlist_free(void* context, void* ptr, size_t size) {
+    (void)size;
+    (*(size_t*)context)--;
+    free(ptr);
+}
+
+// Checks the prev links and the tail agree with the next links
+static void check_links(DList* list) {
+    DListNode* prev = NULL;
+    DListNode* current = *(list->head);
+    size_t count = 0;
+    while (current != NULL) {
+        assert(current->prev == prev);
+        prev = current;
+        current = current->next;
+        count++;
+    }
+    assert(list->tail == prev);
+    assert(count == list->size);
+}
+
+void test_dlist() {
+    // Test Creation
+    DList* list = DList_create(sizeof(int));
+    assert(list != NULL);
+    assert(list->data_size == sizeof(int));
+    assert(DList_size(list) == 0);
+    assert(list->head != NULL);
+    assert(list->tail == NULL);
+
+    // Test Adding a bunch
+    DList_append(list, &(int){42});     // {42}
+    DList_prepend(list, &(int){7});     // {7, 42}
+    DList_append(list, &(int){98});     // {7, 42, 98}
+    DList_insert(list, &(int){15}, 1);  // {7, 15, 42, 98}
+    DList_insert(list, &(int){60}, 3);  // {7, 15, 42, 60, 98}
+    DList_insert(list, &(int){1}, 9);   // out of range, ignored
+    assert(DList_size(list) == 5);
+    assert(*((int*)DList_get(list, 0)->data) == 7);
+    assert(*((int*)DList_get(list, 1)->data) == 15);
+    assert(*((int*)DList_get(list, 3)->data) == 60);
+    assert(*((int*)DList_get(list, 4)->data) == 98);
+    assert(DList_get(list, 5) == NULL);
+    check_links(list);
+
+    // Test find
+    assert(DList_find(list, &(int){60}) == 3);
+    assert(DList_find(list, &(int){61}) == SIZE_MAX);
+
+    // Test removing
+    DList_remove(list, 3);                     // {7, 15, 42, 98}
+    DList_remove_node(list, list->tail);       // {7, 15, 42}
+    DList_remove_node(list, *(list->head));    // {15, 42}
+    assert(DList_size(list) == 2);
+    assert(*((int*)DList_get(list, 0)->data) == 15);
+    assert(*((int*)list->tail->data) == 42);
+    check_links(list);
+
+    // Test popping from both ends
+    int popped = 0;
+    assert(DList_pop_back(list, &popped) && popped == 42);
+    assert(DList_pop_front(list, &popped) && popped == 15);
+    assert(!DList_pop_front(list, &popped));
+    assert(!DList_pop_back(list, NULL));
+    assert(*(list->head) == NULL && list->tail == NULL);
+
+    int vals[] = {37, -12, 94, 0, -56, 789, 23, -987, 456, -72};
+    int sorted[] = {-987, -72, -56, -12, 0, 23, 37, 94, 456, 789};
+
+    for (size_t i = 0; i < 10; i++) {
+        DList_append(list, &vals[i]);
+    }
+
+    // Test swap, adjacent both ways and apart
+    DList_swap(list, 0, 1);  // {-12, 37, 94, ...}
+    DList_swap(list, 2, 1);  // {-12, 94, 37, ...}
+    DList_swap(list, 0, 9);  // {-72, 94, 37, ..., -12}
+    assert(*((int*)DList_get(list, 0)->data) == -72);
+    assert(*((int*)DList_get(list, 1)->data) == 94);
+    assert(*((int*)DList_get(list, 2)->data) == 37);
+    assert(*((int*)DList_get(list, 9)->data) == -12);
+    check_links(list);
+
+    // Test sort
+    DList_sort(list, compare_dlist);
+    for (size_t i = 0; i < 10; i++) {
+        assert(*((int*)DList_get(list, i)->data) == sorted[i]);
+    }
+    check_links(list);
+
+    // Test Iterate
+    DList_iterate(list, double_dlist_val);
+    assert(*((int*)list->tail->data) == 1578);
+
+    // Test Clear and Destroy
+    DList_clear(list);
+    assert(DList_size(list) == 0);
+    assert(list->tail == NULL);
+    DList_destroy(&list);
+    assert(list == NULL);
+
+    // Test sort is stable on a larger list, pairs of {key, insertion order}
+    list = DList_create(2 * sizeof(int));
+    for (int i = 0; i < 1000; i++) {
+        int pair[2] = {(i * 7919) % 13, i};
+        DList_append(list, pair);
+    }
+    DList_sort(list, compare_dlist_key);
+    check_links(list);
+    for (DListNode* node = *(list->head); node->next != NULL;
+         node = node->next) {
+        int* a = node->data;
+        int* b = node->next->data;
+        assert(a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]));
+    }
+    DList_destroy(&list);
+
+    // Test custom allocator, one block per node
+    size_t live_blocks = 0;
+    Allocator counting = {counting_dlist_alloc, NULL, counting_dlist_free,
+                          &live_blocks};
+    list = DList_create_with_allocator(sizeof(int), &counting);
+    assert(list != NULL);
+    for (size_t i = 0; i < 10; i++) {
+        DList_append(list, &vals[i]);
+    }
+    assert(live_blocks == 12);
+    DList_pop_front(list, NULL);
+    assert(live_blocks == 11);
+    DList_destroy(&list);
+    assert(live_blocks == 0);
+}
@@ -0,0 +1,11 @@
+#ifndef TEST_DLIST_H
+#define TEST_DLIST_H
+
+#include <assert.h>
+#include <limits.h>
+
+#include "../src/data_structures/dlists/dlist.h"
+
+void test_dlist();
+
+#endif
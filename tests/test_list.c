@@ -2,8 +2,8 @@
 
 void print_list(const void* element) { printf("%d ", *((int*)element)); }
 int compare_list(const ListNode* a, const ListNode* b) {
-    int value_a = *((int*)(a->data));
-    int value_b = *((int*)(b->data));
+    int value_a = *((const int*)ListNode_const_data(a));
+    int value_b = *((const int*)ListNode_const_data(b));
 
     if (value_a < value_b) {
         return -1;
@@ -16,8 +16,73 @@ int compare_list(const ListNode* a, const ListNode* b) {
 
 // int compare_int_list()
 
+int compare_list_key(const ListNode* a, const ListNode* b) {
+    int key_a = ((const int*)ListNode_const_data(a))[0];
+    int key_b = ((const int*)ListNode_const_data(b))[0];
+    return (key_a > key_b) - (key_a < key_b);
+}
+
 void double_list_val(const void* element) { *((int*)element) *= 2; }
 
+bool sum_until_limit(void* element, void* context) {
+    int* sum = (int*)context;
+    *sum += *((int*)element);
+    return *sum > -100;
+}
+
+typedef struct Job {
+    int priority;
+    int id;
+} Job;
+
+static inline int compare_long(const long* a, const long* b) {
+    return (*a > *b) - (*a < *b);
+}
+
+static inline int compare_job_priority(const Job* a, const Job* b) {
+    return (a->priority > b->priority) - (a->priority < b->priority);
+}
+
+DEFINE_LIST(LongList, long)
+DEFINE_LIST_ORDER(LongList, long, compare_long)
+DEFINE_LIST(JobList, Job)
+DEFINE_LIST_ORDER(JobList, Job, compare_job_priority)
+
+#define LIST_TYPES(op) LIST_ENTRY(LongList, op), LIST_ENTRY(JobList, op)
+#define LIST_ORDERED_TYPES(op) LIST_TYPES(op)
+
+bool sum_longs(long* element, void* context) {
+    *(long*)context += *element;
+    return true;
+}
+
+void* counting_list_alloc(void* context, size_t size) {
+    (*(size_t*)context)++;
+    return malloc(size);
+}
+
+void counting_list_free(void* context, void* ptr, size_t size) {
+    (void)size;
+    (*(size_t*)context)--;
+    free(ptr);
+}
+
+// Allocator that fails once the budget in its context runs out
+void* budget_list_alloc(void* context, size_t size) {
+    size_t* budget = (size_t*)context;
+    if (*budget == 0) {
+        return NULL;
+    }
+    (*budget)--;
+    return malloc(size);
+}
+
+void budget_list_free(void* context, void* ptr, size_t size) {
+    (void)context;
+    (void)size;
+    free(ptr);
+}
+
 void test_list() {
     // Test Creation
     List* list = List_create(sizeof(int));
@@ -34,23 +99,23 @@ void test_list() {
     assert(list != NULL);
     assert(list->head != NULL);
     assert(List_size(list) == 1);
-    assert(*((int*)(List_get(list, 0)->data)) == 42);
+    assert(*((int*)List_get_data(list, 0)) == 42);
 
     // Test Adding a bunch
     List_prepend(list, &(int){7});     // insert in front {7, 42}
     List_append(list, &(int){98});     // insert at back {7, 42, 98}
     List_insert(list, &(int){15}, 1);  // insert in middle {7, 15, 42 98}
     assert(List_size(list) == 4);
-    assert(*((int*)(List_get(list, 0)->data)) == 7);
-    assert(*((int*)(List_get(list, List_size(list) - 1)->data)) == 98);
-    assert(*((int*)(List_get(list, 1)->data)) == 15);
+    assert(*((int*)List_get_data(list, 0)) == 7);
+    assert(*((int*)List_get_data(list, List_size(list) - 1)) == 98);
+    assert(*((int*)List_get_data(list, 1)) == 15);
 
     // Test removing
     List_remove(list, 1);                    // remove middle {7, 42, 98}
     List_remove(list, List_size(list) - 1);  // remove back {7, 42}
     List_remove(list, 0);                    // remove front {42}
     assert(List_size(list) == 1);
-    assert(*((int*)(List_get(list, 0)->data)) == 42);
+    assert(*((int*)List_get_data(list, 0)) == 42);
 
     // Test clearing
     List_clear(list);
@@ -67,7 +132,7 @@ void test_list() {
     for (size_t i = 0; i < 10; i++) {
         List_append(list, &vals[i]);
         assert(List_size(list) == (i + 1));
-        assert(*((int*)(List_get(list, i)->data)) == vals[i]);
+        assert(*((int*)List_get_data(list, i)) == vals[i]);
     }
 
     // Test find
@@ -76,18 +141,201 @@ void test_list() {
     // Test sort
     List_sort(list, compare_list);
     for (size_t i = 0; i < 10; i++) {
-        assert(*((int*)(List_get(list, i)->data)) == sorted[i]);
+        assert(*((int*)List_get_data(list, i)) == sorted[i]);
     }
 
     // Test Iterate
     List_iterate(list, double_list_val);
     for (size_t i = 0; i < 10; i++) {
-        assert(*((int*)(List_get(list, i)->data)) == doubled[i]);
+        assert(*((int*)List_get_data(list, i)) == doubled[i]);
+    }
+
+    // Test the tail follows sorting and removal
+    assert(list->tail == List_get(list, 9));
+    assert(*((int*)ListNode_data(list->tail)) == 1578);
+    List_remove(list, 9);
+    assert(*((int*)ListNode_data(list->tail)) == 912);
+    List_insert(list, &(int){1}, 20);  // out of range, ignored
+    assert(List_size(list) == 9);
+
+    // Test concat and splice {-1974, ..., 912} + {1, 2, 3}
+    List* other = List_create(sizeof(int));
+    for (int i = 1; i <= 3; i++) {
+        List_append(other, &i);
     }
+    List_concat(list, other);
+    assert(List_size(list) == 12);
+    assert(List_size(other) == 0);
+    assert(*(other->head) == NULL && other->tail == NULL);
+    assert(*((int*)List_get_data(list, 9)) == 1);
+    assert(*((int*)ListNode_data(list->tail)) == 3);
+
+    List_append(other, &(int){-1});
+    List_append(other, &(int){-2});
+    List_splice(list, 0, other);  // {-1, -2, -1974, ...}
+    assert(List_size(list) == 14);
+    assert(*((int*)List_get_data(list, 0)) == -1);
+    assert(*((int*)List_get_data(list, 2)) == -1974);
+    List_append(other, &(int){100});
+    List_splice(list, 5, other);  // {..., -144, -112, 100, -24, ...}
+    assert(*((int*)List_get_data(list, 5)) == 100);
+    assert(*((int*)List_get_data(list, 6)) == -24);
+    assert(List_size(list) == 15);
+    assert(*((int*)ListNode_data(list->tail)) == 3);
+    List_destroy(&other);
+
+    // Test iterate with context and early exit {-1, -2, -1974, ...}
+    int sum = 0;
+    assert(List_iterate_ctx(list, sum_until_limit, &sum) == 3);
+    assert(sum == -1977);
+
+    // Test cursor, drop every negative value and tag the rest
+    List_clear(list);
+    for (int i = -3; i <= 3; i++) {
+        List_append(list, &i);
+    }
+    ListCursor cursor = List_cursor(list);
+    while (!ListCursor_at_end(&cursor)) {
+        int value = *((int*)ListCursor_get(&cursor));
+        if (value < 0) {
+            ListCursor_remove(&cursor);
+        } else {
+            ListCursor_insert_before(&cursor, &(int){value + 10});
+            ListCursor_next(&cursor);
+        }
+    }
+    ListCursor_insert_before(&cursor, &(int){99});  // appends at the end
+    int filtered[] = {10, 0, 11, 1, 12, 2, 13, 3, 99};
+    assert(List_size(list) == 9);
+    for (size_t i = 0; i < 9; i++) {
+        assert(*((int*)List_get_data(list, i)) == filtered[i]);
+    }
+    assert(*((int*)ListNode_data(list->tail)) == 99);
+
+    cursor = List_cursor(list);
+    ListCursor_insert_after(&cursor, &(int){-5});  // {10, -5, 0, ...}
+    assert(*((int*)ListCursor_get(&cursor)) == 10);
+    assert(ListCursor_next(&cursor));
+    assert(*((int*)ListCursor_get(&cursor)) == -5);
+    while (ListCursor_next(&cursor)) {
+    }
+    assert(ListCursor_get(&cursor) == NULL);
+    assert(List_size(list) == 10);
+
+    // Test removing the last node through a cursor moves the tail back
+    cursor = List_cursor(list);
+    for (size_t i = 0; i < 9; i++) {
+        ListCursor_next(&cursor);
+    }
+    ListCursor_remove(&cursor);
+    assert(ListCursor_at_end(&cursor));
+    assert(*((int*)ListNode_data(list->tail)) == 3);
 
     // Test Destroy
     List_destroy(&list);
     assert(list == NULL);
+
+    // Test sort is stable, pairs of {key, insertion order}
+    list = List_create(2 * sizeof(int));
+    for (int i = 0; i < 1000; i++) {
+        int pair[2] = {(i * 7919) % 13, i};
+        List_append(list, pair);
+    }
+    List_sort(list, compare_list_key);
+    assert(List_size(list) == 1000);
+    ListCursor pairs = List_cursor(list);
+    int* prev_pair = ListCursor_get(&pairs);
+    while (ListCursor_next(&pairs)) {
+        int* pair = ListCursor_get(&pairs);
+        assert(prev_pair[0] < pair[0] ||
+               (prev_pair[0] == pair[0] && prev_pair[1] < pair[1]));
+        prev_pair = pair;
+    }
+    assert(ListNode_data(list->tail) == prev_pair);
+    List_destroy(&list);
+
+    // Test custom allocator
+    size_t live_blocks = 0;
+    Allocator counting = {counting_list_alloc, NULL, counting_list_free,
+                          &live_blocks};
+    list = List_create_with_allocator(sizeof(int), &counting);
+    assert(list != NULL);
+    for (size_t i = 0; i < 10; i++) {
+        List_append(list, &vals[i]);
+    }
+    // The list, its head and one chunk of nodes
+    assert(live_blocks == 3);
+
+    // Test removed nodes are reused
+    ListNode* removed = List_get(list, 3);
+    List_remove(list, 3);
+    assert(List_size(list) == 9);
+    List_append(list, &(int){5});
+    assert(List_get(list, 9) == removed);
+    assert(*((int*)List_get_data(list, 9)) == 5);
+
+    // Test concat across allocators copies and frees the source chunks
+    List* copied = List_create(sizeof(int));
+    List_append(copied, &(int){6});
+    List_concat(list, copied);
+    assert(List_size(list) == 11);
+    assert(*((int*)List_get_data(list, 10)) == 6);
+    assert(List_size(copied) == 0);
+    List_destroy(&copied);
+
+    // Test concat with the same allocator hands over the chunks
+    List* moved = List_create_with_allocator(sizeof(int), &counting);
+    List_append(moved, &(int){8});
+    assert(live_blocks == 6);
+    List_concat(list, moved);
+    List_destroy(&moved);
+    assert(live_blocks == 4);
+    assert(*((int*)List_get_data(list, 11)) == 8);
+
+    // Test the unused slots of both chunks are kept for reuse
+    for (int i = 0; i < 50; i++) {
+        List_append(list, &i);
+    }
+    assert(live_blocks == 4);
+    assert(*((int*)List_get_data(list, 61)) == 49);
+
+    // Test splicing copies across allocators keep their order
+    List* middle = List_create(sizeof(int));
+    for (int i = 1; i <= 3; i++) {
+        List_append(middle, &(int){i * 100});
+    }
+    List_splice(list, 2, middle);
+    assert(List_size(list) == 65);
+    assert(List_size(middle) == 0);
+    for (size_t i = 0; i < 3; i++) {
+        assert(*((int*)List_get_data(list, 2 + i)) == (int)(i + 1) * 100);
+    }
+    assert(*((int*)List_get_data(list, 5)) == vals[2]);
+    List_destroy(&middle);
+
+    // Test a copy that runs out of memory leaves both lists unchanged
+    size_t budget = 3;
+    Allocator limited = {budget_list_alloc, NULL, budget_list_free, &budget};
+    List* small = List_create_with_allocator(sizeof(int), &limited);
+    List_append(small, &(int){-5});
+    List* many = List_create(sizeof(int));
+    for (int i = 0; i < 40; i++) {
+        List_append(many, &i);
+    }
+    List_splice(small, 0, many);
+    assert(List_size(small) == 1);
+    assert(List_size(many) == 40);
+    assert(*((int*)List_get_data(small, 0)) == -5);
+    assert(*((int*)List_get_data(many, 39)) == 39);
+    List_append(small, &(int){-6});
+    assert(List_size(small) == 2);
+    List_destroy(&many);
+    List_destroy(&small);
+
+    List_clear(list);
+    assert(live_blocks == 2);
+    List_destroy(&list);
+    assert(live_blocks == 0);
 }
 
 void test_int_list() {
@@ -157,7 +405,105 @@ void test_int_list() {
         assert(IntList_get(list, i) == doubled[i]);
     }
 
+    // Test sort on a larger list, including duplicates and extremes
+    IntList_clear(list);
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < 5000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        IntList_append(list, (int)(seed >> 8) % 1000 - 500);
+    }
+    IntList_append(list, INT_MIN);
+    IntList_prepend(list, INT_MAX);
+    IntList_sort(list);
+    assert(IntList_size(list) == 5002);
+    assert(IntList_get(list, 0) == INT_MIN);
+    assert(IntList_get(list, 5001) == INT_MAX);
+    ListCursor cursor = List_cursor(list);
+    int previous = *((int*)ListCursor_get(&cursor));
+    while (ListCursor_next(&cursor)) {
+        int value = *((int*)ListCursor_get(&cursor));
+        assert(previous <= value);
+        previous = value;
+    }
+
     // Test Destroy
     IntList_destroy(&list);
     assert(list == NULL);
-}
\ No newline at end of file
+}
+
+void test_typed_list() {
+    // Test Create
+    LongList* longs = LongList_create();
+    assert(longs != NULL);
+    assert(LongList_size(longs) == 0);
+    assert(LongList_list(longs)->data_size == sizeof(long));
+
+    // Test Append, Prepend, Insert and Get
+    for (long i = 1; i <= 5; i++) {
+        LongList_append(longs, i * 10);
+    }
+    LongList_prepend(longs, 0);
+    LongList_insert(longs, 25, 3);
+    assert(LongList_size(longs) == 7);
+    long expected[] = {0, 10, 20, 25, 30, 40, 50};
+    for (size_t i = 0; i < 7; i++) {
+        assert(LongList_get(longs, i) == expected[i]);
+    }
+    assert(*LongList_front(longs) == 0);
+    assert(*LongList_back(longs) == 50);
+    assert(LongList_at(longs, 7) == NULL);
+
+    // Test Iterate and Find
+    long sum = 0;
+    assert(LongList_iterate(longs, sum_longs, &sum) == 7);
+    assert(sum == 175);
+    assert(LongList_find(longs, 25) == 3);
+    assert(LongList_find(longs, 26) == SIZE_MAX);
+
+    // Test Remove and writing through At
+    LongList_remove(longs, 3);
+    *LongList_at(longs, 0) = -1;
+    assert(LongList_get(longs, 0) == -1);
+    assert(LongList_size(longs) == 6);
+
+    // Test Sort on a larger list, including duplicates
+    LongList_clear(longs);
+    unsigned int seed = 4242;
+    for (size_t i = 0; i < 3000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        LongList_append(longs, (long)(seed >> 8) % 200 - 100);
+    }
+    LongList_sort(longs);
+    ListCursor cursor = List_cursor(LongList_list(longs));
+    long previous = *((long*)ListCursor_get(&cursor));
+    while (ListCursor_next(&cursor)) {
+        long value = *((long*)ListCursor_get(&cursor));
+        assert(previous <= value);
+        previous = value;
+    }
+    assert(*LongList_back(longs) == previous);
+    LongList_destroy(&longs);
+    assert(longs == NULL);
+
+    // Test a list of structs through the _Generic macros, sort is stable
+    JobList* jobs = JobList_create();
+    int priorities[] = {3, 1, 2, 1, 3, 2};
+    for (int i = 0; i < 6; i++) {
+        TypedList_append(jobs, ((Job){.priority = priorities[i], .id = i}));
+    }
+    assert(TypedList_size(jobs) == 6);
+    TypedList_sort(jobs);
+    int sorted_ids[] = {1, 3, 2, 5, 0, 4};
+    for (size_t i = 0; i < 6; i++) {
+        assert(TypedList_get(jobs, i).id == sorted_ids[i]);
+    }
+    assert(TypedList_front(jobs)->priority == 1);
+    assert(TypedList_back(jobs)->id == 4);
+    assert(TypedList_find(jobs, ((Job){.priority = 2})) == 2);
+    TypedList_remove(jobs, 0);
+    assert(TypedList_at(jobs, 0)->id == 3);
+    TypedList_clear(jobs);
+    assert(TypedList_size(jobs) == 0);
+    JobList_destroy(&jobs);
+    assert(jobs == NULL);
+}
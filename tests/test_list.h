@@ -2,11 +2,14 @@
 #define TEST_LIST_H
 
 #include <assert.h>
+#include <limits.h>
 
 #include "../src/data_structures/lists/int_list.h"
 #include "../src/data_structures/lists/list.h"
+#include "../src/data_structures/lists/typed_list.h"
 
 void test_list();
 void test_int_list();
+void test_typed_list();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "test_priority_queue.h"
+
+int compare_priorities(const T* a, const T* b) {
+    int x = *((const int*)a->data);
+    int y = *((const int*)b->data);
+    return (x > y) - (x < y);
+}
+
+// Pops everything and checks it comes out in order
+void check_pops_sorted(PriorityQueue* queue, size_t expected) {
+    int previous = INT_MIN;
+    int out = 0;
+    for (size_t i = 0; i < expected; i++) {
+        assert(PriorityQueue_pop(queue, &(T){sizeof(int), &out}).error ==
+               NO_ERROR);
+        assert(out >= previous);
+        previous = out;
+    }
+    assert(PriorityQueue_is_empty(queue).value);
+}
+
+void test_priority_queue() {
+    // Test Creation
+    assert(PriorityQueue_create(sizeof(int), compare_priorities, 3).error ==
+           ERROR);
+    assert(PriorityQueue_create(sizeof(int), NULL, 2).error == ERROR_NULL);
+
+    size_t arities[2] = {2, 4};
+    for (size_t a = 0; a < 2; a++) {
+        PriorityQueue* queue =
+            PriorityQueue_create(sizeof(int), compare_priorities, arities[a])
+                .queue;
+        assert(queue != NULL);
+        int out = 0;
+        assert(PriorityQueue_pop(queue, &(T){sizeof(int), &out}).error ==
+               ERROR_INDEX);
+        assert(PriorityQueue_peek(queue).error == ERROR_INDEX);
+
+        // Test push in scrambled order, with duplicates
+        for (int i = 0; i < 1000; i++) {
+            int value = (i * 7919) % 500;
+            ReturnSizeT push_result =
+                PriorityQueue_push(queue, &(T){sizeof(int), &value});
+            assert(push_result.error == NO_ERROR);
+            assert(push_result.value == SIZE_MAX);
+        }
+        assert(PriorityQueue_size(queue).value == 1000);
+        assert(*((int*)PriorityQueue_peek(queue).value.data) == 0);
+
+        // Test push_pop returns a smaller element without touching the heap
+        assert(PriorityQueue_push_pop(queue, &(T){sizeof(int), &(int){-5}},
+                                      &(T){sizeof(int), &out})
+                   .error == NO_ERROR);
+        assert(out == -5);
+        assert(PriorityQueue_push_pop(queue, &(T){sizeof(int), &(int){600}},
+                                      &(T){sizeof(int), &out})
+                   .error == NO_ERROR);
+        assert(out == 0);
+
+        // Test replace always returns the old top
+        assert(PriorityQueue_replace(queue, &(T){sizeof(int), &(int){-7}},
+                                     &(T){sizeof(int), &out})
+                   .error == NO_ERROR);
+        assert(out == 0);
+        assert(*((int*)PriorityQueue_peek(queue).value.data) == -7);
+        assert(PriorityQueue_size(queue).value == 1000);
+
+        check_pops_sorted(queue, 1000);
+        assert(PriorityQueue_destroy(&queue).error == NO_ERROR);
+        assert(queue == NULL);
+
+        // Test heapify from an Array leaves the Array alone
+        Array* arr = Array_create(sizeof(int), 1).arr;
+        for (int i = 0; i < 777; i++) {
+            int value = (i * 389) % 777;
+            Array_append(arr, &(T){sizeof(int), &value});
+        }
+        queue = PriorityQueue_heapify(arr, compare_priorities, arities[a])
+                    .queue;
+        assert(PriorityQueue_size(queue).value == 777);
+        assert(*((int*)Array_get(arr, 1).value.data) == 389);
+
+        // Test pushing the top of the full queue back into it
+        T top = PriorityQueue_peek(queue).value;
+        assert(PriorityQueue_push(queue, &top).error == NO_ERROR);
+        PriorityQueue_pop(queue, &(T){sizeof(int), &out});
+        assert(out == 0);
+        for (int i = 0; i < 777; i++) {
+            PriorityQueue_pop(queue, &(T){sizeof(int), &out});
+            assert(out == i);
+        }
+        PriorityQueue_destroy(&queue);
+        Array_destroy(&arr);
+    }
+
+    // Test indexed queues
+    PriorityQueue* queue =
+        PriorityQueue_create_indexed(sizeof(int), compare_priorities, 4).queue;
+    size_t handles[100];
+    for (int i = 0; i < 100; i++) {
+        int value = 1000 + i;
+        ReturnSizeT push_result =
+            PriorityQueue_push(queue, &(T){sizeof(int), &value});
+        assert(push_result.error == NO_ERROR);
+        handles[i] = push_result.value;
+    }
+    assert(*((int*)PriorityQueue_get(queue, handles[42]).value.data) ==
+           1042);
+    assert(PriorityQueue_replace(queue, &(T){sizeof(int), &(int){0}}, NULL)
+               .error == ERROR);
+
+    // Test decrease_key moves an element to the top
+    assert(PriorityQueue_decrease_key(queue, handles[99],
+                                      &(T){sizeof(int), &(int){5}})
+               .error == NO_ERROR);
+    assert(*((int*)PriorityQueue_peek(queue).value.data) == 5);
+    assert(PriorityQueue_decrease_key(queue, handles[99],
+                                      &(T){sizeof(int), &(int){6}})
+               .error == ERROR);
+
+    // Test remove by handle, handles of other elements stay valid
+    int out = 0;
+    for (int i = 0; i < 50; i += 2) {
+        assert(PriorityQueue_remove(queue, handles[i],
+                                    &(T){sizeof(int), &out})
+                   .error == NO_ERROR);
+        assert(out == 1000 + i);
+    }
+    assert(PriorityQueue_remove(queue, handles[0], NULL).error ==
+           ERROR_NOT_FOUND);
+    assert(PriorityQueue_get(queue, handles[2]).error == ERROR_NOT_FOUND);
+    for (int i = 1; i < 50; i += 2) {
+        assert(*((int*)PriorityQueue_get(queue, handles[i]).value.data) ==
+               1000 + i);
+    }
+
+    // Test popping frees the top handle and a push reuses it
+    PriorityQueue_pop(queue, &(T){sizeof(int), &out});
+    assert(out == 5);
+    assert(PriorityQueue_get(queue, handles[99]).error == ERROR_NOT_FOUND);
+    ReturnSizeT push_result =
+        PriorityQueue_push(queue, &(T){sizeof(int), &(int){1}});
+    assert(push_result.value == handles[99]);
+    assert(PriorityQueue_size(queue).value == 75);
+    check_pops_sorted(queue, 75);
+
+    PriorityQueue_destroy(&queue);
+}
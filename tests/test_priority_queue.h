@@ -0,0 +1,11 @@
+#ifndef TEST_PRIORITY_QUEUE_H
+#define TEST_PRIORITY_QUEUE_H
+
+#include <assert.h>
+#include <limits.h>
+
+#include "../src/data_structures/heaps/priority_queue.h"
+
+void test_priority_queue();
+
+#endif
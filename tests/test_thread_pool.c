@@ -0,0 +1,126 @@
+#include "test_thread_pool.h"
+
+static atomic_size_t tasks_run;
+
+void count_task(void* context) {
+    (void)context;
+    atomic_fetch_add(&tasks_run, 1);
+}
+
+void square_task(void* context) {
+    size_t* value = (size_t*)context;
+    *value *= *value;
+}
+
+typedef struct FibonacciTask {
+    ThreadPool* pool;
+    size_t n;
+    size_t result;
+} FibonacciTask;
+
+// Splits into two subtasks and waits for them from inside the pool
+void fibonacci_task(void* context) {
+    FibonacciTask* task = (FibonacciTask*)context;
+    if (task->n < 2) {
+        task->result = task->n;
+        return;
+    }
+
+    FibonacciTask left = {task->pool, task->n - 1, 0};
+    FibonacciTask right = {task->pool, task->n - 2, 0};
+    ThreadPoolTask* handle = NULL;
+    assert(ThreadPool_submit(task->pool, fibonacci_task, &left, &handle)
+               .error == NO_ERROR);
+    fibonacci_task(&right);
+    assert(ThreadPool_wait(task->pool, &handle).error == NO_ERROR);
+    task->result = left.result + right.result;
+}
+
+void sum_range(size_t begin, size_t end, void* context) {
+    size_t sum = 0;
+    for (size_t i = begin; i < end; i++) {
+        sum += i;
+    }
+    atomic_fetch_add((atomic_size_t*)context, sum);
+}
+
+typedef struct NestedRange {
+    ThreadPool* pool;
+    atomic_size_t total;
+} NestedRange;
+
+// Runs a parallel_for of its own from inside every chunk
+void nested_range(size_t begin, size_t end, void* context) {
+    NestedRange* nested = (NestedRange*)context;
+    for (size_t i = begin; i < end; i++) {
+        assert(ThreadPool_parallel_for(nested->pool, 0, 100, 10, sum_range,
+                                       &nested->total)
+                   .error == NO_ERROR);
+    }
+}
+
+void test_thread_pool() {
+    // Test Creation
+    ReturnThreadPool created = ThreadPool_create(4);
+    assert(created.error == NO_ERROR);
+    ThreadPool* pool = created.pool;
+    assert(ThreadPool_size(pool) == 4);
+    assert(ThreadPool_submit(pool, NULL, NULL, NULL).error == ERROR_NULL);
+
+    // Test tasks with join handles
+    size_t values[64];
+    ThreadPoolTask* handles[64];
+    for (size_t i = 0; i < 64; i++) {
+        values[i] = i;
+        assert(ThreadPool_submit(pool, square_task, &values[i], &handles[i])
+                   .error == NO_ERROR);
+    }
+    for (size_t i = 0; i < 64; i++) {
+        assert(ThreadPool_wait(pool, &handles[i]).error == NO_ERROR);
+        assert(handles[i] == NULL);
+        assert(values[i] == i * i);
+    }
+
+    // Test tasks that submit and wait for subtasks
+    FibonacciTask fibonacci = {pool, 20, 0};
+    ThreadPoolTask* handle = NULL;
+    ThreadPool_submit(pool, fibonacci_task, &fibonacci, &handle);
+    ThreadPool_wait(pool, &handle);
+    assert(fibonacci.result == 6765);
+
+    // Test parallel_for covers every index exactly once
+    atomic_size_t total = 0;
+    assert(ThreadPool_parallel_for(pool, 10, 100010, 0, sum_range, &total)
+               .error == NO_ERROR);
+    size_t expected = (size_t)100009 * 100010 / 2 - 45;
+    assert(atomic_load(&total) == expected);
+    atomic_store(&total, 0);
+    ThreadPool_parallel_for(pool, 0, 1000, 7, sum_range, &total);
+    assert(atomic_load(&total) == (size_t)999 * 1000 / 2);
+    atomic_store(&total, 0);
+    ThreadPool_parallel_for(pool, 5, 5, 1, sum_range, &total);
+    assert(atomic_load(&total) == 0);
+
+    // Test parallel_for nested inside parallel_for
+    NestedRange nested = {pool, 0};
+    ThreadPool_parallel_for(pool, 0, 50, 1, nested_range, &nested);
+    assert(atomic_load(&nested.total) == (size_t)50 * 4950);
+
+    // Test destroy runs every detached task still queued
+    atomic_store(&tasks_run, 0);
+    for (size_t i = 0; i < 10000; i++) {
+        assert(ThreadPool_submit(pool, count_task, NULL, NULL).error ==
+               NO_ERROR);
+    }
+    assert(ThreadPool_destroy(&pool).error == NO_ERROR);
+    assert(pool == NULL);
+    assert(atomic_load(&tasks_run) == 10000);
+
+    // Test the shared pool is created once
+    ThreadPool* shared = ThreadPool_shared();
+    assert(shared != NULL);
+    assert(ThreadPool_shared() == shared);
+    atomic_store(&total, 0);
+    ThreadPool_parallel_for(shared, 0, 1000, 0, sum_range, &total);
+    assert(atomic_load(&total) == (size_t)999 * 1000 / 2);
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_THREAD_POOL_H
+#define TEST_THREAD_POOL_H
+
+#include <assert.h>
+
+#include "../src/concurrency/thread_pool.h"
+
+void test_thread_pool();
+
+#endif